@@ -16,8 +16,129 @@
 
 #include "config.h"
 
+// Кэш длительностей тестов и базовая линия используют учет ресурсов
+#if (defined(UT_ENABLE_TIMING_CACHE) || defined(UT_ENABLE_BASELINE)) && !defined(UT_ENABLE_RUSAGE)
+#define UT_ENABLE_RUSAGE
+#endif
+
+// Поиск утечек использует перехват распределителя памяти
+#if defined(UT_ENABLE_LEAK_CHECK) && !defined(UT_ENABLE_ALLOC_TRACKING)
+#define UT_ENABLE_ALLOC_TRACKING
+#endif
+
+// При перехвате распределителя памяти поиск утечек включен по умолчанию
+#if defined(UT_ENABLE_ALLOC_TRACKING) && !defined(UT_ENABLE_LEAK_CHECK) && !defined(UT_DISABLE_LEAK_CHECK)
+#define UT_ENABLE_LEAK_CHECK
+#endif
+
+#include <stdio.h>
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+#include <type_traits>
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Заголовки, нужные только включенным возможностям
+#if defined(UT_ENABLE_AUTO_REGISTRATION) || defined(UT_ENABLE_PARALLEL) || defined(UT_ENABLE_BENCH) || \
+    defined(UT_ENABLE_TIMING_CACHE) || defined(UT_ENABLE_SHARDING) || defined(UT_ENABLE_BASELINE) || \
+    defined(UT_ENABLE_FILTER) || defined(UT_ENABLE_ALLOC_TRACKING) || defined(UT_ENABLE_TIMEOUT) || \
+    defined(UT_ENABLE_FAIL_FAST) || defined(UT_ENABLE_FAILED_FIRST) || defined(UT_ENABLE_REPORTER) || \
+    defined(UT_ENABLE_ASSERT_EVENTS) || defined(UT_ENABLE_PROPERTY) || defined(UT_ENABLE_FUZZ)
+#include <stdlib.h>
+#endif
+
+#if defined(UT_ENABLE_PARALLEL) || defined(UT_ENABLE_PERF_COUNTERS) || defined(UT_ENABLE_ARENA) || \
+    defined(UT_ENABLE_TIMEOUT) || defined(UT_ENABLE_REPORTER) || defined(UT_ENABLE_PROPERTY) || \
+    defined(UT_ENABLE_FUZZ) || defined(UT_ENABLE_FORK) || defined(UT_ENABLE_FAILED_FIRST) || \
+    defined(UT_ENABLE_TIMING_CACHE)
+#include <unistd.h>
+#endif
+
+#if defined(UT_ENABLE_PARALLEL) || defined(UT_ENABLE_TIMEOUT) || defined(UT_ENABLE_REPORTER) || \
+    defined(UT_ENABLE_ASSERT_EVENTS)
+#include <pthread.h>
+#endif
+
+#if defined(UT_ENABLE_BENCH) || defined(UT_ENABLE_RUSAGE) || defined(UT_ENABLE_TIMEOUT) || \
+    defined(UT_ENABLE_FAILED_FIRST) || defined(UT_ENABLE_ASSERT_EVENTS) || defined(UT_ENABLE_PROPERTY) || \
+    defined(UT_ENABLE_FUZZ)
+#include <time.h>
+#endif
+
+#if defined(UT_ENABLE_ALLOC_TRACKING) || defined(UT_ENABLE_REPORTER) || defined(UT_ENABLE_FUZZ) || \
+    defined(UT_ENABLE_FORK)
+#include <errno.h>
+#endif
+
+#if defined(UT_ENABLE_LEAK_CHECK) || defined(UT_ENABLE_TIMEOUT)
+#include <execinfo.h>
+#endif
+
+#ifdef UT_ENABLE_LEAK_CHECK
+#include <link.h>
+#include <sys/auxv.h>
+#endif
+
+#if defined(UT_ENABLE_TIMEOUT) || defined(UT_ENABLE_ASSERT_EVENTS) || defined(UT_ENABLE_FUZZ) || \
+    defined(UT_ENABLE_FORK)
+#include <signal.h>
+#endif
+
+#ifdef UT_ENABLE_TIMEOUT
+#include <setjmp.h>
+#endif
+
+#if defined(UT_ENABLE_REPORTER) || defined(UT_ENABLE_PROPERTY)
+#include <stdarg.h>
+#endif
+
+#if defined(UT_ENABLE_REPORTER) || defined(UT_ENABLE_FUZZ)
+#include <fcntl.h>
+#endif
+
+#ifdef UT_ENABLE_ASSERT_EVENTS
+#include <sched.h>
+#endif
+
+#ifdef UT_ENABLE_FUZZ
+#include <dirent.h>
+#endif
+
+#ifdef UT_ENABLE_RUSAGE
+#include <sys/resource.h>
+#endif
+
+#ifdef UT_ENABLE_PERF_COUNTERS
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#if defined(UT_ENABLE_ARENA) || defined(UT_ENABLE_REPORTER) || defined(UT_ENABLE_ASSERT_EVENTS) || \
+    defined(UT_ENABLE_FUZZ) || defined(UT_ENABLE_FORK)
+#include <sys/mman.h>
+#endif
+
+#if defined(UT_ENABLE_FAILED_FIRST) || defined(UT_ENABLE_REPORTER) || defined(UT_ENABLE_FUZZ)
+#include <sys/stat.h>
+#endif
+
+#ifdef UT_ENABLE_REPORTER
+#include <sys/uio.h>
+#endif
+
+#ifdef UT_ENABLE_FORK
+#include <sys/wait.h>
+#endif
 
 
 #ifdef __cplusplus
@@ -25,15 +146,447 @@ extern "C" {
 #endif
 
 
-struct __ut_test_desc;
+#ifdef UT_ENABLE_BENCH
+
+#ifndef UT_BENCH_SAMPLES
+//! Количество замеров бенчмарка
+#define UT_BENCH_SAMPLES 31
+#endif
+
+#ifndef UT_BENCH_WARMUP_ROUNDS
+//! Количество прогревочных (неучитываемых) замеров бенчмарка
+#define UT_BENCH_WARMUP_ROUNDS 3
+#endif
+
+#ifndef UT_BENCH_TARGET_TIME_NS
+//! Целевая длительность всех замеров бенчмарка, нс
+#define UT_BENCH_TARGET_TIME_NS 500000000ull
+#endif
+
+#ifndef UT_BENCH_MAX_ITERATIONS
+//! Максимальное количество итераций в одном замере бенчмарка
+#define UT_BENCH_MAX_ITERATIONS 1000000000ul
+#endif
+
+#ifndef UT_ON_SUCCESSFUL_BENCH
+//! Обработчик успешного бенчмарка; по умолчанию - обработчик успешного теста
+#define UT_ON_SUCCESSFUL_BENCH(test_state) UT_ON_SUCCESSFUL_TEST(test_state)
+#endif
+
+/*!
+    \brief     Результаты измерений бенчмарка
+    \details   Все времена - в наносекундах на одну итерацию
+*/
+struct __ut_bench_stats
+{
+    unsigned long iterations;               //!< Количество итераций в одном замере (подбирается автоматически)
+    unsigned int samples_count;             //!< Количество выполненных замеров
+    double samples[UT_BENCH_SAMPLES];       //!< Замеры, по возрастанию
+    double min;                             //!< Минимальное время
+    double median;                          //!< Медиана
+    double mean;                            //!< Среднее время
+    double p90;                             //!< 90-й процентиль
+    double p99;                             //!< 99-й процентиль
+    double max;                             //!< Максимальное время
+};
+
+#endif  // UT_ENABLE_BENCH
+
+#ifdef UT_ENABLE_RUSAGE
+
+/*!
+    \brief     Ресурсы, израсходованные тестом или функцией набора тестов
+*/
+struct __ut_usage
+{
+    unsigned long long wall_ns;        //!< Астрономическое время, нс
+    unsigned long long user_ns;        //!< Процессорное время в режиме пользователя, нс
+    unsigned long long system_ns;      //!< Процессорное время в режиме ядра, нс
+    long max_rss_delta_kb;             //!< Прирост максимального резидентного размера процесса, КиБ
+    long minor_faults;                 //!< Количество страничных прерываний без ввода-вывода
+    long major_faults;                 //!< Количество страничных прерываний с вводом-выводом
+    long context_switches;             //!< Количество (добровольных и принудительных) переключений контекста
+};
+
+#ifndef UT_ON_TEST_USAGE
+//! Обработчик ресурсов, израсходованных тестом; вызывается перед обработчиком результата теста
+#define UT_ON_TEST_USAGE(test_state, usage)
+#endif
+
+#ifndef UT_ON_TEST_SUITE_USAGE
+//! Обработчик ресурсов, израсходованных startup- и teardown-функциями набора тестов
+#define UT_ON_TEST_SUITE_USAGE(test_suite_desc, startup_usage, teardown_usage)
+#endif
+
+#endif  // UT_ENABLE_RUSAGE
+
+#ifdef UT_ENABLE_PERF_COUNTERS
+
+//! \name Биты маски доступных аппаратных счетчиков (см. __ut_perf_counters::available)
+// @{
+#define UT_PERF_CYCLES           (1u << 0)    //!< Такты процессора
+#define UT_PERF_INSTRUCTIONS     (1u << 1)    //!< Выполненные инструкции
+#define UT_PERF_BRANCH_MISSES    (1u << 2)    //!< Неверно предсказанные переходы
+#define UT_PERF_L1D_MISSES       (1u << 3)    //!< Промахи чтения кэша данных первого уровня
+#define UT_PERF_LLC_MISSES       (1u << 4)    //!< Промахи кэша последнего уровня
+// @}
+
+/*!
+    \brief     Показания аппаратных счетчиков производительности за время выполнения функции теста
+    \details   Учитывается только пользовательский режим текущего потока.
+        При мультиплексировании счетчиков ядром значения масштабируются
+*/
+struct __ut_perf_counters
+{
+    unsigned int available;            //!< Маска доступных счетчиков (\p UT_PERF_*); \p 0, если perf недоступен
+    unsigned long long cycles;         //!< Такты процессора
+    unsigned long long instructions;   //!< Выполненные инструкции
+    unsigned long long branch_misses;  //!< Неверно предсказанные переходы
+    unsigned long long l1d_misses;     //!< Промахи чтения кэша данных первого уровня
+    unsigned long long llc_misses;     //!< Промахи кэша последнего уровня
+};
+
+#ifndef UT_ON_TEST_PERF_COUNTERS
+//! Обработчик показаний аппаратных счетчиков теста; вызывается перед обработчиком результата теста
+#define UT_ON_TEST_PERF_COUNTERS(test_state, perf_counters)
+#endif
+
+#endif  // UT_ENABLE_PERF_COUNTERS
+
+#ifdef UT_ENABLE_ALLOC_TRACKING
+
+#if !defined(__GLIBC__)
+#error "UT_ENABLE_ALLOC_TRACKING requires glibc"
+#endif
+
+/*!
+    \def       UT_ALLOC_IMPLEMENTATION
+    \brief     Определить перехватчики функций распределителя в текущей единице трансляции
+    \details   Перехватчики заменяют \p malloc, \p free и другие функции распределителя
+        во всей программе, поэтому определяются только там, где это явно запрошено:
+        макрос определяется ровно в одной единице трансляции (перед включением заголовка).
+        Без него программа, использующая проверки выделений памяти или поиск утечек,
+        не компонуется (не определен символ \p __ut_alloc_implementation)
+*/
+
+/*!
+    \def       UT_DISABLE_LEAK_CHECK
+    \brief     Отключить поиск утечек, включаемый по умолчанию вместе с #UT_ENABLE_ALLOC_TRACKING
+*/
+
+/*!
+    \brief     Счетчики выделений динамической памяти
+    \details   Учитываются \p malloc, \p calloc, \p realloc, \p aligned_alloc,
+        \p posix_memalign и \p free, вызванные текущим потоком
+*/
+struct __ut_alloc_stats
+{
+    unsigned long long count;          //!< Количество выделений
+    unsigned long long bytes;          //!< Количество запрошенных байт
+    unsigned long long frees;          //!< Количество освобождений
+};
+
+#ifndef UT_ON_TEST_ALLOC_STATS
+//! Обработчик счетчиков выделений памяти теста; вызывается перед обработчиком результата теста
+#define UT_ON_TEST_ALLOC_STATS(test_state, alloc_stats)
+#endif
+
+#ifdef UT_ENABLE_LEAK_CHECK
+
+#ifndef UT_LEAK_CHECK_MAX_REPORTED
+//! Максимальное количество утекших блоков, перечисляемых в сообщении
+#define UT_LEAK_CHECK_MAX_REPORTED 3
+#endif
+
+#ifndef UT_LEAK_CHECK_FRAMES
+//! Количество кадров стека вызовов, сохраняемых для места выделения; при \p 1 сохраняется только вызвавшая распределитель функция, без \p backtrace
+#define UT_LEAK_CHECK_FRAMES 4
+#endif
+
+#endif  // UT_ENABLE_LEAK_CHECK
+
+#endif  // UT_ENABLE_ALLOC_TRACKING
+
+#ifdef UT_ENABLE_ARENA
+
+#ifndef UT_ARENA_CHUNK_SIZE
+//! Минимальный размер участка арены, байт
+#define UT_ARENA_CHUNK_SIZE (1024 * 1024)
+#endif
+
+#ifndef UT_ARENA_POISON
+//! Флаг отладочного режима арены: память завершившегося теста становится недоступной
+#define UT_ARENA_POISON 0
+#endif
+
+#ifndef UT_ARENA_QUARANTINE
+//! Количество последних недоступных участков, адреса которых остаются зарезервированными (при #UT_ARENA_POISON); более старые освобождаются
+#define UT_ARENA_QUARANTINE 16
+#endif
+
+#if UT_ARENA_QUARANTINE < 1
+#error "UT_ARENA_QUARANTINE must be positive"
+#endif
+
+struct __ut_arena;
+
+#endif  // UT_ENABLE_ARENA
+
+#ifdef UT_ENABLE_TIMING_CACHE
+
+#ifndef UT_TIMING_CACHE_FILE
+//! Путь к файлу кэша длительностей тестов (переопределяется переменной окружения \p UT_TIMING_CACHE)
+#define UT_TIMING_CACHE_FILE ".microut-timings"
+#endif
+
+#endif  // UT_ENABLE_TIMING_CACHE
+
+#ifdef UT_ENABLE_BASELINE
+
+#ifndef UT_BASELINE_FILE
+//! Путь к файлу базовой линии производительности (переопределяется переменной окружения \p UT_BASELINE)
+#define UT_BASELINE_FILE ".microut-baseline"
+#endif
+
+#ifndef UT_BASELINE_BENCH_THRESHOLD
+//! Относительный прирост медианы бенчмарка, начиная с которого он считается замедлившимся
+#define UT_BASELINE_BENCH_THRESHOLD 0.05
+#endif
+
+#ifndef UT_BASELINE_CRITICAL_Z
+/*!
+    Критическое значение (одностороннего) критерия Манна-Уитни для замеров бенчмарка;
+    по умолчанию соответствует уровню значимости 0.01. \p 0 отключает критерий
+*/
+#define UT_BASELINE_CRITICAL_Z 2.326
+#endif
+
+#ifndef UT_BASELINE_TEST_THRESHOLD
+//! Относительный прирост длительности теста (не бенчмарка), начиная с которого он считается замедлившимся
+#define UT_BASELINE_TEST_THRESHOLD 0.5
+#endif
+
+#ifndef UT_BASELINE_MIN_DELTA_NS
+//! Абсолютный прирост длительности теста (не бенчмарка), меньше которого замедление не учитывается, нс
+#define UT_BASELINE_MIN_DELTA_NS 5000000ull
+#endif
+
+#endif  // UT_ENABLE_BASELINE
+
+#ifdef UT_ENABLE_TIMEOUT
+
+#ifndef UT_TEST_TIMEOUT_MS
+//! Время, отведенное на тест, мс (переопределяется переменной окружения \p UT_TEST_TIMEOUT); \p 0 - не ограничено
+#define UT_TEST_TIMEOUT_MS 60000ull
+#endif
+
+#ifndef UT_TEST_SUITE_TIMEOUT_MS
+//! Время, отведенное на тесты набора, мс (переопределяется переменной окружения \p UT_TEST_SUITE_TIMEOUT); \p 0 - не ограничено
+#define UT_TEST_SUITE_TIMEOUT_MS 0ull
+#endif
+
+#ifndef UT_TIMEOUT_SIGNAL
+//! Сигнал, которым прерывается тест, превысивший отведенное время
+#define UT_TIMEOUT_SIGNAL SIGUSR2
+#endif
+
+#ifndef UT_TIMEOUT_GRACE_MS
+//! Время ожидания прерывания теста после #UT_TIMEOUT_SIGNAL (затем процесс завершается) и время after each-функции прерванного теста, мс
+#define UT_TIMEOUT_GRACE_MS 1000ull
+#endif
+
+#ifndef UT_TIMEOUT_BACKTRACE_DEPTH
+//! Наибольшее количество кадров стека зависшего теста в сообщении
+#define UT_TIMEOUT_BACKTRACE_DEPTH 8
+#endif
+
+#endif  // UT_ENABLE_TIMEOUT
+
+#ifdef UT_ENABLE_FAIL_FAST
+
+#ifndef UT_MAX_FAILURES
+/*!
+    Количество проваленных тестов, после которого оставшиеся тесты не запускаются
+    (переопределяется переменной окружения \p UT_MAX_FAILURES и параметрами
+    \p --max-failures=N, \p --fail-fast); \p 0 - не ограничено
+*/
+#define UT_MAX_FAILURES 0
+#endif
+
+#endif  // UT_ENABLE_FAIL_FAST
+
+#ifdef UT_ENABLE_FAILED_FIRST
+
+#ifndef UT_FAILED_FILE
+//! Путь к файлу проваленных тестов (переопределяется переменной окружения \p UT_FAILED_FILE)
+#define UT_FAILED_FILE ".microut-failed"
+#endif
+
+#ifndef UT_FAILED_FIRST
+/*!
+    Флаг запуска первыми ранее проваленных тестов и тестов из измененных файлов
+    (переопределяется переменной окружения \p UT_FAILED_FIRST и параметром \p --failed-first)
+*/
+#define UT_FAILED_FIRST 0
+#endif
+
+#ifndef UT_FAILED_ONLY
+/*!
+    Флаг запуска только ранее проваленных тестов
+    (переопределяется переменной окружения \p UT_FAILED_ONLY и параметром \p --failed-only)
+*/
+#define UT_FAILED_ONLY 0
+#endif
+
+#endif  // UT_ENABLE_FAILED_FIRST
+
+#ifdef UT_ENABLE_REPORTER
+
+#ifndef UT_REPORT_FORMAT
+/*!
+    Формат отчета: \p "junit" (JUnit XML), \p "tap" (TAP 13), \p "jsonl" (JSON Lines)
+    или \p "binary" (двоичный журнал, см. #UT_LOG_OPEN);
+    пустая строка - отчет не формируется (переопределяется переменной окружения
+    \p UT_REPORT и параметром \p --report=FORMAT)
+*/
+#define UT_REPORT_FORMAT ""
+#endif
+
+#ifndef UT_REPORT_FILE
+/*!
+    Путь к файлу отчета; пустая строка - стандартный вывод (переопределяется
+    переменной окружения \p UT_REPORT_FILE и параметром \p --report-file=PATH)
+*/
+#define UT_REPORT_FILE ""
+#endif
+
+#ifndef UT_REPORT_BUFFER_SIZE
+//! Размер буфера отчета, байт
+#define UT_REPORT_BUFFER_SIZE (64 * 1024)
+#endif
+
+#ifndef UT_REPORT_MESSAGE_SIZE
+//! Наибольший размер сохраняемого сообщения о провале теста (с завершающим нулем), байт
+#define UT_REPORT_MESSAGE_SIZE 512
+#endif
+
+#endif  // UT_ENABLE_REPORTER
+
+#ifdef UT_ENABLE_ASSERT_EVENTS
+
+#ifndef UT_ASSERT_RING_SIZE
+//! Емкость буфера событий проверок одного потока (степень двойки), событий
+#define UT_ASSERT_RING_SIZE 1024
+#endif
+
+#ifndef UT_ASSERT_MESSAGE_SIZE
+//! Размер сообщения, передаваемого сборщику проверок в самом событии (с завершающим нулем), байт; более длинное копируется в кучу
+#define UT_ASSERT_MESSAGE_SIZE 112
+#endif
+
+/*!
+    \name      Обработчики проверок при сборщике проверок
+    \details   Проверки тестов учитываются отдельным (отсоединенным) потоком-сборщиком,
+        поэтому #UT_ON_SUCCESSFUL_ASSERT и #UT_ON_FAILED_ASSERT для них вызываются
+        в потоке сборщика, а не в потоке, выполняющем тест: обработчики должны быть
+        потокобезопасны и не должны обращаться к локальным данным потока теста.
+        Проверки startup- и teardown-функций по-прежнему учитываются сразу.
+        Счетчики проверок (\p performed_count, \p successed_count) отстают от выполненных
+        проверок, пока тест выполняется, и достоверны только после завершения функции
+        теста (исполнитель дожидается учета перед вызовом обработчиков результата)
+*/
+
+#endif  // UT_ENABLE_ASSERT_EVENTS
+
+#ifdef UT_ENABLE_PROPERTY
+
+#ifndef UT_SEED
+/*!
+    Начальное значение генератора псевдослучайных чисел свойств (переопределяется
+    переменной окружения \p UT_SEED и параметром \p --seed=N); \p 0 - выбирается при запуске
+*/
+#define UT_SEED 0
+#endif
+
+#ifndef UT_PROPERTY_CASES
+//! Количество случаев, проверяемых для каждого свойства (переопределяется переменной окружения \p UT_PROPERTY_CASES)
+#define UT_PROPERTY_CASES 1000
+#endif
+
+#ifndef UT_PROPERTY_SHRINK_LIMIT
+//! Наибольшее количество запусков случая при упрощении контрпримера
+#define UT_PROPERTY_SHRINK_LIMIT 2000
+#endif
+
+#ifndef UT_PROPERTY_MAX_CHOICES
+//! Наибольшее количество псевдослучайных выборов одного случая (остальные выборы равны \p 0)
+#define UT_PROPERTY_MAX_CHOICES 256
+#endif
+
+#ifndef UT_PROPERTY_BYTES_SIZE
+//! Наибольший суммарный размер массивов байтов одного случая (см. #UT_GEN_BYTES), байт
+#define UT_PROPERTY_BYTES_SIZE 4096
+#endif
+
+#endif  // UT_ENABLE_PROPERTY
+
+#ifdef UT_ENABLE_FUZZ
+
+#ifndef UT_FUZZ_RUNS
+/*!
+    Количество мутированных входов, проверяемых каждой целью фаззинга (переопределяется
+    переменной окружения \p UT_FUZZ_RUNS и параметром \p --fuzz=N); \p 0 - только повтор корпуса
+*/
+#define UT_FUZZ_RUNS 0
+#endif
+
+#ifndef UT_FUZZ_CORPUS
+/*!
+    Каталог корпусов целей фаззинга (переопределяется переменной окружения \p UT_FUZZ_CORPUS);
+    корпус цели хранится в подкаталоге <набор тестов>.<цель>
+*/
+#define UT_FUZZ_CORPUS ".microut-corpus"
+#endif
+
+#ifndef UT_FUZZ_MAX_LEN
+//! Наибольший размер входа цели фаззинга, байт
+#define UT_FUZZ_MAX_LEN 4096
+#endif
+
+#ifndef UT_FUZZ_MAX_MUTATIONS
+//! Наибольшее количество мутаций, применяемых к входу подряд
+#define UT_FUZZ_MAX_MUTATIONS 5
+#endif
+
+#ifndef UT_FUZZ_MAP_SIZE
+//! Количество счетчиков покрытия переходов (степень двойки)
+#define UT_FUZZ_MAP_SIZE 65536
+#endif
+
+#endif  // UT_ENABLE_FUZZ
+
+#ifndef UT_ON_SKIPPED_TEST
+//! Обработчик теста, запуск которого отменен (например, по достижении #UT_MAX_FAILURES); вызывается вместо обработчика результата теста
+#define UT_ON_SKIPPED_TEST(test_state, reason)
+#endif
+
+#ifndef UT_CACHE_LINE_SIZE
+//! Размер строки кэша процессора, байт
+#define UT_CACHE_LINE_SIZE 64
+#endif
+
+struct __ut_test_state;
 
 /*!
     \brief     Тип функции теста
     \protected
 */
-typedef void (*__ut_test_func)(struct __ut_test_desc *desc);
+typedef void (*__ut_test_func)(struct __ut_test_state *desc);
 /*!
     \brief     Структура теста
+    \details   Содержит только неизменяемые сведения о тесте, поэтому
+        таблицы тестов могут размещаться в памяти только для чтения.
+        Результаты выполнения теста хранятся в #__ut_test_state
     \protected
 */
 struct __ut_test_desc
@@ -43,10 +596,60 @@ struct __ut_test_desc
     const char * const file;           //!< Указатель на строку, файл, в котором определен набор тестов
     const unsigned int line;           //!< Строка файла, в котором определен набор тестов
     const __ut_test_func func;         //!< Указатель на функцию набора тестов
-    bool started;                      //!< Флаг старта набора тестов
+#ifdef UT_ENABLE_BENCH
+    struct __ut_bench_stats * const bench;    //!< Результаты измерений, если тест - бенчмарк; \p NULL иначе
+#endif
+};
+
+/*!
+    \brief     Инициализаторы полей структуры теста, зависящих от включенных возможностей
+    \details   Поля перечисляются явно: иначе C++ предупреждает о неинициализированных полях
+    \protected
+*/
+#ifdef UT_ENABLE_BENCH
+#define __UT_TEST_DESC_FEATURES , .bench = NULL
+#else
+#define __UT_TEST_DESC_FEATURES
+#endif
+
+/*!
+    \brief     Состояние теста
+    \details   Изменяемые поля теста. Выравнивается по строке кэша, чтобы
+        тесты, выполняемые разными потоками, не разделяли строк кэша.
+        Указатель на состояние получают функции теста и обработчики результатов теста
+        и проверок; сведения о тесте (наименование, описание, место определения)
+        доступны через указатель на неизменяемую структуру теста (#UT_TEST_DESC, #UT_TEST_NAME)
+    \protected
+*/
+struct __ut_test_state
+{
+    const struct __ut_test_desc *test; //!< Указатель на структуру теста
+#ifdef UT_ENABLE_FORK
+    int signal;                        //!< Номер сигнала, аварийно завершившего тест (в режиме изоляции); \p 0 иначе
+#endif
+#ifdef UT_ENABLE_RUSAGE
+    struct __ut_usage usage;           //!< Ресурсы, израсходованные тестом (вместе с before each- и after each-функциями)
+#endif
+#ifdef UT_ENABLE_PERF_COUNTERS
+    struct __ut_perf_counters perf_counters;    //!< Показания аппаратных счетчиков за время выполнения функции теста (всех итераций бенчмарка)
+#endif
+#ifdef UT_ENABLE_ALLOC_TRACKING
+    struct __ut_alloc_stats alloc_stats;    //!< Выделения памяти функцией теста (всеми итерациями бенчмарка)
+#endif
+#ifdef UT_ENABLE_ARENA
+    struct __ut_arena *arena;          //!< Арена потока, выполняющего тест (см. #ut_alloc); \p NULL вне выполнения теста
+#endif
+#ifdef UT_ENABLE_BASELINE
+    double baseline_delta;             //!< Относительное изменение длительности (медианы бенчмарка) по сравнению с базовой линией; \p 0, если тест в ней отсутствует
+#endif
+    const char *skip_reason;           //!< Причина отмены запуска теста (см. #UT_ON_SKIPPED_TEST); \p NULL, если тест запущен или не выбран фильтром
+#ifdef UT_ENABLE_REPORTER
+    const char *failure_message;       //!< Сообщение первой неуспешной проверки (действительно до завершения набора тестов); \p NULL, если проверки успешны
+#endif
+    bool started;                      //!< Флаг запуска теста
     unsigned int performed_count;      //!< Количество запущенныых проверок
     unsigned int successed_count;      //!< Количество успешных проверок
-};
+} __attribute__((aligned(UT_CACHE_LINE_SIZE)));
 
 struct __ut_test_suite_desc;
 /*!
@@ -66,23 +669,156 @@ struct __ut_test_suite_desc
     const __ut_test_suite_func teardown;         //!< Указатель на функцию, которая будет выполнена после отработки набора тестов
     const __ut_test_func before_each;            //!< Указатель на функцию, которая будет выполнена перед каждым тестом
     const __ut_test_func after_each;             //!< Указатель на функцию, которая будет выполнена после каждого теста
-    struct __ut_test_desc * const test_descs;    //!< Массив структур тестов
+    const struct __ut_test_desc * const test_descs; //!< Массив структур тестов
+    const struct __ut_test_desc * const test_descs_end; //!< Указатель на конец массива структур тестов (секции тестов); \p NULL, если задан \p test_descs_count
+    const unsigned int test_descs_count;         //!< Количество элементов массива структур тестов, известное при компиляции
+    struct __ut_test_state *test_states;         //!< Массив состояний тестов (по индексу теста); \p NULL, если выделяется при запуске набора тестов
     bool started;                                //!< Флаг запуска набора тестов
     unsigned int performed_count;                //!< Количество запущенныых тестов
     unsigned int successed_count;                //!< Количество успешных тестов
+#ifdef UT_ENABLE_RUSAGE
+    struct __ut_usage startup_usage;             //!< Ресурсы, израсходованные startup-функцией
+    struct __ut_usage teardown_usage;            //!< Ресурсы, израсходованные teardown-функцией
+#endif
+#ifdef UT_ENABLE_TIMEOUT
+    unsigned long long deadline_ns;              //!< Момент истечения времени набора тестов (по монотонным часам), нс; \p 0 - не ограничено
+#endif
 };
 
 /*!
-    \brief     Совершить проверку
-    \details
-        - Если значение выражения истинно, то вызывает #UT_ON_SUCCESSFUL_ASSERT
-        - Иначе вызывает #UT_ON_FAILED_ASSERT и завершает текущую функцию
-        - Сообщает запустившему тесту/набору тестов, о запуске проверки и ее успешности
-    \param[in] assertion выражение, значение которого проверяется
-    \param[in] message   указатель на строку-сообщение
-    \pre       Может быть вызван на любой стадии тестирования
+    \brief     Инициализатор нулями вложенной структуры
+    \details   В C++ \p { 0 } инициализирует явно только первое поле, и компилятор
+        предупреждает об остальных
+    \protected
+*/
+#ifdef __cplusplus
+#define __UT_ZERO {}
+#else
+#define __UT_ZERO { 0 }
+#endif
+
+/*!
+    \brief     Инициализаторы полей структуры набора тестов, зависящих от включенных возможностей
+    \protected
+*/
+#if defined(UT_ENABLE_RUSAGE) && defined(UT_ENABLE_TIMEOUT)
+#define __UT_TEST_SUITE_DESC_FEATURES , .startup_usage = __UT_ZERO, .teardown_usage = __UT_ZERO, .deadline_ns = 0
+#elif defined(UT_ENABLE_RUSAGE)
+#define __UT_TEST_SUITE_DESC_FEATURES , .startup_usage = __UT_ZERO, .teardown_usage = __UT_ZERO
+#elif defined(UT_ENABLE_TIMEOUT)
+#define __UT_TEST_SUITE_DESC_FEATURES , .deadline_ns = 0
+#else
+#define __UT_TEST_SUITE_DESC_FEATURES
+#endif
+
+#ifdef UT_ENABLE_LEAK_CHECK
+/*!
+    \brief     Выполнить оператор, не учитывая выделенную им память при поиске утечек
+    \details   Используется для обработчиков проверок (например, буфер \p stdout
+        выделяется при первом выводе и не освобождается)
+    \protected
+*/
+#define __UT_LEAK_CHECK_PAUSED(statement) do {                      \
+        struct __ut_leak_run * const __ut_leak_paused = __ut_leak_pause(); \
+        statement;                                                  \
+        __ut_leak_resume(__ut_leak_paused);                         \
+    } while (0)
+#else
+#define __UT_LEAK_CHECK_PAUSED(statement) statement
+#endif
+
+#if defined(UT_ENABLE_PROPERTY) || defined(UT_ENABLE_FUZZ)
+//! Флаг заглушенных проверок (см. #__ut_assert_muted)
+#define __UT_ASSERT_MUTED __ut_assert_muted
+#else
+#define __UT_ASSERT_MUTED false
+#endif
+
+//! Выполнить обработчик проверки, если проверки не заглушены
+#define __UT_ASSERT_HOOK(statement) do {                   \
+        if (!__UT_ASSERT_MUTED) {                          \
+            __UT_LEAK_CHECK_PAUSED(statement);             \
+        }                                                  \
+    } while (0)
+
+#ifdef UT_ENABLE_REPORTER
+//! Сохранить сообщение о провале для отчета, см. #__ut_report_failure
+#define __UT_REPORT_FAILURE(message) __UT_LEAK_CHECK_PAUSED(__ut_report_failure(message))
+#else
+#define __UT_REPORT_FAILURE(message) ((void)0)
+#endif
+
+#ifdef __cplusplus
+extern "C++"
+{
+//! Признак состояния теста (в C++ нет \p __builtin_types_compatible_p)
+template <typename T> struct __ut_is_test_state { static const bool value = false; };
+template <> struct __ut_is_test_state<struct __ut_test_state> { static const bool value = true; };
+}
+#define __UT_IS_TEST_STATE(desc) (__ut_is_test_state<__typeof__(*(desc))>::value)
+#else
+#define __UT_IS_TEST_STATE(desc) __builtin_types_compatible_p(__typeof__(*(desc)), struct __ut_test_state)
+#endif
+
+#ifdef __cplusplus
+extern "C++"
+{
+//! Структура со сведениями о наборе тестов
+template <typename T> static inline T *__ut_info_desc(T *desc) { return desc; }
+//! Структура со сведениями о тесте
+static inline const struct __ut_test_desc *__ut_info_desc(struct __ut_test_state *desc) { return desc->test; }
+static inline const struct __ut_test_desc *__ut_info_desc(const struct __ut_test_state *desc) { return desc->test; }
+}
+#define __UT_INFO_DESC(desc) __ut_info_desc(desc)
+#else
+/*!
+    \brief     Структура со сведениями о тесте или наборе тестов
+    \details   Для состояния теста - его неизменяемая структура, для набора тестов
+        (проверки startup- и teardown-функций) - структура набора тестов
+    \protected
+*/
+#define __UT_INFO_DESC(desc)                                                      \
+        __builtin_choose_expr(__UT_IS_TEST_STATE(desc),                          \
+            ((const struct __ut_test_state *)(const void *)(desc))->test, (desc))
+#endif
+
+#ifdef UT_ENABLE_ASSERT_EVENTS
+
+/*!
+    \brief     Передать проверку теста сборщику проверок
+    \details   Проверки startup- и teardown-функций, а также проверки до запуска
+        сборщика выполняются как обычно. При неуспешной проверке завершает текущую функцию
+    \protected
+*/
+#define __UT_ASSERT_EVENT(assertion, message)                                                    \
+        if (__UT_IS_TEST_STATE(desc) && __ut_assert_events_active() && !__UT_ASSERT_MUTED) {     \
+            if (__ut_assert_push((struct __ut_test_state *)(void *)(desc), (assertion), (message), \
+                __builtin_constant_p(message)))                                                  \
+            {                                                                                    \
+                break;                                                                           \
+            }                                                                                    \
+            return;                                                                              \
+        }
+#else
+#define __UT_ASSERT_EVENT(assertion, message)
+#endif
+
+/*!
+    \brief     Совершить проверку
+    \details
+        - Если значение выражения истинно, то вызывает #UT_ON_SUCCESSFUL_ASSERT
+        - Иначе вызывает #UT_ON_FAILED_ASSERT и завершает текущую функцию
+        - Сообщает запустившему тесту/набору тестов, о запуске проверки и ее успешности
+        - При #UT_ENABLE_ASSERT_EVENTS проверка теста передается сборщику проверок
+          (см. #__ut_assert_push), который учитывает ее и вызывает обработчик в своем потоке;
+          счетчики проверок теста до его завершения отстают
+    \param[in] assertion выражение, значение которого проверяется
+    \param[in] message   указатель на строку-сообщение
+    \pre       Может быть вызван на любой стадии тестирования
 */
 #define UT_ASSERT(assertion, message) do {               \
+        /* Передаем проверку сборщику, если запущен   */ \
+        __UT_ASSERT_EVENT(assertion, message)            \
         /* Помечаем, что проверка запущена            */ \
         desc->performed_count++;                         \
                                                          \
@@ -92,13 +828,15 @@ struct __ut_test_suite_desc
             /* то помечаем это...                     */ \
             desc->successed_count++;                     \
             /* и вызываем макрос-обработчик успеха    */ \
-            UT_ON_SUCCESSFUL_ASSERT(desc, message);      \
+            __UT_ASSERT_HOOK(UT_ON_SUCCESSFUL_ASSERT(desc, message)); \
         }                                                \
         else                                             \
         {                                                \
             /* ...иначе                               */ \
+            /* сохраняем сообщение для отчета,        */ \
+            __UT_ASSERT_HOOK(__UT_REPORT_FAILURE(message)); \
             /* запускаем макрос-обработчик неудачи... */ \
-            UT_ON_FAILED_ASSERT(desc, message);          \
+            __UT_ASSERT_HOOK(UT_ON_FAILED_ASSERT(desc, message)); \
             /* и прерываем выполнение текущей функции */ \
             return;                                      \
         }                                                \
@@ -110,281 +848,9142 @@ struct __ut_test_suite_desc
         из тестов (из указанного набора тестов)
     \param[in] test_suite набор тестов
 */
-#define UT_BEFORE_EACH(test_suite) void test_suite##_before_each(struct __ut_test_desc *desc)
+#define UT_BEFORE_EACH(test_suite) void test_suite##_before_each(struct __ut_test_state *desc)
 
 /*!
     \brief     Определить функцию, которая будет вызвана после запуска каждого
         из тестов (из указанного набора тестов)
     \param[in] test_suite набор тестов
 */
-#define UT_AFTER_EACH(test_suite) void test_suite##_after_each(struct __ut_test_desc *desc)
+#define UT_AFTER_EACH(test_suite) void test_suite##_after_each(struct __ut_test_state *desc)
+
+#ifndef UT_ENABLE_AUTO_REGISTRATION
 
 /*!
     \brief     Определить функцию теста
     \param[in] test_suite набор тестов
     \param[in] test       тест
 */
-#define UT_TEST(test_suite, test) void test_suite##_##test(struct __ut_test_desc *desc)
+#define UT_TEST(test_suite, test) void test_suite##_##test(struct __ut_test_state *desc)
+
+#else
+
+/*!
+    \brief     Получить имя секции, в которую регистрируются тесты набора тестов
+    \param[in] test_suite набор тестов
+    \protected
+*/
+#define __UT_TESTS_SECTION(test_suite) "ut_tests_" #test_suite
+
+/*!
+    \brief     Определить функцию теста и зарегистрировать тест
+    \details   Структура теста помещается в секцию \p ut_tests_<test_suite>.
+        Компоновщик собирает структуры тестов набора в непрерывный массив,
+        границы которого (\p __start_ut_tests_<test_suite> и \p __stop_ut_tests_<test_suite>)
+        использует #UT_REGISTER_TEST_SUITE
+    \param[in] test_suite набор тестов
+    \param[in] test       тест
+    \warning   Требует компоновщика ELF (GNU ld, gold, lld)
+*/
+#define UT_TEST(test_suite, test)                                                  \
+    void test_suite##_##test(struct __ut_test_state *desc);                        \
+                                                                                   \
+    /* Явное выравнивание запрещает компилятору добавлять отступы между        */ \
+    /* структурами тестов в секции                                             */ \
+    static const struct __ut_test_desc test_suite##_##test##_test_desc             \
+        __attribute__((section(__UT_TESTS_SECTION(test_suite)), used,              \
+            aligned(__alignof__(struct __ut_test_desc)))) =                        \
+        UT_ADD_TEST(test_suite, test, "");                                         \
+                                                                                   \
+    void test_suite##_##test(struct __ut_test_state *desc)
+
+#endif  // UT_ENABLE_AUTO_REGISTRATION
+
+#ifdef UT_ENABLE_BENCH
+
+/*!
+    \brief     Получить имя результатов измерений бенчмарка
+    \details   Результаты определяет #UT_BENCH, по одному объекту на бенчмарк
+    \param[in] test_suite набор тестов
+    \param[in] bench      бенчмарк
+    \protected
+*/
+#define __UT_BENCH_STATS(test_suite, bench) test_suite##_##bench##_bench_stats
+
+/*!
+    \brief     Макрос для добавления бенчмарка в список тестов набора тестов
+    \param[in] test_suite        набор тестов
+    \param[in] benchmark         бенчмарк
+    \param[in] bench_description указатель на строку-описание бенчмарка
+    \pre       Бенчмарк определен макросом #UT_BENCH в той же единице трансляции
+*/
+#define UT_ADD_BENCH(test_suite, benchmark, bench_description) \
+    { .name = #benchmark, .description = bench_description, .file = __FILE__, .line = __LINE__, \
+        .func = test_suite##_##benchmark, .bench = &__UT_BENCH_STATS(test_suite, benchmark) }
+
+#ifndef UT_ENABLE_AUTO_REGISTRATION
+
+/*!
+    \brief     Определить функцию бенчмарка
+    \details   Функция вызывается многократно; измеряемый код следует поместить
+        в цикл #UT_BENCH_LOOP. Бенчмарк добавляется в набор тестов макросом #UT_ADD_BENCH
+    \param[in] test_suite набор тестов
+    \param[in] bench      бенчмарк
+*/
+#define UT_BENCH(test_suite, bench)                                                \
+    static struct __ut_bench_stats __UT_BENCH_STATS(test_suite, bench);            \
+                                                                                   \
+    void test_suite##_##bench(struct __ut_test_state *desc)
+
+#else
+
+/*!
+    \brief     Определить функцию бенчмарка и зарегистрировать бенчмарк
+    \param[in] test_suite набор тестов
+    \param[in] bench      бенчмарк
+    \see       UT_TEST
+*/
+#define UT_BENCH(test_suite, bench)                                                \
+    void test_suite##_##bench(struct __ut_test_state *desc);                       \
+    static struct __ut_bench_stats __UT_BENCH_STATS(test_suite, bench);            \
+                                                                                   \
+    static const struct __ut_test_desc test_suite##_##bench##_test_desc            \
+        __attribute__((section(__UT_TESTS_SECTION(test_suite)), used,              \
+            aligned(__alignof__(struct __ut_test_desc)))) =                        \
+        UT_ADD_BENCH(test_suite, bench, "");                                       \
+                                                                                   \
+    void test_suite##_##bench(struct __ut_test_state *desc)
+
+#endif  // UT_ENABLE_AUTO_REGISTRATION
+
+/*!
+    \brief     Цикл измеряемых итераций бенчмарка
+    \details   Количество итераций подбирается автоматически так, чтобы замер
+        длился около #UT_BENCH_TARGET_TIME_NS / #UT_BENCH_SAMPLES
+    \pre       Может быть вызван только в функции бенчмарка
+*/
+#define UT_BENCH_LOOP for (unsigned long __ut_i = desc->test->bench->iterations; __ut_i > 0; --__ut_i)
+
+/*!
+    \brief     Запретить компилятору удалять вычисление значения как неиспользуемое
+    \param[in] value значение
+*/
+#define UT_BENCH_KEEP(value) __asm__ volatile("" : : "g"(value) : "memory")
+
+#endif  // UT_ENABLE_BENCH
+
+/*!
+    \brief     Определить функцию, которая будет вызвана перед запуском набора тестов
+    \param[in] test_suite набор тестов
+*/
+#define UT_STARTUP(test_suite) void test_suite##_startup(struct __ut_test_suite_desc *desc)
+
+/*!
+    \brief     Определить функцию, которая будет вызвана перед запуском набора тестов
+    \param[in] test_suite набор тестов
+*/
+#define UT_TEARDOWN(test_suite) void test_suite##_teardown(struct __ut_test_suite_desc *desc)
+
+/*!
+    \brief     Макрос для добавления теста в список тестов набора тестов
+    \param[in] test_suite       набор тестов
+    \param[in] test             тест
+    \param[in] test_description указатель на строку-описание теста
+*/
+#define UT_ADD_TEST(test_suite, test, test_description) \
+    { .name = #test, .description = test_description, .file = __FILE__, .line = __LINE__, \
+        .func = test_suite##_##test __UT_TEST_DESC_FEATURES }
+
+/*!
+    \brief Макрос для завершения списка тестов
+*/
+#define UT_TEST_SUITE_END \
+    { .name = NULL, .description = NULL, .file = __FILE__, .line = __LINE__, .func = NULL __UT_TEST_DESC_FEATURES }
+
+/*!
+    \brief     Получить количество элементов массива структур тестов набора
+    \param[in] test_suite набор тестов
+    \protected
+*/
+#define __UT_TEST_DESCS_COUNT(test_suite) \
+    ( sizeof(test_suite##_test_descs) / sizeof(test_suite##_test_descs[0]) )
+
+/*!
+    \brief     Макрос для определения набора тестов
+    \param[in] test_suite        набор тестов
+    \param[in] suite_description указатель на строку-описание набора тестов
+    \param[in] ...         список тестов.
+        Формулируется путем вызова, через запятую, макросов #UT_ADD_TEST,
+        для каждого из тестов, и (необязательно) завершающим макросом #UT_TEST_SUITE_END.
+    \warning  Необходимо вызывать макрос без заверщающего разделителя \p ;
+*/
+#define UT_DECLARE_TEST_SUITE(test_suite, suite_description, ...) \
+    /* Объявляем массив структур тесов                         */ \
+    static const struct __ut_test_desc test_suite##_test_descs[] = { \
+        __VA_ARGS__                                               \
+    };                                                            \
+                                                                  \
+    /* Объявляем массив состояний тестов                       */ \
+    static struct __ut_test_state                                 \
+        test_suite##_test_states[__UT_TEST_DESCS_COUNT(test_suite)]; \
+                                                                  \
+    /* Объявляем структуру набора тестов                       */ \
+    static struct __ut_test_suite_desc test_suite##_desc = {      \
+        .name = #test_suite, .description = suite_description,    \
+        .startup = test_suite##_startup,                          \
+        .teardown = test_suite##_teardown,                        \
+        .before_each = test_suite##_before_each,                  \
+        .after_each = test_suite##_after_each,                    \
+        .test_descs = test_suite##_test_descs,                    \
+        .test_descs_end = NULL,                                   \
+        .test_descs_count = __UT_TEST_DESCS_COUNT(test_suite),    \
+        .test_states = test_suite##_test_states,                  \
+        .started = false, .performed_count = 0,                   \
+        .successed_count = 0 __UT_TEST_SUITE_DESC_FEATURES        \
+    };                                                            \
+                                                                  \
+    __UT_REGISTER_TEST_SUITE_DESC(test_suite)
+
+#ifdef UT_ENABLE_AUTO_REGISTRATION
+
+/*!
+    \brief     Зарегистрировать структуру набора тестов для #UT_RUN_ALL
+    \details   Указатель на структуру помещается в секцию \p ut_test_suites
+    \param[in] test_suite набор тестов
+    \protected
+*/
+#define __UT_REGISTER_TEST_SUITE_DESC(test_suite)                                 \
+    static struct __ut_test_suite_desc * const test_suite##_desc_ref             \
+        __attribute__((section("ut_test_suites"), used)) = &test_suite##_desc;
+
+/*!
+    \brief     Макрос для определения набора тестов, тесты которого
+        зарегистрированы макросом #UT_TEST
+    \details   Список тестов не требуется: набор тестов выполняет все тесты,
+        определенные макросом #UT_TEST для этого набора (во всех единицах трансляции),
+        в порядке их размещения компоновщиком
+    \param[in] test_suite        набор тестов
+    \param[in] suite_description указатель на строку-описание набора тестов
+    \warning  Необходимо вызывать макрос без заверщающего разделителя \p ;
+*/
+#define UT_REGISTER_TEST_SUITE(test_suite, suite_description)                        \
+    /* Границы секции тестов набора; если тестов нет, то оба указателя NULL     */ \
+    extern const struct __ut_test_desc __start_ut_tests_##test_suite[] __attribute__((weak)); \
+    extern const struct __ut_test_desc __stop_ut_tests_##test_suite[] __attribute__((weak));  \
+                                                                                     \
+    /* Объявляем структуру набора тестов                                         */ \
+    static struct __ut_test_suite_desc test_suite##_desc = {                         \
+        .name = #test_suite, .description = suite_description,                       \
+        .startup = test_suite##_startup,                                             \
+        .teardown = test_suite##_teardown,                                           \
+        .before_each = test_suite##_before_each,                                     \
+        .after_each = test_suite##_after_each,                                       \
+        .test_descs = __start_ut_tests_##test_suite,                                 \
+        .test_descs_end = __stop_ut_tests_##test_suite,                              \
+        .test_descs_count = 0, .test_states = NULL,                                  \
+        .started = false, .performed_count = 0,                                      \
+        .successed_count = 0 __UT_TEST_SUITE_DESC_FEATURES                           \
+    };                                                                               \
+                                                                                     \
+    __UT_REGISTER_TEST_SUITE_DESC(test_suite)
+
+#else
+
+#define __UT_REGISTER_TEST_SUITE_DESC(test_suite)
+
+#endif  // UT_ENABLE_AUTO_REGISTRATION
+
+/*!
+    \brief     Получить структуру набора тестов
+    \param[in] test_suite  набор тестов
+*/
+#define UT_TEST_SUITE_DESC(test_suite)    ( test_suite##_desc )
+
+/*!
+    \brief     Получить структуру теста (наименование, описание, место определения)
+    \param[in] test_state состояние теста
+*/
+#define UT_TEST_DESC(test_state)    ( (test_state)->test )
+
+/*!
+    \brief     Получить наименование теста или набора тестов
+    \details   Обработчики проверок получают состояние теста или, для startup- и
+        teardown-функций, структуру набора тестов
+    \param[in] desc состояние теста или структура набора тестов
+*/
+#define UT_TEST_NAME(desc)    ( __UT_INFO_DESC(desc)->name )
+
+/*!
+    \brief     Проверить, был ли тест запущен
+    \param[in] test_state состояние теста
+    \return    \p true, если тест был запущен; \p false иначе
+*/
+#define UT_IS_TEST_STARTED(test_state)   ( (test_state)->started )
+
+/*!
+    \brief     Проверить, был ли тест пропущен
+    \param[in] test_state состояние теста
+    \return    \p true, если тест не был запущен; \p false иначе
+*/
+#define UT_IS_TEST_SKIPPED(test_state)   ( !UT_IS_TEST_STARTED(test_state) )
+
+/*!
+    \brief     Проверить, был ли тест успешен
+    \param[in] test_state состояние теста
+    \return    \p true, если тест был запущен и успешно завершился; \p false иначе
+    \warning   При #UT_ENABLE_ASSERT_EVENTS во время выполнения теста (например, из его
+        функции) результат не учитывает еще не собранные проверки
+*/
+#define UT_IS_TEST_SUCCESSED(test_state) ( UT_IS_TEST_STARTED(test_state) && (test_state)->performed_count == (test_state)->successed_count )
+
+/*!
+    \brief     Проверить, был ли тест провален
+    \param[in] test_state состояние теста
+    \return    \p true, если тест был запущен и не завершился успешно; \p false иначе
+*/
+#define UT_IS_TEST_FAILED(test_state)    ( !UT_IS_TEST_SUCCESSED(test_state) )
+
+/*!
+    \brief     Проверить, был ли набор тестов запущен
+    \param[in] test_suite_desc структура набора тестов
+    \return    \p true, если набор тестов был запущен; \p false иначе
+*/
+#define UT_IS_TEST_SUITE_STARTED(test_suite_desc)   ( (test_suite_desc)->started )
+
+/*!
+    \brief     Проверить, был ли набор тестов пропущен
+    \param[in] test_suite_desc структура набора тестов
+    \return    \p true, если набор тестов не был запущен; \p false иначе
+*/
+#define UT_IS_TEST_SUITE_SKIPPED(test_suite_desc)   ( !UT_IS_TEST_SUITE_STARTED(test_suite_desc) )
+
+/*!
+    \brief     Проверить, был ли набор тестов успешен
+    \param[in] test_suite_desc структура набора тестов
+    \return    \p true, если набор тестов был запущен и завершился успешно; \p false иначе
+*/
+#define UT_IS_TEST_SUITE_SUCCESSED(test_suite_desc) ( UT_IS_TEST_SUITE_STARTED(test_suite_desc) && (test_suite_desc)->performed_count == (test_suite_desc)->successed_count )
+
+/*!
+    \brief     Проверить, был ли набор тестов провален
+    \param[in] test_suite_desc структура набора тестов
+    \return    \p true, если набор тестов был запущен и не завершился успешно; \p false иначе
+*/
+#define UT_IS_TEST_SUITE_FAILED(test_suite_desc)    ( !UT_IS_TEST_SUITE_SUCCESSED(test_suite_desc) )
+
+#if defined(UT_ENABLE_BENCH) || defined(UT_ENABLE_RUSAGE) || defined(UT_ENABLE_TIMEOUT)
+
+/*!
+    \brief     Получить текущее значение монотонных часов
+    \return    Время, нс
+    \protected
+*/
+static unsigned long long __ut_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (unsigned long long)ts.tv_sec * 1000000000ull + (unsigned long long)ts.tv_nsec;
+}
+
+#endif
+
+#ifdef UT_ENABLE_RUSAGE
+
+/*!
+    \brief     Отметка начала учета ресурсов
+    \protected
+*/
+struct __ut_usage_mark
+{
+    unsigned long long wall_ns;        //!< Показание монотонных часов, нс
+    struct rusage rusage;              //!< Показания счетчиков ресурсов
+};
+
+/*!
+    \brief     Получить показания счетчиков ресурсов
+    \details   Если доступно, используются счетчики текущего потока,
+        чтобы параллельно выполняемые тесты не влияли друг на друга
+    \param[out] rusage указатель на структуру показаний
+    \protected
+*/
+static void __ut_getrusage(struct rusage *rusage)
+{
+#if defined(RUSAGE_THREAD)
+    getrusage(RUSAGE_THREAD, rusage);
+#elif defined(__linux__)
+    // RUSAGE_THREAD объявляется только при _GNU_SOURCE
+    getrusage(1, rusage);
+#else
+    getrusage(RUSAGE_SELF, rusage);
+#endif
+}
+
+/*!
+    \brief     Начать учет ресурсов
+    \param[out] mark указатель на отметку начала учета
+    \protected
+*/
+static void __ut_usage_begin(struct __ut_usage_mark *mark)
+{
+    __ut_getrusage(&mark->rusage);
+    mark->wall_ns = __ut_now_ns();
+}
+
+/*!
+    \brief     Перевести время из \p timeval в наносекунды
+    \protected
+*/
+static unsigned long long __ut_timeval_ns(const struct timeval *tv)
+{
+    return (unsigned long long)tv->tv_sec * 1000000000ull + (unsigned long long)tv->tv_usec * 1000ull;
+}
+
+/*!
+    \brief     Закончить учет ресурсов
+    \param[in]  mark  указатель на отметку начала учета
+    \param[out] usage указатель на структуру израсходованных ресурсов
+    \protected
+*/
+static void __ut_usage_end(const struct __ut_usage_mark *mark, struct __ut_usage *usage)
+{
+    const unsigned long long wall_ns = __ut_now_ns();
+    struct rusage rusage;
+    __ut_getrusage(&rusage);
+
+    usage->wall_ns = wall_ns - mark->wall_ns;
+    usage->user_ns = __ut_timeval_ns(&rusage.ru_utime) - __ut_timeval_ns(&mark->rusage.ru_utime);
+    usage->system_ns = __ut_timeval_ns(&rusage.ru_stime) - __ut_timeval_ns(&mark->rusage.ru_stime);
+    usage->max_rss_delta_kb = rusage.ru_maxrss - mark->rusage.ru_maxrss;
+    usage->minor_faults = rusage.ru_minflt - mark->rusage.ru_minflt;
+    usage->major_faults = rusage.ru_majflt - mark->rusage.ru_majflt;
+    usage->context_switches = (rusage.ru_nvcsw - mark->rusage.ru_nvcsw) + (rusage.ru_nivcsw - mark->rusage.ru_nivcsw);
+}
+
+#endif  // UT_ENABLE_RUSAGE
+
+#ifdef UT_ENABLE_PERF_COUNTERS
+
+/*!
+    \brief     Описание аппаратного счетчика
+    \protected
+*/
+struct __ut_perf_event
+{
+    unsigned int bit;                  //!< Бит в маске доступных счетчиков
+    unsigned int type;                 //!< Тип события perf
+    unsigned long long config;         //!< Конфигурация события perf
+    size_t offset;                     //!< Смещение значения в структуре показаний
+};
+
+/*!
+    \brief     Счетчики, открываемые группой (первый доступный - лидер группы)
+    \protected
+*/
+static const struct __ut_perf_event __ut_perf_events[] = {
+    { UT_PERF_CYCLES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, offsetof(struct __ut_perf_counters, cycles) },
+    { UT_PERF_INSTRUCTIONS, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, offsetof(struct __ut_perf_counters, instructions) },
+    { UT_PERF_BRANCH_MISSES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, offsetof(struct __ut_perf_counters, branch_misses) },
+    { UT_PERF_L1D_MISSES, PERF_TYPE_HW_CACHE,
+        PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        offsetof(struct __ut_perf_counters, l1d_misses) },
+    { UT_PERF_LLC_MISSES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, offsetof(struct __ut_perf_counters, llc_misses) },
+};
+
+//! Количество счетчиков в группе
+#define __UT_PERF_EVENTS_COUNT (sizeof(__ut_perf_events) / sizeof(__ut_perf_events[0]))
+
+/*!
+    \brief     Группа аппаратных счетчиков потока
+    \details   Открывается при первом использовании в потоке (и заново - в дочернем процессе)
+    \protected
+*/
+struct __ut_perf_group
+{
+    pid_t pid;                                  //!< Процесс, открывший группу; \p 0, если группа не открывалась
+    int fds[__UT_PERF_EVENTS_COUNT];            //!< Дескрипторы открытых счетчиков, в порядке чтения группы
+    unsigned int events[__UT_PERF_EVENTS_COUNT];    //!< Индексы (в #__ut_perf_events) открытых счетчиков
+    unsigned int count;                         //!< Количество открытых счетчиков; \p 0, если perf недоступен
+};
+
+//! Группа аппаратных счетчиков текущего потока
+static __thread struct __ut_perf_group __ut_perf_group;
+
+/*!
+    \brief     Получить группу аппаратных счетчиков текущего потока
+    \details   Недоступные (неподдерживаемые процессором, запрещенные
+        \p perf_event_paranoid или seccomp) счетчики пропускаются
+    \return    Указатель на группу; \p NULL, если ни один счетчик недоступен
+    \protected
+*/
+static struct __ut_perf_group *__ut_perf_open(void)
+{
+    struct __ut_perf_group *group = &__ut_perf_group;
+    const pid_t pid = getpid();
+
+    if (group->pid == pid)
+    {
+        return group->count != 0 ? group : NULL;
+    }
+
+    // Дескрипторы, унаследованные от родительского процесса, считают события родителя
+    for (unsigned int i = 0; i < group->count; ++i)
+    {
+        close(group->fds[i]);
+    }
+    group->pid = pid;
+    group->count = 0;
+
+    for (unsigned int i = 0; i < __UT_PERF_EVENTS_COUNT; ++i)
+    {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = __ut_perf_events[i].type;
+        attr.config = __ut_perf_events[i].config;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attr.disabled = group->count == 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        const int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, group->count == 0 ? -1 : group->fds[0], 0);
+        if (fd >= 0)
+        {
+            group->fds[group->count] = fd;
+            group->events[group->count] = i;
+            ++group->count;
+        }
+    }
+
+    return group->count != 0 ? group : NULL;
+}
+
+/*!
+    \brief     Начать подсчет аппаратных событий в текущем потоке
+    \return    Указатель на группу счетчиков; \p NULL, если perf недоступен
+    \protected
+*/
+static struct __ut_perf_group *__ut_perf_begin(void)
+{
+    struct __ut_perf_group *group = __ut_perf_open();
+
+    if (group != NULL)
+    {
+        ioctl(group->fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(group->fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+
+    return group;
+}
+
+/*!
+    \brief     Закончить подсчет аппаратных событий и получить показания
+    \param[in]  group         указатель на группу счетчиков (результат #__ut_perf_begin)
+    \param[out] perf_counters указатель на структуру показаний
+    \protected
+*/
+static void __ut_perf_end(struct __ut_perf_group *group, struct __ut_perf_counters *perf_counters)
+{
+    memset(perf_counters, 0, sizeof(*perf_counters));
+
+    if (group == NULL)
+    {
+        return;
+    }
+
+    ioctl(group->fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    // nr, time_enabled, time_running, values[nr]
+    uint64_t data[3 + __UT_PERF_EVENTS_COUNT];
+    const ssize_t size = read(group->fds[0], data, sizeof(data));
+    // Группа ни разу не попала на счетчики процессора
+    if (size < (ssize_t)(3 * sizeof(uint64_t)) || data[2] == 0)
+    {
+        return;
+    }
+
+    const double scale = (double)data[1] / (double)data[2];
+    for (unsigned int i = 0; i < data[0] && i < group->count; ++i)
+    {
+        const struct __ut_perf_event *event = &__ut_perf_events[group->events[i]];
+
+        perf_counters->available |= event->bit;
+        *(unsigned long long *)((char *)perf_counters + event->offset) =
+            data[2] < data[1] ? (unsigned long long)((double)data[3 + i] * scale) : data[3 + i];
+    }
+}
+
+#endif  // UT_ENABLE_PERF_COUNTERS
+
+#ifdef UT_ENABLE_TIMEOUT
+
+/*!
+    \brief     Отложенное прерывание теста по времени
+    \protected
+*/
+struct __ut_timeout_defer
+{
+    unsigned int depth;                //!< Глубина вложенности участков, откладывающих прерывание
+    bool pending;                      //!< Флаг прерывания, пришедшего внутри участка
+};
+
+/*!
+    \brief     Отложенное прерывание текущего потока
+    \details   Обработчик #UT_TIMEOUT_SIGNAL покидает тест через \p siglongjmp, и поток,
+        прерванный с захваченной блокировкой, никогда ее не освободит. Перехватчики
+        функций распределителя (вместе с блокировками распределителя glibc и таблицы
+        живых блоков) выполняются как участки, откладывающие прерывание до выхода из них.
+        Слабое определение: одна переменная на программу
+    \protected
+*/
+__attribute__((weak)) __thread struct __ut_timeout_defer __ut_timeout_defer;
+
+/*!
+    \brief     Начать участок, откладывающий прерывание теста по времени
+    \protected
+*/
+static inline void __ut_timeout_defer_begin(void)
+{
+    ++__ut_timeout_defer.depth;
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+}
+
+/*!
+    \brief     Закончить участок, откладывающий прерывание теста по времени
+    \details   Прерывание, пришедшее внутри участка, выполняется повторной отправкой сигнала себе
+    \protected
+*/
+static inline void __ut_timeout_defer_end(void)
+{
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    if (--__ut_timeout_defer.depth == 0 && __ut_timeout_defer.pending)
+    {
+        __ut_timeout_defer.pending = false;
+        raise(UT_TIMEOUT_SIGNAL);
+    }
+}
+
+#endif  // UT_ENABLE_TIMEOUT
+
+#ifdef UT_ENABLE_ALLOC_TRACKING
+
+/*!
+    \brief     Счетчики выделений памяти текущего потока
+    \details   Слабое определение: одна переменная на программу, сколько бы
+        единиц трансляции ни включали заголовок
+    \protected
+*/
+__attribute__((weak)) __thread struct __ut_alloc_stats __ut_alloc_thread_stats;
+
+//! \name Функции распределителя glibc
+// @{
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void *__libc_memalign(size_t alignment, size_t size);
+extern void __libc_free(void *ptr);
+// @}
+
+#ifdef UT_ENABLE_LEAK_CHECK
+
+//! Количество независимо блокируемых частей таблицы живых блоков
+#define __UT_LEAK_SHARDS 64
+
+struct __ut_leak_run;
+
+/*!
+    \brief     Живой блок памяти, выделенный тестом
+    \details   Входит в цепочку корзины таблицы живых блоков и в список блоков
+        выполнения теста, выделившего его
+    \protected
+*/
+struct __ut_leak_block
+{
+    struct __ut_leak_block *next;      //!< Следующий блок той же корзины
+    struct __ut_leak_block *run_prev;  //!< Предыдущий блок того же выполнения теста
+    struct __ut_leak_block *run_next;  //!< Следующий блок того же выполнения теста
+    void *ptr;                         //!< Адрес блока
+    size_t size;                       //!< Запрошенный размер блока
+    void *sites[UT_LEAK_CHECK_FRAMES]; //!< Стек вызовов места выделения, начиная с адреса возврата из функции распределителя; недостающие кадры - \p NULL
+    struct __ut_leak_run *run;         //!< Выполнение теста, выделившее блок
+};
+
+/*!
+    \brief     Часть таблицы живых блоков
+    \details   Хэш-таблица с цепочками; корзины удваиваются при заполнении
+    \protected
+*/
+struct __ut_leak_shard
+{
+    bool lock;                         //!< Спин-блокировка
+    struct __ut_leak_block **buckets;  //!< Массив корзин
+    size_t bucket_count;               //!< Количество корзин (степень двойки)
+    size_t count;                      //!< Количество блоков
+} __attribute__((aligned(UT_CACHE_LINE_SIZE)));
+
+/*!
+    \brief     Выполнение теста, блоки которого учитываются
+    \details   Список живых блоков позволяет завершить учет за время, пропорциональное
+        количеству неосвобожденных блоков, а не размеру таблицы
+    \protected
+*/
+struct __ut_leak_run
+{
+    bool lock;                         //!< Спин-блокировка списка
+    struct __ut_leak_block *blocks;    //!< Список живых блоков
+};
+
+/*!
+    \brief     Таблица живых блоков, выделенных тестами
+    \details   Слабое определение: одна таблица на программу. Блоки выделяются
+        распределителем glibc напрямую, минуя перехватчики.
+        Блокировки берутся по одной, кроме #__ut_leak_end, которая захватывает
+        части таблицы, удерживая блокировку выполнения теста
+    \protected
+*/
+struct __ut_leak_state
+{
+    unsigned long live;                         //!< Общее количество блоков (для быстрого пути \p free)
+    struct __ut_leak_shard shards[__UT_LEAK_SHARDS];    //!< Части таблицы
+};
+__attribute__((weak)) struct __ut_leak_state __ut_leak_table;
+
+/*!
+    \brief     Адреса динамического загрузчика
+    \details   Загрузчик выделяет память потока (например, DTV) при создании потока
+        и не освобождает ее при завершении потока: она используется повторно
+        следующими потоками. Такие блоки утечками не считаются.
+        Слабое определение: одна переменная на программу
+    \protected
+*/
+struct __ut_leak_loader_range
+{
+    bool loaded;                       //!< Флаг определения адресов
+    uintptr_t begin;                   //!< Начало загруженных сегментов; \p 0 - программа собрана статически
+    uintptr_t end;                     //!< Конец загруженных сегментов
+};
+__attribute__((weak)) struct __ut_leak_loader_range __ut_leak_loader;
+
+//! Выполнение теста текущего потока (тест выполняется потоком целиком)
+__attribute__((weak)) __thread struct __ut_leak_run __ut_leak_thread_run;
+
+//! Выполнение теста, блоки которого учитываются в текущем потоке; \p NULL, если учет не ведется
+__attribute__((weak)) __thread struct __ut_leak_run *__ut_leak_owner;
+
+/*!
+    \brief     Вычислить хэш адреса блока
+    \protected
+*/
+static inline uint64_t __ut_leak_hash(const void *ptr)
+{
+    return ((uint64_t)(uintptr_t)ptr >> 4) * 0x9E3779B97F4A7C15ull;
+}
+
+/*!
+    \brief     Захватить спин-блокировку
+    \protected
+*/
+static inline void __ut_leak_lock(bool *lock)
+{
+    while (__atomic_test_and_set(lock, __ATOMIC_ACQUIRE))
+    {
+    }
+}
+
+/*!
+    \brief     Освободить спин-блокировку
+    \protected
+*/
+static inline void __ut_leak_unlock(bool *lock)
+{
+    __atomic_clear(lock, __ATOMIC_RELEASE);
+}
+
+/*!
+    \brief     Найти корзину блока
+    \pre       Часть таблицы захвачена и содержит корзины
+    \protected
+*/
+static inline struct __ut_leak_block **__ut_leak_bucket(struct __ut_leak_shard *shard, const void *ptr)
+{
+    return &shard->buckets[(size_t)(__ut_leak_hash(ptr) >> 16) & (shard->bucket_count - 1)];
+}
+
+/*!
+    \brief     Найти часть таблицы блока
+    \protected
+*/
+static inline struct __ut_leak_shard *__ut_leak_shard_of(const void *ptr)
+{
+    return &__ut_leak_table.shards[__ut_leak_hash(ptr) >> 58];
+}
+
+/*!
+    \brief     Удалить блок из списка выполнения теста
+    \pre       Список захвачен
+    \protected
+*/
+static inline void __ut_leak_run_unlink(struct __ut_leak_run *run, struct __ut_leak_block *block)
+{
+    if (block->run_prev != NULL)
+    {
+        block->run_prev->run_next = block->run_next;
+    }
+    else
+    {
+        run->blocks = block->run_next;
+    }
+    if (block->run_next != NULL)
+    {
+        block->run_next->run_prev = block->run_prev;
+    }
+}
+
+/*!
+    \brief     Изъять блок из таблицы живых блоков
+    \param[in] ptr   адрес блока
+    \param[in] block указатель на изымаемый блок; \p NULL - любой блок с адресом \p ptr
+    \return    Указатель на изъятый блок; \p NULL, если блок в таблице отсутствует
+    \protected
+*/
+static struct __ut_leak_block *__ut_leak_shard_take(const void *ptr, const struct __ut_leak_block *block)
+{
+    struct __ut_leak_shard *shard = __ut_leak_shard_of(ptr);
+    struct __ut_leak_block *taken = NULL;
+
+    __ut_leak_lock(&shard->lock);
+
+    if (shard->bucket_count != 0)
+    {
+        for (struct __ut_leak_block **link = __ut_leak_bucket(shard, ptr); *link != NULL; link = &(*link)->next)
+        {
+            if ((*link)->ptr == ptr && (block == NULL || *link == block))
+            {
+                taken = *link;
+                *link = taken->next;
+                --shard->count;
+                break;
+            }
+        }
+    }
+
+    __ut_leak_unlock(&shard->lock);
+
+    return taken;
+}
+
+#ifdef UT_ALLOC_IMPLEMENTATION
+
+/*!
+    \brief     Добавить блок в таблицу живых блоков
+    \param[in] block указатель на блок (адрес блока задан)
+    \return    \p true, если блок добавлен; \p false, если память для корзин не выделена
+    \protected
+*/
+static bool __ut_leak_shard_insert(struct __ut_leak_block *block)
+{
+    struct __ut_leak_shard *shard = __ut_leak_shard_of(block->ptr);
+
+    __ut_leak_lock(&shard->lock);
+
+    if (shard->count >= shard->bucket_count)
+    {
+        const size_t bucket_count = shard->bucket_count != 0 ? shard->bucket_count * 2 : 64;
+        struct __ut_leak_block **buckets = (struct __ut_leak_block **)__libc_calloc(bucket_count, sizeof(*buckets));
+        if (buckets != NULL)
+        {
+            for (size_t i = 0; i < shard->bucket_count; ++i)
+            {
+                while (shard->buckets[i] != NULL)
+                {
+                    struct __ut_leak_block *moved = shard->buckets[i];
+                    shard->buckets[i] = moved->next;
+
+                    const size_t j = (size_t)(__ut_leak_hash(moved->ptr) >> 16) & (bucket_count - 1);
+                    moved->next = buckets[j];
+                    buckets[j] = moved;
+                }
+            }
+            __libc_free(shard->buckets);
+            shard->buckets = buckets;
+            shard->bucket_count = bucket_count;
+        }
+    }
+
+    const bool inserted = shard->bucket_count != 0;
+    if (inserted)
+    {
+        struct __ut_leak_block **bucket = __ut_leak_bucket(shard, block->ptr);
+        block->next = *bucket;
+        *bucket = block;
+        ++shard->count;
+    }
+
+    __ut_leak_unlock(&shard->lock);
+
+    return inserted;
+}
+
+//! Наибольшее количество кадров стека внутри перехватчика до места выделения
+#define __UT_LEAK_SITE_SKIP 4
+
+/*!
+    \brief     Получить стек вызовов места выделения
+    \details   Вызывается только для учитываемых блоков. Стек, полученный \p backtrace,
+        начинается с адреса возврата из функции распределителя; если этот адрес
+        не найден среди первых кадров, сохраняется только он
+    \param[in]  site  адрес возврата из функции распределителя
+    \param[out] sites массив из #UT_LEAK_CHECK_FRAMES кадров
+    \protected
+*/
+static void __ut_leak_site(void *site, void **sites)
+{
+    memset(sites, 0, UT_LEAK_CHECK_FRAMES * sizeof(*sites));
+    sites[0] = site;
+
+#if UT_LEAK_CHECK_FRAMES > 1
+    void *frames[__UT_LEAK_SITE_SKIP + UT_LEAK_CHECK_FRAMES];
+    const int count = backtrace(frames, (int)(sizeof(frames) / sizeof(frames[0])));
+    for (int i = 0; i < count && i <= __UT_LEAK_SITE_SKIP; ++i)
+    {
+        if (frames[i] == site)
+        {
+            for (int j = 1; j < UT_LEAK_CHECK_FRAMES && i + j < count; ++j)
+            {
+                sites[j] = frames[i + j];
+            }
+            break;
+        }
+    }
+#endif
+}
+
+/*!
+    \brief     Добавить блок в таблицу живых блоков
+    \details   Если память для записи не выделяется, блок не учитывается
+    \param[in] ptr  адрес блока
+    \param[in] size запрошенный размер блока
+    \param[in] site место выделения
+    \param[in] run  выполнение теста
+    \protected
+*/
+static void __ut_leak_insert(void *ptr, size_t size, void *site, struct __ut_leak_run *run)
+{
+    struct __ut_leak_block *block = (struct __ut_leak_block *)__libc_malloc(sizeof(struct __ut_leak_block));
+    if (block == NULL)
+    {
+        return;
+    }
+    block->ptr = ptr;
+    block->size = size;
+    __ut_leak_site(site, block->sites);
+    block->run = run;
+
+    // Блок попадает в список раньше, чем в таблицу: найденный в таблице блок всегда есть в списке
+    __ut_leak_lock(&run->lock);
+    block->run_prev = NULL;
+    block->run_next = run->blocks;
+    if (run->blocks != NULL)
+    {
+        run->blocks->run_prev = block;
+    }
+    run->blocks = block;
+    __ut_leak_unlock(&run->lock);
+
+    if (!__ut_leak_shard_insert(block))
+    {
+        __ut_leak_lock(&run->lock);
+        __ut_leak_run_unlink(run, block);
+        __ut_leak_unlock(&run->lock);
+        __libc_free(block);
+        return;
+    }
+
+    __atomic_add_fetch(&__ut_leak_table.live, 1, __ATOMIC_RELAXED);
+}
+
+/*!
+    \brief     Перенести блок, перемещенный \p realloc, на новый адрес
+    \details   Блок сохраняет принадлежность выполнению теста, выделившему исходный,
+        и все время переноса остается в его списке
+    \param[in] ptr      прежний адрес блока
+    \param[in] new_ptr  новый адрес блока
+    \param[in] new_size новый размер блока
+    \param[in] site     место выделения
+    \return    \p true, если блок учитывался; \p false иначе
+    \protected
+*/
+static bool __ut_leak_move(const void *ptr, void *new_ptr, size_t new_size, void *site)
+{
+    if (__atomic_load_n(&__ut_leak_table.live, __ATOMIC_RELAXED) == 0)
+    {
+        return false;
+    }
+
+    struct __ut_leak_block *block = __ut_leak_shard_take(ptr, NULL);
+    if (block == NULL)
+    {
+        return false;
+    }
+
+    void *sites[UT_LEAK_CHECK_FRAMES];
+    __ut_leak_site(site, sites);
+
+    struct __ut_leak_run *run = block->run;
+    __ut_leak_lock(&run->lock);
+    block->ptr = new_ptr;
+    block->size = new_size;
+    memcpy(block->sites, sites, sizeof(sites));
+    __ut_leak_unlock(&run->lock);
+
+    if (!__ut_leak_shard_insert(block))
+    {
+        __ut_leak_lock(&run->lock);
+        __ut_leak_run_unlink(run, block);
+        __ut_leak_unlock(&run->lock);
+        __libc_free(block);
+        __atomic_sub_fetch(&__ut_leak_table.live, 1, __ATOMIC_RELAXED);
+    }
+
+    return true;
+}
+
+/*!
+    \brief     Учесть блок, выделенный текущим потоком
+    \protected
+*/
+static inline void __ut_leak_track(void *ptr, size_t size, void *site)
+{
+    if (__ut_leak_owner != NULL && ptr != NULL
+        && !((uintptr_t)site >= __ut_leak_loader.begin && (uintptr_t)site < __ut_leak_loader.end))
+    {
+        __ut_leak_insert(ptr, size, site, __ut_leak_owner);
+    }
+}
+
+#endif  // UT_ALLOC_IMPLEMENTATION
+
+/*!
+    \brief     Удалить блок из таблицы живых блоков
+    \details   Пока таблица пуста (вне тестов), не требует блокировок
+    \param[in] ptr адрес блока
+    \protected
+*/
+static inline void __ut_leak_remove(const void *ptr)
+{
+    if (__atomic_load_n(&__ut_leak_table.live, __ATOMIC_RELAXED) == 0)
+    {
+        return;
+    }
+
+    struct __ut_leak_block *block = __ut_leak_shard_take(ptr, NULL);
+    if (block == NULL)
+    {
+        return;
+    }
+
+    struct __ut_leak_run *run = block->run;
+    __ut_leak_lock(&run->lock);
+    __ut_leak_run_unlink(run, block);
+    __ut_leak_unlock(&run->lock);
+
+    __libc_free(block);
+    __atomic_sub_fetch(&__ut_leak_table.live, 1, __ATOMIC_RELAXED);
+}
+
+/*!
+    \brief     Приостановить учет живых блоков в текущем потоке
+    \return    Выполнение теста для #__ut_leak_resume
+    \protected
+*/
+static inline struct __ut_leak_run *__ut_leak_pause(void)
+{
+    struct __ut_leak_run *run = __ut_leak_owner;
+    __ut_leak_owner = NULL;
+
+    return run;
+}
+
+/*!
+    \brief     Возобновить учет живых блоков в текущем потоке
+    \protected
+*/
+static inline void __ut_leak_resume(struct __ut_leak_run *run)
+{
+    __ut_leak_owner = run;
+}
+
+/*!
+    \brief     Определить адреса динамического загрузчика (однократно)
+    \details   См. #__ut_leak_loader. Вызывается до запуска рабочих потоков
+    \protected
+*/
+static void __ut_leak_load(void)
+{
+    if (__ut_leak_loader.loaded)
+    {
+        return;
+    }
+    __ut_leak_loader.loaded = true;
+
+#if UT_LEAK_CHECK_FRAMES > 1
+    // Первый вызов backtrace загружает библиотеку раскрутки стека, выделяя память:
+    // выполняем его до учета блоков, а не внутри перехватчика
+    void *frame;
+    backtrace(&frame, 1);
+#endif
+
+    // Заголовок ELF загрузчика отображен по адресу его загрузки
+    const uintptr_t base = (uintptr_t)getauxval(AT_BASE);
+    if (base == 0)
+    {
+        return;
+    }
+
+    const ElfW(Ehdr) *ehdr = (const ElfW(Ehdr) *)base;
+    const ElfW(Phdr) *phdr = (const ElfW(Phdr) *)(base + ehdr->e_phoff);
+    for (ElfW(Half) i = 0; i < ehdr->e_phnum; ++i)
+    {
+        if (phdr[i].p_type == PT_LOAD && base + phdr[i].p_vaddr + phdr[i].p_memsz > __ut_leak_loader.end)
+        {
+            __ut_leak_loader.end = base + phdr[i].p_vaddr + phdr[i].p_memsz;
+        }
+    }
+    __ut_leak_loader.begin = base;
+}
+
+/*!
+    \brief     Начать учет живых блоков, выделяемых текущим потоком
+    \return    Выполнение теста
+    \protected
+*/
+static inline struct __ut_leak_run *__ut_leak_begin(void)
+{
+    __ut_leak_owner = &__ut_leak_thread_run;
+
+    return __ut_leak_owner;
+}
+
+/*!
+    \brief     Закончить учет живых блоков и удалить из таблицы неосвобожденные
+    \details   Обходит только список блоков выполнения теста. Блок, который
+        в этот момент освобождается или переносится другим потоком, отсутствует
+        в таблице, но остается в списке: его дожидаемся.
+        Сообщение перечисляет не более #UT_LEAK_CHECK_MAX_REPORTED блоков
+        (размер и стек вызовов места выделения, не более #UT_LEAK_CHECK_FRAMES кадров);
+        имена функций доступны при компоновке с \p -rdynamic
+    \param[in]  run      выполнение теста (результат #__ut_leak_begin)
+    \param[out] buf      указатель на буфер сообщения об утечке; \p NULL, если сообщение не нужно
+    \param[in]  buf_size размер буфера
+    \return    \p true, если остались неосвобожденные блоки
+    \protected
+*/
+static bool __ut_leak_end(struct __ut_leak_run *run, char *buf, size_t buf_size)
+{
+    __ut_leak_owner = NULL;
+
+    size_t leaked_count = 0, leaked_bytes = 0;
+    size_t sizes[UT_LEAK_CHECK_MAX_REPORTED];
+    void *sites[UT_LEAK_CHECK_MAX_REPORTED][UT_LEAK_CHECK_FRAMES];
+
+    for (;;)
+    {
+        __ut_leak_lock(&run->lock);
+        if (run->blocks == NULL)
+        {
+            __ut_leak_unlock(&run->lock);
+            break;
+        }
+
+        for (struct __ut_leak_block *block = run->blocks, *next; block != NULL; block = next)
+        {
+            next = block->run_next;
+            if (__ut_leak_shard_take(block->ptr, block) == NULL)
+            {
+                continue;
+            }
+            __ut_leak_run_unlink(run, block);
+
+            if (leaked_count < UT_LEAK_CHECK_MAX_REPORTED)
+            {
+                sizes[leaked_count] = block->size;
+                memcpy(sites[leaked_count], block->sites, sizeof(block->sites));
+            }
+            ++leaked_count;
+            leaked_bytes += block->size;
+
+            __libc_free(block);
+            __atomic_sub_fetch(&__ut_leak_table.live, 1, __ATOMIC_RELAXED);
+        }
+
+        __ut_leak_unlock(&run->lock);
+    }
+
+    if (leaked_count == 0 || buf == NULL)
+    {
+        return leaked_count != 0;
+    }
+
+    const size_t reported = leaked_count < UT_LEAK_CHECK_MAX_REPORTED ? leaked_count : UT_LEAK_CHECK_MAX_REPORTED;
+    char **symbols = backtrace_symbols(sites[0], (int)(reported * UT_LEAK_CHECK_FRAMES));
+
+    int length = snprintf(buf, buf_size, "memory leak: %zu blocks, %zu bytes", leaked_count, leaked_bytes);
+    for (size_t i = 0; i < reported && length >= 0 && (size_t)length < buf_size; ++i)
+    {
+        length += snprintf(buf + length, buf_size - (size_t)length, "; %zu bytes at", sizes[i]);
+        // Кадры перечисляются от места выделения к вызывающим функциям
+        for (size_t j = 0; j < UT_LEAK_CHECK_FRAMES && sites[i][j] != NULL && length >= 0 && (size_t)length < buf_size; ++j)
+        {
+            const char *separator = j == 0 ? " " : " <- ";
+            length += symbols != NULL
+                ? snprintf(buf + length, buf_size - (size_t)length, "%s%s", separator, symbols[i * UT_LEAK_CHECK_FRAMES + j])
+                : snprintf(buf + length, buf_size - (size_t)length, "%s%p", separator, sites[i][j]);
+        }
+    }
+    if (reported < leaked_count && length >= 0 && (size_t)length < buf_size)
+    {
+        snprintf(buf + length, buf_size - (size_t)length, "; ...");
+    }
+
+    free(symbols);
+
+    return true;
+}
+
+#endif  // UT_ENABLE_LEAK_CHECK
+
+#ifdef UT_ENABLE_TIMEOUT
+//! Начать перехватчик функции распределителя (см. #__ut_timeout_defer)
+#define __UT_ALLOC_ENTER() __ut_timeout_defer_begin()
+//! Закончить перехватчик функции распределителя
+#define __UT_ALLOC_LEAVE() __ut_timeout_defer_end()
+#else
+#define __UT_ALLOC_ENTER() ((void)0)
+#define __UT_ALLOC_LEAVE() ((void)0)
+#endif
+
+/*!
+    \brief     Признак определения перехватчиков функций распределителя
+    \details   Определяется только в единице трансляции, определившей #UT_ALLOC_IMPLEMENTATION.
+        Проверки выделений памяти и поиск утечек ссылаются на него: без перехватчиков
+        их счетчики оставались бы нулевыми, и проверки проходили бы ложно
+    \protected
+*/
+extern const bool __ut_alloc_implementation;
+
+#ifdef UT_ALLOC_IMPLEMENTATION
+const bool __ut_alloc_implementation = true;
+#endif
+
+#if defined(UT_ALLOC_IMPLEMENTATION) && !defined(__SANITIZE_ADDRESS__)
+
+/*!
+    \name      Перехватчики функций распределителя
+    \details   Учитывают вызов в счетчиках текущего потока и передают его распределителю glibc.
+        Определяются только в единице трансляции, определившей #UT_ALLOC_IMPLEMENTATION.
+        Определения слабые, поэтому собственный распределитель программы имеет приоритет.
+        При поиске утечек блоки, выделенные во время выполнения теста, заносятся
+        в таблицу живых блоков, а освобождаемые - удаляются из нее.
+        При ограничении времени тест не прерывается внутри перехватчика.
+        При сборке с AddressSanitizer не определяются (счетчики остаются нулевыми)
+*/
+// @{
+__attribute__((weak)) void *malloc(size_t size)
+{
+    __UT_ALLOC_ENTER();
+    ++__ut_alloc_thread_stats.count;
+    __ut_alloc_thread_stats.bytes += size;
+
+    void *result = __libc_malloc(size);
+#ifdef UT_ENABLE_LEAK_CHECK
+    __ut_leak_track(result, size, __builtin_return_address(0));
+#endif
+    __UT_ALLOC_LEAVE();
+
+    return result;
+}
+
+__attribute__((weak)) void *calloc(size_t count, size_t size)
+{
+    __UT_ALLOC_ENTER();
+    ++__ut_alloc_thread_stats.count;
+    __ut_alloc_thread_stats.bytes += count * size;
+
+    void *result = __libc_calloc(count, size);
+#ifdef UT_ENABLE_LEAK_CHECK
+    __ut_leak_track(result, count * size, __builtin_return_address(0));
+#endif
+    __UT_ALLOC_LEAVE();
+
+    return result;
+}
+
+__attribute__((weak)) void *realloc(void *ptr, size_t size)
+{
+    __UT_ALLOC_ENTER();
+    // realloc(ptr, 0) освобождает память
+    if (size != 0 || ptr == NULL)
+    {
+        ++__ut_alloc_thread_stats.count;
+        __ut_alloc_thread_stats.bytes += size;
+    }
+    else
+    {
+        ++__ut_alloc_thread_stats.frees;
+    }
+
+    void *result = __libc_realloc(ptr, size);
+#ifdef UT_ENABLE_LEAK_CHECK
+    // При неудаче исходный блок остается действительным; перемещенный блок
+    // сохраняет принадлежность тесту, выделившему исходный
+    if (ptr != NULL && result == NULL && size == 0)
+    {
+        __ut_leak_remove(ptr);
+    }
+    else if (ptr == NULL || result == NULL || !__ut_leak_move(ptr, result, size, __builtin_return_address(0)))
+    {
+        __ut_leak_track(result, size, __builtin_return_address(0));
+    }
+#endif
+    __UT_ALLOC_LEAVE();
+
+    return result;
+}
+
+__attribute__((weak)) void *aligned_alloc(size_t alignment, size_t size)
+{
+    __UT_ALLOC_ENTER();
+    ++__ut_alloc_thread_stats.count;
+    __ut_alloc_thread_stats.bytes += size;
+
+    void *result = __libc_memalign(alignment, size);
+#ifdef UT_ENABLE_LEAK_CHECK
+    __ut_leak_track(result, size, __builtin_return_address(0));
+#endif
+    __UT_ALLOC_LEAVE();
+
+    return result;
+}
+
+__attribute__((weak)) int posix_memalign(void **ptr, size_t alignment, size_t size)
+{
+    // Выравнивание должно быть степенью двойки, кратной размеру указателя
+    if (alignment == 0 || alignment % sizeof(void *) != 0 || (alignment & (alignment - 1)) != 0)
+    {
+        return EINVAL;
+    }
+
+    __UT_ALLOC_ENTER();
+    ++__ut_alloc_thread_stats.count;
+    __ut_alloc_thread_stats.bytes += size;
+
+    void *result = __libc_memalign(alignment, size);
+    if (result != NULL)
+    {
+        *ptr = result;
+#ifdef UT_ENABLE_LEAK_CHECK
+        __ut_leak_track(result, size, __builtin_return_address(0));
+#endif
+    }
+    __UT_ALLOC_LEAVE();
+
+    return result != NULL ? 0 : ENOMEM;
+}
+
+__attribute__((weak)) void free(void *ptr)
+{
+    __UT_ALLOC_ENTER();
+    if (ptr != NULL)
+    {
+        ++__ut_alloc_thread_stats.frees;
+#ifdef UT_ENABLE_LEAK_CHECK
+        __ut_leak_remove(ptr);
+#endif
+    }
+
+    __libc_free(ptr);
+    __UT_ALLOC_LEAVE();
+}
+// @}
+
+#endif
+
+/*!
+    \brief     Результат проверки перехвата распределителя
+    \details   \p 0 - не проверялся, \p 1 - перехват работает, \p -1 - нет.
+        Слабое определение: одна переменная на программу
+    \protected
+*/
+__attribute__((weak)) int __ut_alloc_probed;
+
+/*!
+    \brief     Проверить (однократно), что перехватчики распределителя работают
+    \details   Перехватчики отсутствуют при сборке с AddressSanitizer или
+        заменены собственным распределителем программы
+    \return    \p true, если выделения памяти учитываются; \p false иначе
+    \protected
+*/
+static inline bool __ut_alloc_active(void)
+{
+    int probed = __atomic_load_n(&__ut_alloc_probed, __ATOMIC_RELAXED);
+
+    if (probed == 0)
+    {
+        const unsigned long long count = __ut_alloc_thread_stats.count;
+        void * volatile probe = malloc(1);
+        free(probe);
+        probed = __ut_alloc_implementation && __ut_alloc_thread_stats.count != count ? 1 : -1;
+        __atomic_store_n(&__ut_alloc_probed, probed, __ATOMIC_RELAXED);
+    }
+
+    return probed > 0;
+}
+
+//! Окончание сообщения проверки, которую нельзя выполнить без перехвата распределителя
+#define __UT_ALLOC_INACTIVE_MESSAGE " failed: allocator is not interposed (built with a sanitizer or a custom allocator)"
+
+/*!
+    \brief     Вычислить выделения памяти текущим потоком с момента отметки
+    \param[in] mark показания счетчиков в момент отметки
+    \return    Разность показаний
+    \protected
+*/
+static inline struct __ut_alloc_stats __ut_alloc_since(struct __ut_alloc_stats mark)
+{
+    const struct __ut_alloc_stats now = __ut_alloc_thread_stats;
+    const struct __ut_alloc_stats delta = {
+        now.count - mark.count,
+        now.bytes - mark.bytes,
+        now.frees - mark.frees
+    };
+
+    return delta;
+}
+
+#endif  // UT_ENABLE_ALLOC_TRACKING
+
+#ifdef UT_ENABLE_ARENA
+
+/*!
+    \brief     Участок памяти арены
+    \protected
+*/
+struct __ut_arena_chunk
+{
+    struct __ut_arena_chunk *next;     //!< Следующий участок
+    size_t size;                       //!< Размер области данных, байт
+    unsigned char data[] __attribute__((aligned(16)));    //!< Область данных
+};
+
+/*!
+    \brief     Арена (линейный распределитель) потока
+    \details   Участки отображаются один раз и переиспользуются всеми тестами,
+        выполняемыми потоком
+    \protected
+*/
+struct __ut_arena
+{
+    struct __ut_arena_chunk *first;    //!< Первый участок
+    struct __ut_arena_chunk *current;  //!< Участок, из которого выделяется память
+    size_t offset;                     //!< Смещение свободной памяти в текущем участке
+#if UT_ARENA_POISON
+    struct
+    {
+        void *address;                 //!< Адрес отображения; \p NULL - свободная запись
+        size_t size;                   //!< Размер отображения, байт
+    } quarantine[UT_ARENA_QUARANTINE]; //!< Кольцевой буфер недоступных участков
+    unsigned int quarantine_next;      //!< Индекс записи для следующего участка
+#endif
+};
+
+//! Арена текущего потока
+static __thread struct __ut_arena __ut_arena;
+
+/*!
+    \brief     Отобразить новый участок арены
+    \param[in] size минимальный размер области данных
+    \return    Указатель на участок; \p NULL, если память не выделена
+    \protected
+*/
+static struct __ut_arena_chunk *__ut_arena_map(size_t size)
+{
+    const size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+
+    if (size < UT_ARENA_CHUNK_SIZE)
+    {
+        size = UT_ARENA_CHUNK_SIZE;
+    }
+    if (size > SIZE_MAX - sizeof(struct __ut_arena_chunk) - page_size)
+    {
+        return NULL;
+    }
+    const size_t mapping_size = (sizeof(struct __ut_arena_chunk) + size + page_size - 1) / page_size * page_size;
+
+    void *mapping = mmap(NULL, mapping_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    struct __ut_arena_chunk *chunk = (struct __ut_arena_chunk *)mapping;
+    chunk->next = NULL;
+    chunk->size = mapping_size - sizeof(struct __ut_arena_chunk);
+
+    return chunk;
+}
+
+/*!
+    \brief     Выделить память в арене
+    \param[in,out] arena указатель на арену
+    \param[in]     size  размер, байт
+    \return    Указатель на память, выровненную для любого типа; \p NULL, если память не выделена
+    \protected
+*/
+static void *__ut_arena_alloc(struct __ut_arena *arena, size_t size)
+{
+    // Выравниваем по 16 байт (не меньше alignof(max_align_t) на распространенных платформах)
+    if (size > SIZE_MAX - 15)
+    {
+        return NULL;
+    }
+    size = (size + 15) & ~(size_t)15;
+
+    // Быстрый путь: хватает текущего участка
+    if (arena->current != NULL && size <= arena->current->size - arena->offset)
+    {
+        void *ptr = arena->current->data + arena->offset;
+        arena->offset += size;
+
+        return ptr;
+    }
+
+    // Переходим к следующему подходящему участку, отображая новый при необходимости
+    struct __ut_arena_chunk **link = arena->current != NULL ? &arena->current->next : &arena->first;
+    while (*link != NULL && (*link)->size < size)
+    {
+        link = &(*link)->next;
+    }
+    if (*link == NULL)
+    {
+        *link = __ut_arena_map(size);
+        if (*link == NULL)
+        {
+            return NULL;
+        }
+    }
+
+    arena->current = *link;
+    arena->offset = size;
+
+    return arena->current->data;
+}
+
+/*!
+    \brief     Освободить всю память арены
+    \details   Выполняется за O(1): участки сохраняются для следующего теста.
+        С #UT_ARENA_POISON участки, использованные тестом, заменяются недоступными
+        отображениями (адреса остаются зарезервированными), а арена начинается заново,
+        поэтому обращение к памяти завершившегося теста вызывает \p SIGSEGV.
+        Зарезервированными остаются только последние #UT_ARENA_QUARANTINE участков:
+        более старые освобождаются, и их адреса могут быть выданы повторно
+    \param[in,out] arena указатель на арену
+    \protected
+*/
+static void __ut_arena_reset(struct __ut_arena *arena)
+{
+#if UT_ARENA_POISON
+    if (arena->current != NULL)
+    {
+        struct __ut_arena_chunk *unused = arena->current->next;
+
+        for (struct __ut_arena_chunk *chunk = arena->first, *next; chunk != unused; chunk = next)
+        {
+            next = chunk->next;
+            const size_t size = sizeof(struct __ut_arena_chunk) + chunk->size;
+            mmap(chunk, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_NORESERVE, -1, 0);
+
+            // Вытесняем из карантина самый старый участок
+            const unsigned int slot = arena->quarantine_next;
+            arena->quarantine_next = (slot + 1) % UT_ARENA_QUARANTINE;
+            if (arena->quarantine[slot].address != NULL)
+            {
+                munmap(arena->quarantine[slot].address, arena->quarantine[slot].size);
+            }
+            arena->quarantine[slot].address = chunk;
+            arena->quarantine[slot].size = size;
+        }
+        arena->first = unused;
+    }
+#endif
+
+    arena->current = NULL;
+    arena->offset = 0;
+}
+
+/*!
+    \brief     Выделить память в арене теста
+    \details   Память действительна до окончания after each-функции теста, после чего
+        освобождается целиком; освобождать отдельные блоки не нужно (и нельзя).
+        Арена принадлежит потоку, выполняющему тест, поэтому функцию следует
+        вызывать только из этого потока
+    \param[in] desc указатель на состояние теста
+    \param[in] size размер, байт
+    \return    Указатель на память, выровненную для любого типа; \p NULL, если память не выделена
+*/
+static inline void *ut_alloc(struct __ut_test_state *desc, size_t size)
+{
+    return desc->arena != NULL ? __ut_arena_alloc(desc->arena, size) : NULL;
+}
+
+#endif  // UT_ENABLE_ARENA
+
+#if defined(UT_ENABLE_TIMING_CACHE) || defined(UT_ENABLE_SHARDING) || defined(UT_ENABLE_BASELINE) \
+    || defined(UT_ENABLE_FAILED_FIRST) || defined(UT_ENABLE_REPORTER) || defined(UT_ENABLE_PROPERTY)
+
+/*!
+    \brief     Продолжить вычисление 64-битного хэша FNV-1a строкой
+    \details   Завершающий ноль тоже учитывается, чтобы разделить последовательные строки
+    \param[in] hash   текущее значение хэша
+    \param[in] string указатель на строку
+    \return    Новое значение хэша
+    \protected
+*/
+static uint64_t __ut_hash_string(uint64_t hash, const char *string)
+{
+    do
+    {
+        hash = (hash ^ (unsigned char)*string) * 1099511628211ull;
+    } while (*string++ != '\0');
+
+    return hash;
+}
+
+#endif
+
+#if defined(UT_ENABLE_TIMING_CACHE) || defined(UT_ENABLE_SHARDING) || defined(UT_ENABLE_BASELINE) \
+    || defined(UT_ENABLE_FAILED_FIRST)
+
+/*!
+    \brief     Вычислить ключ наименования теста
+    \details   64-битный хэш FNV-1a от наименования набора тестов и наименования теста.
+        Не зависит от расположения теста в исходных файлах
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \param[in] test_desc       указатель на структуру теста
+    \return    Ключ наименования теста
+    \protected
+*/
+static uint64_t __ut_test_name_key(const struct __ut_test_suite_desc *test_suite_desc, const struct __ut_test_desc *test_desc)
+{
+    return __ut_hash_string(__ut_hash_string(14695981039346656037ull, test_suite_desc->name), test_desc->name);
+}
+
+#ifdef UT_ENABLE_FAILED_FIRST
+
+/*!
+    \brief     Вычислить ключ теста
+    \details   64-битный хэш FNV-1a от наименования набора тестов, наименования
+        теста, файла и строки объявления
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \param[in] test_desc       указатель на структуру теста
+    \return    Ключ теста
+    \protected
+*/
+static uint64_t __ut_test_key(const struct __ut_test_suite_desc *test_suite_desc, const struct __ut_test_desc *test_desc)
+{
+    uint64_t hash = __ut_hash_string(__ut_test_name_key(test_suite_desc, test_desc), test_desc->file);
+
+    for (unsigned int i = 0; i < sizeof(test_desc->line); ++i)
+    {
+        hash = (hash ^ ((test_desc->line >> (8 * i)) & 0xFF)) * 1099511628211ull;
+    }
+
+    return hash;
+}
+
+#endif
+
+#endif
+
+#ifdef UT_ENABLE_TIMING_CACHE
+
+/*!
+    \brief     Запись кэша длительностей тестов
+    \protected
+*/
+struct __ut_timing
+{
+    uint64_t key;                      //!< Ключ наименования теста, см. #__ut_test_name_key (без файла и строки: длительность сохраняется при перемещении теста)
+    uint64_t suite_key;                //!< Ключ наименования набора тестов (для удаления записей исчезнувших тестов)
+    uint64_t wall_ns;                  //!< Длительность теста, нс
+};
+
+/*!
+    \brief     Кэш длительностей тестов
+    \details   Записи упорядочены по ключу. Файл кэша содержит сигнатуру
+        \p "UTTC2\0\0\0", количество записей (\p uint64_t) и сами записи.
+        Слабое определение: один кэш на программу, сохраняемый один раз
+        при ее завершении (см. #__ut_timing_cache_save)
+    \protected
+*/
+struct __ut_timing_cache_state
+{
+    bool loaded;                       //!< Флаг загрузки кэша из файла
+    bool updated;                      //!< Флаг обновления кэша длительностями наборов тестов
+    bool save_registered;              //!< Флаг регистрации #__ut_timing_cache_save
+    pid_t pid;                         //!< Процесс, загрузивший кэш
+    struct __ut_timing *timings;       //!< Массив записей
+    size_t count;                      //!< Количество записей
+    size_t capacity;                   //!< Вместимость массива записей
+};
+__attribute__((weak)) struct __ut_timing_cache_state __ut_timing_cache;
+
+//! Сигнатура файла кэша длительностей тестов
+static const char __ut_timing_cache_magic[8] = "UTTC2";
+
+/*!
+    \brief     Получить путь к файлу кэша длительностей тестов
+    \protected
+*/
+static const char *__ut_timing_cache_path(void)
+{
+    const char *path = getenv("UT_TIMING_CACHE");
+
+    return path != NULL && *path != '\0' ? path : UT_TIMING_CACHE_FILE;
+}
+
+/*!
+    \brief     Сравнить две записи кэша по ключу (для \p qsort и \p bsearch)
+    \protected
+*/
+static int __ut_timing_compare(const void *a, const void *b)
+{
+    const uint64_t x = ((const struct __ut_timing *)a)->key, y = ((const struct __ut_timing *)b)->key;
+
+    return (x > y) - (x < y);
+}
+
+/*!
+    \brief     Сравнить две записи кэша по убыванию длительности, при равенстве - по ключу (для \p qsort)
+    \protected
+*/
+static int __ut_timing_compare_desc(const void *a, const void *b)
+{
+    const struct __ut_timing *x = (const struct __ut_timing *)a, *y = (const struct __ut_timing *)b;
+
+    if (x->wall_ns != y->wall_ns)
+    {
+        return (x->wall_ns < y->wall_ns) - (x->wall_ns > y->wall_ns);
+    }
+
+    return __ut_timing_compare(a, b);
+}
+
+/*!
+    \brief     Сравнить два ключа (для \p qsort и \p bsearch)
+    \protected
+*/
+static int __ut_timing_key_compare(const void *a, const void *b)
+{
+    const uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+/*!
+    \brief     Сохранить кэш длительностей тестов в файл
+    \details   Регистрируется \p atexit при загрузке кэша; ничего не делает в дочерних
+        процессах и если кэш не обновлялся. Файл перезаписывается атомарно (через временный файл)
+    \protected
+*/
+static void __ut_timing_cache_save(void)
+{
+    if (!__ut_timing_cache.updated || __ut_timing_cache.pid != getpid())
+    {
+        return;
+    }
+    __ut_timing_cache.updated = false;
+
+    const char *path = __ut_timing_cache_path();
+    char temp_path[UT_BUFFER_SIZE];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+
+    FILE *file = fopen(temp_path, "wb");
+    if (file == NULL)
+    {
+        return;
+    }
+
+    const uint64_t count = __ut_timing_cache.count;
+    const bool written = fwrite(__ut_timing_cache_magic, sizeof(__ut_timing_cache_magic), 1, file) == 1
+        && fwrite(&count, sizeof(count), 1, file) == 1
+        && fwrite(__ut_timing_cache.timings, sizeof(struct __ut_timing), count, file) == count;
+    if (fclose(file) == 0 && written)
+    {
+        rename(temp_path, path);
+    }
+    else
+    {
+        remove(temp_path);
+    }
+}
+
+/*!
+    \brief     Загрузить кэш длительностей тестов (однократно)
+    \details   Отсутствующий или поврежденный файл равносилен пустому кэшу
+    \protected
+*/
+static void __ut_timing_cache_load(void)
+{
+    if (__ut_timing_cache.loaded)
+    {
+        return;
+    }
+    __ut_timing_cache.loaded = true;
+    __ut_timing_cache.pid = getpid();
+    if (!__ut_timing_cache.save_registered)
+    {
+        __ut_timing_cache.save_registered = true;
+        atexit(__ut_timing_cache_save);
+    }
+
+    FILE *file = fopen(__ut_timing_cache_path(), "rb");
+    if (file == NULL)
+    {
+        return;
+    }
+
+    char magic[sizeof(__ut_timing_cache_magic)];
+    uint64_t count;
+    if (fread(magic, sizeof(magic), 1, file) == 1 && memcmp(magic, __ut_timing_cache_magic, sizeof(magic)) == 0
+        && fread(&count, sizeof(count), 1, file) == 1 && count <= SIZE_MAX / sizeof(struct __ut_timing))
+    {
+        __ut_timing_cache.timings = (struct __ut_timing *)malloc(count * sizeof(struct __ut_timing));
+        if (__ut_timing_cache.timings != NULL
+            && fread(__ut_timing_cache.timings, sizeof(struct __ut_timing), count, file) == count)
+        {
+            __ut_timing_cache.count = __ut_timing_cache.capacity = count;
+        }
+    }
+
+    fclose(file);
+}
+
+/*!
+    \brief     Найти длительность теста в кэше
+    \param[in] key   ключ теста
+    \param[in] count количество первых (упорядоченных по ключу) записей, среди которых ищется тест
+    \return    Указатель на запись кэша; \p NULL, если тест не найден
+    \protected
+*/
+static struct __ut_timing *__ut_timing_cache_find(uint64_t key, size_t count)
+{
+    const struct __ut_timing needle = { key, 0, 0 };
+
+    return count == 0 ? NULL : (struct __ut_timing *)bsearch(&needle,
+        __ut_timing_cache.timings, count, sizeof(struct __ut_timing), __ut_timing_compare);
+}
+
+/*!
+    \brief     Обновить кэш длительностями выполненных тестов набора
+    \details   Новая длительность усредняется с сохраненной, чтобы сгладить случайные выбросы.
+        Записи тестов набора, которых в нем больше нет (удаленных или переименованных),
+        удаляются. Файл сохраняется при завершении программы (см. #__ut_timing_cache_save).
+        Вызывается параллельным исполнителем - единственным, который упорядочивает тесты по кэшу,
+        в том числе когда он выполняет набор последовательно
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \param[in] test_count      количество тестов в наборе
+    \protected
+*/
+static inline void __ut_timing_cache_update(const struct __ut_test_suite_desc *test_suite_desc, unsigned int test_count)
+{
+    __ut_timing_cache_load();
+    __ut_timing_cache.updated = true;
+
+    const uint64_t suite_key = __ut_hash_string(14695981039346656037ull, test_suite_desc->name);
+    size_t sorted_count = __ut_timing_cache.count;
+
+    for (unsigned int i = 0; i < test_count; ++i)
+    {
+        const struct __ut_test_state *test_state = &(test_suite_desc->test_states[i]);
+        if (!UT_IS_TEST_STARTED(test_state))
+        {
+            continue;
+        }
+
+        const uint64_t key = __ut_test_name_key(test_suite_desc, test_state->test);
+        // Добавленные в конец записи не упорядочены - ищем среди прежних
+        struct __ut_timing *timing = __ut_timing_cache_find(key, sorted_count);
+        if (timing != NULL)
+        {
+            timing->wall_ns = (timing->wall_ns + test_state->usage.wall_ns) / 2;
+            continue;
+        }
+
+        // Новую запись добавляем в конец; порядок восстановим после цикла
+        if (__ut_timing_cache.count == __ut_timing_cache.capacity)
+        {
+            const size_t capacity = __ut_timing_cache.capacity * 2 + test_count;
+            struct __ut_timing *timings = (struct __ut_timing *)realloc(__ut_timing_cache.timings,
+                capacity * sizeof(struct __ut_timing));
+            if (timings == NULL)
+            {
+                break;
+            }
+            __ut_timing_cache.timings = timings;
+            __ut_timing_cache.capacity = capacity;
+        }
+        __ut_timing_cache.timings[__ut_timing_cache.count].key = key;
+        __ut_timing_cache.timings[__ut_timing_cache.count].suite_key = suite_key;
+        __ut_timing_cache.timings[__ut_timing_cache.count].wall_ns = test_state->usage.wall_ns;
+        ++__ut_timing_cache.count;
+    }
+
+    // Удаляем записи исчезнувших тестов набора, сохраняя порядок остальных
+    uint64_t *keys = (uint64_t *)malloc(test_count * sizeof(uint64_t));
+    if (keys != NULL)
+    {
+        for (unsigned int i = 0; i < test_count; ++i)
+        {
+            keys[i] = __ut_test_name_key(test_suite_desc, &(test_suite_desc->test_descs[i]));
+        }
+        qsort(keys, test_count, sizeof(uint64_t), __ut_timing_key_compare);
+
+        size_t kept = 0;
+        for (size_t j = 0; j < __ut_timing_cache.count; ++j)
+        {
+            const struct __ut_timing *timing = &__ut_timing_cache.timings[j];
+            if (timing->suite_key == suite_key
+                && bsearch(&timing->key, keys, test_count, sizeof(uint64_t), __ut_timing_key_compare) == NULL)
+            {
+                sorted_count -= j < sorted_count;
+                continue;
+            }
+            __ut_timing_cache.timings[kept++] = *timing;
+        }
+        __ut_timing_cache.count = kept;
+        free(keys);
+    }
+
+    if (__ut_timing_cache.count != sorted_count)
+    {
+        qsort(__ut_timing_cache.timings, __ut_timing_cache.count, sizeof(struct __ut_timing), __ut_timing_compare);
+    }
+}
+
+/*!
+    \brief     Упорядочить тесты для выдачи рабочим потокам по убыванию длительности
+    \details   Планирование LPT (longest processing time first): длинные тесты
+        начинаются первыми, и рабочие потоки заканчивают работу примерно одновременно.
+        Тесты, отсутствующие в кэше, выдаются в самом начале, в порядке объявления:
+        их длительность неизвестна и может оказаться наибольшей
+    \param[in]  test_suite_desc указатель на структуру набора тестов
+    \param[in]  test_count      количество тестов в наборе
+    \param[out] order           массив индексов тестов в порядке выдачи
+    \protected
+*/
+static inline void __ut_timing_order(const struct __ut_test_suite_desc *test_suite_desc, unsigned int test_count, unsigned int *order)
+{
+    __ut_timing_cache_load();
+
+    struct __ut_timing *known = (struct __ut_timing *)malloc(test_count * sizeof(struct __ut_timing));
+    unsigned int known_count = 0, unknown_count = 0;
+
+    for (unsigned int i = 0; i < test_count; ++i)
+    {
+        const struct __ut_timing *timing = known != NULL
+            ? __ut_timing_cache_find(__ut_test_name_key(test_suite_desc, &(test_suite_desc->test_descs[i])),
+                __ut_timing_cache.count)
+            : NULL;
+        if (timing != NULL)
+        {
+            // Упорядочиваем по убыванию длительности; индекс храним в ключе
+            known[known_count].key = i;
+            known[known_count].wall_ns = timing->wall_ns;
+            ++known_count;
+        }
+        else
+        {
+            order[unknown_count++] = i;
+        }
+    }
+
+    if (known_count > 0)
+    {
+        qsort(known, known_count, sizeof(struct __ut_timing), __ut_timing_compare_desc);
+        for (unsigned int i = 0; i < known_count; ++i)
+        {
+            order[unknown_count + i] = (unsigned int)known[i].key;
+        }
+    }
+
+    free(known);
+}
+
+#endif  // UT_ENABLE_TIMING_CACHE
+
+#ifdef UT_ENABLE_FAILED_FIRST
+
+/*!
+    \brief     Множество ранее проваленных тестов и режим повторного запуска
+    \details   Ключи тестов (см. #__ut_test_key) упорядочены по возрастанию. Файл содержит
+        сигнатуру \p "UTFF1\0\0\0", количество ключей (\p uint64_t) и сами ключи;
+        время изменения файла - время завершения предыдущего запуска.
+        Слабое определение: одно множество на программу, сохраняемое один раз
+        при ее завершении (см. #__ut_failed_save)
+    \protected
+*/
+struct __ut_failed_state
+{
+    bool loaded;                       //!< Флаг загрузки множества из файла
+    bool updated;                      //!< Флаг обновления множества результатами наборов тестов
+    bool save_registered;              //!< Флаг регистрации #__ut_failed_save
+    pid_t pid;                         //!< Процесс, загрузивший множество
+    bool mode_loaded;                  //!< Флаг задания режима (из окружения или командной строки)
+    bool first;                        //!< Флаг запуска первыми ранее проваленных тестов и тестов из измененных файлов
+    bool only;                         //!< Флаг запуска только ранее проваленных тестов
+    bool empty;                        //!< Флаг отсутствия проваленных тестов в предыдущем запуске
+    uint64_t *keys;                    //!< Массив ключей проваленных тестов
+    size_t count;                      //!< Количество ключей
+    size_t capacity;                   //!< Вместимость массива ключей
+    time_t saved_at;                   //!< Время изменения файла; \p 0, если файла нет
+};
+__attribute__((weak)) struct __ut_failed_state __ut_failed;
+
+//! Сигнатура файла проваленных тестов
+static const char __ut_failed_magic[8] = "UTFF1";
+
+/*!
+    \brief     Получить путь к файлу проваленных тестов
+    \protected
+*/
+static const char *__ut_failed_path(void)
+{
+    const char *path = getenv("UT_FAILED_FILE");
+
+    return path != NULL && *path != '\0' ? path : UT_FAILED_FILE;
+}
+
+/*!
+    \brief     Сравнить два ключа (для \p qsort и \p bsearch)
+    \protected
+*/
+static int __ut_failed_compare(const void *a, const void *b)
+{
+    const uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+/*!
+    \brief     Задать режим повторного запуска
+    \details   Режимы накапливаются: запуск только проваленных тестов
+        не отменяется последующим запуском их первыми
+    \param[in] only \p true - запускать только ранее проваленные тесты;
+        \p false - запускать их первыми
+    \protected
+*/
+static void __ut_failed_set_mode(bool only)
+{
+    __ut_failed.mode_loaded = true;
+    __ut_failed.first = true;
+    __ut_failed.only = __ut_failed.only || only;
+}
+
+/*!
+    \brief     Прочитать флаг режима из окружения
+    \param[in] name          наименование переменной окружения
+    \param[in] default_value значение по умолчанию
+    \protected
+*/
+static bool __ut_failed_env_flag(const char *name, bool default_value)
+{
+    const char *value = getenv(name);
+
+    return value != NULL && *value != '\0' ? strcmp(value, "0") != 0 : default_value;
+}
+
+/*!
+    \brief     Сохранить множество проваленных тестов в файл
+    \details   Регистрируется \p atexit при загрузке множества; ничего не делает в дочерних
+        процессах и если ни один набор тестов не выполнялся. Файл перезаписывается
+        атомарно (через временный файл)
+    \protected
+*/
+static void __ut_failed_save(void)
+{
+    if (!__ut_failed.updated || __ut_failed.pid != getpid())
+    {
+        return;
+    }
+    __ut_failed.updated = false;
+
+    const char *path = __ut_failed_path();
+    char temp_path[UT_BUFFER_SIZE];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+
+    FILE *file = fopen(temp_path, "wb");
+    if (file == NULL)
+    {
+        return;
+    }
+
+    const uint64_t count = __ut_failed.count;
+    const bool written = fwrite(__ut_failed_magic, sizeof(__ut_failed_magic), 1, file) == 1
+        && fwrite(&count, sizeof(count), 1, file) == 1
+        && fwrite(__ut_failed.keys, sizeof(uint64_t), count, file) == count;
+    if (fclose(file) == 0 && written)
+    {
+        rename(temp_path, path);
+    }
+    else
+    {
+        remove(temp_path);
+    }
+}
+
+/*!
+    \brief     Загрузить множество проваленных тестов и режим повторного запуска (однократно)
+    \details   Режим читается из переменных \p UT_FAILED_FIRST и \p UT_FAILED_ONLY;
+        параметры командной строки (см. #__ut_parse_arguments) имеют приоритет.
+        Отсутствующий или поврежденный файл равносилен пустому множеству
+    \protected
+*/
+static void __ut_failed_load(void)
+{
+    if (!__ut_failed.mode_loaded)
+    {
+        __ut_failed.mode_loaded = true;
+        __ut_failed.only = __ut_failed_env_flag("UT_FAILED_ONLY", UT_FAILED_ONLY);
+        __ut_failed.first = __ut_failed.only || __ut_failed_env_flag("UT_FAILED_FIRST", UT_FAILED_FIRST);
+    }
+
+    if (__ut_failed.loaded)
+    {
+        return;
+    }
+    __ut_failed.loaded = true;
+    __ut_failed.empty = true;
+    __ut_failed.pid = getpid();
+    if (!__ut_failed.save_registered)
+    {
+        __ut_failed.save_registered = true;
+        atexit(__ut_failed_save);
+    }
+
+    FILE *file = fopen(__ut_failed_path(), "rb");
+    if (file == NULL)
+    {
+        return;
+    }
+
+    struct stat file_stat;
+    if (fstat(fileno(file), &file_stat) == 0)
+    {
+        __ut_failed.saved_at = file_stat.st_mtime;
+    }
+
+    char magic[sizeof(__ut_failed_magic)];
+    uint64_t count;
+    if (fread(magic, sizeof(magic), 1, file) == 1 && memcmp(magic, __ut_failed_magic, sizeof(magic)) == 0
+        && fread(&count, sizeof(count), 1, file) == 1 && count <= SIZE_MAX / sizeof(uint64_t))
+    {
+        __ut_failed.keys = (uint64_t *)malloc(count * sizeof(uint64_t));
+        if (__ut_failed.keys != NULL && fread(__ut_failed.keys, sizeof(uint64_t), count, file) == count)
+        {
+            __ut_failed.count = __ut_failed.capacity = count;
+            __ut_failed.empty = count == 0;
+        }
+    }
+
+    fclose(file);
+}
+
+/*!
+    \brief     Проверить, провалился ли тест в предыдущем запуске
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \param[in] test_desc       указатель на структуру теста
+    \protected
+*/
+static bool __ut_failed_contains(const struct __ut_test_suite_desc *test_suite_desc, const struct __ut_test_desc *test_desc)
+{
+    const uint64_t key = __ut_test_key(test_suite_desc, test_desc);
+
+    return __ut_failed.count > 0
+        && bsearch(&key, __ut_failed.keys, __ut_failed.count, sizeof(uint64_t), __ut_failed_compare) != NULL;
+}
+
+/*!
+    \brief     Проверить, изменен ли исходный файл после предыдущего запуска
+    \details   Сравнивается время изменения файла и файла проваленных тестов,
+        поэтому путь \p __FILE__ должен быть доступен из текущего каталога
+    \param[in] path путь к исходному файлу
+    \protected
+*/
+static bool __ut_failed_changed(const char *path)
+{
+    struct stat file_stat;
+
+    return __ut_failed.saved_at != 0 && stat(path, &file_stat) == 0 && file_stat.st_mtime > __ut_failed.saved_at;
+}
+
+/*!
+    \brief     Проверить, нужно ли выполнять тест в режиме запуска только проваленных тестов
+    \details   Если в предыдущем запуске провалов не было, то выполняются все тесты
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \param[in] test_desc       указатель на структуру теста
+    \return    \p true, если тест нужно выполнить; \p false иначе
+    \protected
+*/
+static bool __ut_failed_selected(const struct __ut_test_suite_desc *test_suite_desc, const struct __ut_test_desc *test_desc)
+{
+    return !__ut_failed.only || __ut_failed.empty || __ut_failed_contains(test_suite_desc, test_desc);
+}
+
+/*!
+    \brief     Упорядочить тесты для повторного запуска
+    \details   Устойчиво переставляет тесты: сначала ранее проваленные, затем тесты
+        из исходных файлов, измененных после предыдущего запуска, затем остальные.
+        Если режим не включен, то порядок не меняется
+    \param[in]     test_suite_desc указатель на структуру набора тестов
+    \param[in]     test_count      количество тестов в наборе
+    \param[in,out] order           массив индексов тестов в порядке выдачи; \p NULL - в порядке объявления
+    \return    Массив индексов тестов в порядке выдачи: \p order или, если \p order
+        равен \p NULL, новый массив (освобождается вызывающим); \p NULL - в порядке объявления
+    \protected
+*/
+static unsigned int *__ut_failed_order(const struct __ut_test_suite_desc *test_suite_desc, unsigned int test_count,
+    unsigned int *order)
+{
+    __ut_failed_load();
+
+    if (!__ut_failed.first || test_count == 0)
+    {
+        return order;
+    }
+
+    unsigned char *ranks = (unsigned char *)malloc(test_count);
+    unsigned int *sorted = (unsigned int *)malloc(test_count * sizeof(unsigned int));
+    if (ranks == NULL || sorted == NULL)
+    {
+        free(ranks);
+        free(sorted);
+        return order;
+    }
+
+    // Тесты одного файла обычно соседствуют, поэтому запоминаем последний проверенный файл
+    const char *file = NULL;
+    bool changed = false;
+    for (unsigned int n = 0; n < test_count; ++n)
+    {
+        const struct __ut_test_desc *test_desc = &(test_suite_desc->test_descs[order != NULL ? order[n] : n]);
+        if (test_desc->file != file)
+        {
+            file = test_desc->file;
+            changed = __ut_failed_changed(file);
+        }
+        ranks[n] = __ut_failed_contains(test_suite_desc, test_desc) ? 0 : changed ? 1 : 2;
+    }
+
+    unsigned int sorted_count = 0;
+    for (unsigned char rank = 0; rank <= 2; ++rank)
+    {
+        for (unsigned int n = 0; n < test_count; ++n)
+        {
+            if (ranks[n] == rank)
+            {
+                sorted[sorted_count++] = order != NULL ? order[n] : n;
+            }
+        }
+    }
+    free(ranks);
+
+    if (order == NULL)
+    {
+        return sorted;
+    }
+
+    memcpy(order, sorted, test_count * sizeof(unsigned int));
+    free(sorted);
+
+    return order;
+}
+
+/*!
+    \brief     Обновить множество проваленных тестов результатами набора
+    \details   Проваленные тесты добавляются, успешные - удаляются; невыполненные
+        тесты сохраняют прежнее состояние. Файл сохраняется при завершении программы
+        (см. #__ut_failed_save), даже если множество не изменилось: время его
+        изменения отмечает предыдущий запуск
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \param[in] test_count      количество тестов в наборе
+    \protected
+*/
+static void __ut_failed_update(const struct __ut_test_suite_desc *test_suite_desc, unsigned int test_count)
+{
+    __ut_failed_load();
+    __ut_failed.updated = true;
+
+    size_t sorted_count = __ut_failed.count;
+
+    for (unsigned int i = 0; i < test_count; ++i)
+    {
+        const struct __ut_test_state *test_state = &(test_suite_desc->test_states[i]);
+        if (!UT_IS_TEST_STARTED(test_state))
+        {
+            continue;
+        }
+
+        const uint64_t key = __ut_test_key(test_suite_desc, test_state->test);
+        uint64_t *found = sorted_count > 0
+            ? (uint64_t *)bsearch(&key, __ut_failed.keys, sorted_count, sizeof(uint64_t), __ut_failed_compare)
+            : NULL;
+
+        if (!UT_IS_TEST_FAILED(test_state))
+        {
+            // Успешный тест удаляем, сохраняя порядок остальных ключей
+            if (found != NULL)
+            {
+                memmove(found, found + 1, (__ut_failed.count - (size_t)(found - __ut_failed.keys) - 1) * sizeof(uint64_t));
+                --__ut_failed.count;
+                --sorted_count;
+            }
+            continue;
+        }
+        if (found != NULL)
+        {
+            continue;
+        }
+
+        // Новый ключ добавляем в конец; порядок восстановим после цикла
+        if (__ut_failed.count == __ut_failed.capacity)
+        {
+            const size_t capacity = __ut_failed.capacity * 2 + 16;
+            uint64_t *keys = (uint64_t *)realloc(__ut_failed.keys, capacity * sizeof(uint64_t));
+            if (keys == NULL)
+            {
+                break;
+            }
+            __ut_failed.keys = keys;
+            __ut_failed.capacity = capacity;
+        }
+        __ut_failed.keys[__ut_failed.count++] = key;
+    }
+
+    if (__ut_failed.count != sorted_count)
+    {
+        qsort(__ut_failed.keys, __ut_failed.count, sizeof(uint64_t), __ut_failed_compare);
+    }
+}
+
+/*!
+    \brief     Запускать ранее проваленные тесты и тесты из измененных файлов первыми
+*/
+#define UT_SET_FAILED_FIRST() __ut_failed_set_mode(false)
+
+/*!
+    \brief     Запускать только ранее проваленные тесты
+*/
+#define UT_SET_FAILED_ONLY() __ut_failed_set_mode(true)
+
+#endif  // UT_ENABLE_FAILED_FIRST
+
+#ifdef UT_ENABLE_REPORTER
+
+//! \name Форматы отчета
+//! @{
+#define __UT_REPORT_NONE  0            //!< Отчет не формируется
+#define __UT_REPORT_JUNIT 1            //!< JUnit XML
+#define __UT_REPORT_TAP   2            //!< TAP версии 13
+#define __UT_REPORT_JSONL 3            //!< JSON Lines: объект на строку
+#define __UT_REPORT_BINARY 4           //!< Двоичный журнал, см. #__ut_log_header
+//! @}
+
+//! \name Способы экранирования строк отчета
+//! @{
+#define __UT_REPORT_ESCAPE_XML  0      //!< Значение атрибута XML
+#define __UT_REPORT_ESCAPE_JSON 1      //!< Строка JSON (и YAML в двойных кавычках)
+#define __UT_REPORT_ESCAPE_TAP  2      //!< Описание теста TAP
+//! @}
+
+//! \name Состояния теста в отчете и двоичном журнале
+//! @{
+#define __UT_LOG_PASSED  0             //!< Тест успешен
+#define __UT_LOG_FAILED  1             //!< Тест провален
+#define __UT_LOG_SKIPPED 2             //!< Запуск теста отменен
+//! @}
+
+//! Наименования состояний теста в отчете
+static const char * const __ut_report_statuses[] = { "passed", "failed", "skipped" };
+
+//! Смещение отсутствующей строки двоичного журнала
+#define __UT_LOG_NO_STRING UINT32_MAX
+//! Индекс теста записи о провале startup-функции набора тестов
+#define __UT_LOG_NO_INDEX UINT32_MAX
+//! Флаг двоичного журнала: длительности тестов измерены (см. #UT_ENABLE_RUSAGE)
+#define __UT_LOG_TIMED 1u
+
+/*!
+    \brief     Заголовок двоичного журнала результатов
+    \details   Файл журнала содержит заголовок, записи тестов (#__ut_log_record)
+        в порядке учета результатов, таблицу строк (строки с завершающими нулями)
+        и заключительную структуру (#__ut_log_footer). Числа записаны в порядке
+        байтов платформы, на которой выполнялись тесты
+*/
+struct __ut_log_header
+{
+    char magic[8];                     //!< Сигнатура \p "UTLOG1\0\0"
+    uint32_t record_size;              //!< Размер записи теста, байт
+    uint32_t flags;                    //!< Флаги, см. #__UT_LOG_TIMED
+};
+
+/*!
+    \brief     Запись теста двоичного журнала результатов
+    \details   Строки задаются смещениями в таблице строк (см. #UT_LOG_STRING)
+*/
+struct __ut_log_record
+{
+    uint32_t suite;                    //!< Смещение наименования набора тестов
+    uint32_t name;                     //!< Смещение наименования теста
+    uint32_t file;                     //!< Смещение пути к файлу теста
+    uint32_t message;                  //!< Смещение сообщения о провале или причины отмены; #__UT_LOG_NO_STRING, если сообщения нет
+    uint32_t line;                     //!< Строка объявления теста
+    uint32_t index;                    //!< Индекс теста в наборе; #__UT_LOG_NO_INDEX - провал startup-функции
+    uint32_t performed_count;          //!< Количество запущенных проверок
+    uint32_t successed_count;          //!< Количество успешных проверок
+    uint8_t status;                    //!< Состояние теста, см. #__UT_LOG_PASSED
+    uint8_t reserved[7];               //!< Не используется (нули)
+    uint64_t wall_ns;                  //!< Астрономическое время теста, нс
+    uint64_t user_ns;                  //!< Процессорное время теста в режиме пользователя, нс
+    uint64_t system_ns;                //!< Процессорное время теста в режиме ядра, нс
+};
+
+/*!
+    \brief     Заключительная структура двоичного журнала результатов
+    \details   Записывается при завершении программы; журнал без нее считается незавершенным
+*/
+struct __ut_log_footer
+{
+    uint64_t record_count;             //!< Количество записей тестов
+    uint64_t strings_offset;           //!< Смещение таблицы строк от начала файла, байт
+    uint64_t strings_size;             //!< Размер таблицы строк, байт
+    char magic[8];                     //!< Сигнатура \p "UTLEND\0\0"
+};
+
+//! Сигнатура заголовка двоичного журнала
+static const char __ut_log_header_magic[8] = "UTLOG1";
+//! Сигнатура заключительной структуры двоичного журнала
+static const char __ut_log_footer_magic[8] = "UTLEND";
+
+/*!
+    \brief     Двоичный журнал результатов, открытый для чтения (см. #UT_LOG_OPEN)
+*/
+struct __ut_log
+{
+    void *data;                        //!< Отображение файла в память
+    size_t size;                       //!< Размер файла, байт
+    const struct __ut_log_record *records;  //!< Массив записей тестов
+    size_t record_count;               //!< Количество записей тестов
+    const char *strings;               //!< Таблица строк
+    size_t strings_size;               //!< Размер таблицы строк, байт
+    bool timed;                        //!< Флаг измерения длительностей тестов
+};
+
+/*!
+    \brief     Итоги двоичного журнала результатов (см. #UT_LOG_SUMMARIZE)
+*/
+struct __ut_log_summary
+{
+    unsigned long long test_counts[3]; //!< Количество успешных, проваленных и отмененных тестов
+    unsigned long long performed_count;    //!< Количество запущенных проверок
+    unsigned long long successed_count;    //!< Количество успешных проверок
+    unsigned long long wall_ns;        //!< Суммарное астрономическое время тестов, нс
+};
+
+/*!
+    \brief     Запись о тесте для отчета
+    \details   Формируется по состоянию выполненного теста или по записи двоичного журнала
+    \protected
+*/
+struct __ut_report_entry
+{
+    const char *suite;                 //!< Наименование набора тестов
+    const char *name;                  //!< Наименование теста
+    const char *file;                  //!< Путь к файлу теста
+    unsigned int line;                 //!< Строка объявления теста
+    unsigned int index;                //!< Индекс теста в наборе
+    int status;                        //!< Состояние теста, см. #__UT_LOG_PASSED
+    const char *message;               //!< Сообщение о провале или причина отмены; \p NULL, если сообщения нет
+    unsigned int performed_count;      //!< Количество запущенных проверок
+    unsigned int successed_count;      //!< Количество успешных проверок
+    bool timed;                        //!< Флаг измерения длительности теста
+    unsigned long long wall_ns;        //!< Астрономическое время теста, нс
+    unsigned long long user_ns;        //!< Процессорное время теста в режиме пользователя, нс
+    unsigned long long system_ns;      //!< Процессорное время теста в режиме ядра, нс
+};
+
+//! Минимальный размер участка хранилища сообщений, байт
+#define __UT_REPORT_CHUNK_SIZE (64 * 1024)
+
+/*!
+    \brief     Участок хранилища сообщений о провалах
+    \protected
+*/
+struct __ut_report_chunk
+{
+    struct __ut_report_chunk *next;    //!< Указатель на предыдущий участок
+    size_t size;                       //!< Размер данных, байт
+    size_t used;                       //!< Занятый размер данных, байт
+    char data[];                       //!< Данные
+};
+
+/*!
+    \brief     Состояние отчета
+    \details   Отчет пишется только вызывающим потоком (по мере учета результатов тестов)
+        через буфер, который сбрасывается одним вызовом \p writev при заполнении
+        и по завершении набора тестов. Сообщения о провалах копируются в хранилище,
+        которое освобождается по завершении набора тестов. Слабое определение:
+        один отчет на программу, сколько бы единиц трансляции ни включали заголовок
+    \protected
+*/
+struct __ut_report_state
+{
+    bool loaded;                       //!< Флаг чтения параметров отчета
+    bool opened;                       //!< Флаг открытия отчета
+    bool close_registered;             //!< Флаг регистрации #__ut_report_close
+    bool suite_opened;                 //!< Флаг начатого и не завершенного набора тестов
+    int format;                        //!< Формат отчета, см. #__UT_REPORT_JUNIT
+    const char *format_name;           //!< Наименование формата; \p NULL - из окружения
+    const char *path;                  //!< Путь к файлу отчета; \p NULL - из окружения; пустая строка - стандартный вывод
+    int fd;                            //!< Дескриптор файла отчета
+    pid_t pid;                         //!< Процесс, открывший отчет
+    unsigned int test_number;          //!< Количество тестов в отчете
+    unsigned int suite_counts[3];      //!< Количество успешных, проваленных и отмененных тестов текущего набора
+    size_t length;                     //!< Занятый размер буфера, байт
+    char buffer[UT_REPORT_BUFFER_SIZE];    //!< Буфер отчета
+    struct __ut_report_chunk *chunks;  //!< Хранилище сообщений о провалах (последний участок)
+    char *strings;                     //!< Таблица строк двоичного журнала
+    size_t strings_size;               //!< Размер таблицы строк, байт
+    size_t strings_capacity;           //!< Вместимость таблицы строк, байт
+    uint32_t *slots;                   //!< Хэш-таблица строк: смещения, увеличенные на 1; \p 0 - свободный слот
+    size_t slots_count;                //!< Количество занятых слотов
+    size_t slots_capacity;             //!< Количество слотов (степень двойки)
+};
+__attribute__((weak)) struct __ut_report_state __ut_report;
+
+//! Мьютекс, защищающий хранилище сообщений о провалах (\p __ut_report.chunks)
+__attribute__((weak)) pthread_mutex_t __ut_report_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/*!
+    \brief     Состояние теста, выполняемого потоком (для сохранения сообщений о провалах)
+    \details   Слабое определение: проверки теста, определенного в одной единице трансляции,
+        видят тест, запущенный из другой
+*/
+__attribute__((weak)) __thread struct __ut_test_state *__ut_report_current;
+
+/*!
+    \brief     Задать формат и файл отчета
+    \param[in] format наименование формата (\p "junit", \p "tap" или \p "jsonl"); \p NULL - не изменять
+    \param[in] path   путь к файлу отчета (пустая строка - стандартный вывод); \p NULL - не изменять
+    \warning   Действует, если вызвана до запуска первого набора тестов
+    \protected
+*/
+static void __ut_report_set(const char *format, const char *path)
+{
+    if (format != NULL)
+    {
+        __ut_report.format_name = format;
+    }
+    if (path != NULL)
+    {
+        __ut_report.path = path;
+    }
+}
+
+/*!
+    \brief     Прочитать параметры отчета (однократно)
+    \details   Используются переменные окружения \p UT_REPORT и \p UT_REPORT_FILE;
+        параметры командной строки (см. #__ut_parse_arguments) имеют приоритет.
+        Отчет неизвестного формата не формируется
+    \protected
+*/
+static void __ut_report_load(void)
+{
+    if (__ut_report.loaded)
+    {
+        return;
+    }
+    __ut_report.loaded = true;
+
+    if (__ut_report.format_name == NULL)
+    {
+        const char *format = getenv("UT_REPORT");
+        __ut_report.format_name = format != NULL ? format : UT_REPORT_FORMAT;
+    }
+    if (__ut_report.path == NULL)
+    {
+        const char *path = getenv("UT_REPORT_FILE");
+        __ut_report.path = path != NULL ? path : UT_REPORT_FILE;
+    }
+
+    __ut_report.format = strcmp(__ut_report.format_name, "junit") == 0 ? __UT_REPORT_JUNIT
+        : strcmp(__ut_report.format_name, "tap") == 0 ? __UT_REPORT_TAP
+        : strcmp(__ut_report.format_name, "jsonl") == 0 ? __UT_REPORT_JSONL
+        : strcmp(__ut_report.format_name, "binary") == 0 ? __UT_REPORT_BINARY
+        : __UT_REPORT_NONE;
+}
+
+/*!
+    \brief     Сохранить сообщение о провале теста
+    \details   Сохраняется только первое сообщение; оно копируется в хранилище
+        (длиной не более #UT_REPORT_MESSAGE_SIZE), поскольку часто формируется
+        во временном буфере. Может вызываться одновременно из разных потоков
+    \param[in,out] test_state указатель на состояние теста; \p NULL - ничего не делать
+    \param[in]     message    указатель на строку-сообщение
+    \protected
+*/
+static void __ut_report_record(struct __ut_test_state *test_state, const char *message)
+{
+    if (test_state == NULL || test_state->failure_message != NULL || __ut_report.format == __UT_REPORT_NONE
+        || message == NULL)
+    {
+        return;
+    }
+
+    size_t length = strlen(message);
+    if (length > UT_REPORT_MESSAGE_SIZE - 1)
+    {
+        length = UT_REPORT_MESSAGE_SIZE - 1;
+    }
+
+    pthread_mutex_lock(&__ut_report_mutex);
+    struct __ut_report_chunk *chunk = __ut_report.chunks;
+    if (chunk == NULL || chunk->size - chunk->used < length + 1)
+    {
+        const size_t size = length + 1 > __UT_REPORT_CHUNK_SIZE ? length + 1 : __UT_REPORT_CHUNK_SIZE;
+        chunk = (struct __ut_report_chunk *)malloc(sizeof(struct __ut_report_chunk) + size);
+        if (chunk != NULL)
+        {
+            chunk->next = __ut_report.chunks;
+            chunk->size = size;
+            chunk->used = 0;
+            __ut_report.chunks = chunk;
+        }
+    }
+    if (chunk != NULL)
+    {
+        char *copy = chunk->data + chunk->used;
+        memcpy(copy, message, length);
+        copy[length] = '\0';
+        chunk->used += length + 1;
+        test_state->failure_message = copy;
+    }
+    pthread_mutex_unlock(&__ut_report_mutex);
+}
+
+/*!
+    \brief     Сохранить сообщение о провале теста, выполняемого текущим потоком
+    \details   Вызывается #UT_ASSERT; проверки вне теста (например, в startup-функции) не сохраняются
+    \param[in] message указатель на строку-сообщение
+    \protected
+*/
+static inline void __ut_report_failure(const char *message)
+{
+    __ut_report_record(__ut_report_current, message);
+}
+
+/*!
+    \brief     Записать буфер и данные в файл отчета
+    \details   Буфер и данные записываются одним вызовом \p writev (повторяется
+        только при частичной записи). Ошибка записи отключает отчет
+    \param[in] data указатель на данные; \p NULL - записать только буфер
+    \param[in] size размер данных, байт
+    \protected
+*/
+static void __ut_report_flush(const char *data, size_t size)
+{
+    struct iovec iov[2] = {
+        { __ut_report.buffer, __ut_report.length },
+        { (void *)data, data != NULL ? size : 0 }
+    };
+    struct iovec *pending = iov;
+    int pending_count = 2;
+
+    // Вывод отчета в стандартный вывод не должен опережать вывод обработчиков
+    if (__ut_report.fd == STDOUT_FILENO)
+    {
+        fflush(stdout);
+    }
+
+    while (pending_count > 0 && __ut_report.fd >= 0)
+    {
+        ssize_t written = writev(__ut_report.fd, pending, pending_count);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            __ut_report.format = __UT_REPORT_NONE;
+            break;
+        }
+
+        for (; pending_count > 0 && (size_t)written >= pending->iov_len; ++pending, --pending_count)
+        {
+            written -= (ssize_t)pending->iov_len;
+        }
+        if (pending_count > 0)
+        {
+            pending->iov_base = (char *)pending->iov_base + written;
+            pending->iov_len -= (size_t)written;
+        }
+    }
+
+    __ut_report.length = 0;
+}
+
+/*!
+    \brief     Записать данные в отчет
+    \details   Данные, не помещающиеся в буфер, записываются вместе с ним, без копирования
+    \param[in] data указатель на данные
+    \param[in] size размер данных, байт
+    \protected
+*/
+static void __ut_report_write(const char *data, size_t size)
+{
+    if (size <= sizeof(__ut_report.buffer) - __ut_report.length)
+    {
+        memcpy(__ut_report.buffer + __ut_report.length, data, size);
+        __ut_report.length += size;
+    }
+    else
+    {
+        __ut_report_flush(data, size);
+    }
+}
+
+/*!
+    \brief     Записать строку в отчет
+    \param[in] string указатель на строку
+    \protected
+*/
+static inline void __ut_report_puts(const char *string)
+{
+    __ut_report_write(string, strlen(string));
+}
+
+/*!
+    \brief     Записать в отчет форматированную строку
+    \param[in] format спецификатор формата \p printf
+    \protected
+*/
+static void __ut_report_printf(const char *format, ...) __attribute__((format(printf, 1, 2)));
+static void __ut_report_printf(const char *format, ...)
+{
+    char buf[UT_BUFFER_SIZE];
+    va_list args;
+
+    va_start(args, format);
+    const int length = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+
+    if (length > 0)
+    {
+        __ut_report_write(buf, (size_t)length < sizeof(buf) ? (size_t)length : sizeof(buf) - 1);
+    }
+}
+
+/*!
+    \brief     Записать в отчет экранированную строку
+    \details   Символы, недопустимые в XML 1.0, заменяются на \p '?';
+        в описании теста TAP переводы строк заменяются пробелами
+    \param[in] string   указатель на строку; \p NULL - пустая строка
+    \param[in] escaping способ экранирования, см. #__UT_REPORT_ESCAPE_XML
+    \protected
+*/
+static void __ut_report_escape(const char *string, int escaping)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    for (const unsigned char *c = (const unsigned char *)(string != NULL ? string : ""); *c != '\0'; ++c)
+    {
+        // Самая длинная замена - \uXXXX
+        if (sizeof(__ut_report.buffer) - __ut_report.length < 6)
+        {
+            __ut_report_flush(NULL, 0);
+        }
+        char *out = __ut_report.buffer + __ut_report.length;
+        const char *replacement = NULL;
+
+        switch (escaping)
+        {
+        case __UT_REPORT_ESCAPE_XML:
+            // Пробельные символы заменяем ссылками, иначе они нормализуются в значении атрибута
+            replacement = *c == '&' ? "&amp;" : *c == '<' ? "&lt;" : *c == '>' ? "&gt;"
+                : *c == '"' ? "&quot;" : *c == '\'' ? "&apos;"
+                : *c == '\t' ? "&#9;" : *c == '\n' ? "&#10;" : *c == '\r' ? "&#13;" : *c < 0x20 ? "?" : NULL;
+            break;
+        case __UT_REPORT_ESCAPE_JSON:
+            replacement = *c == '"' ? "\\\"" : *c == '\\' ? "\\\\" : *c == '\n' ? "\\n"
+                : *c == '\r' ? "\\r" : *c == '\t' ? "\\t" : NULL;
+            if (replacement == NULL && *c < 0x20)
+            {
+                memcpy(out, "\\u00", 4);
+                out[4] = hex[*c >> 4];
+                out[5] = hex[*c & 0xF];
+                __ut_report.length += 6;
+                continue;
+            }
+            break;
+        default:
+            replacement = *c == '#' ? "\\#" : *c == '\\' ? "\\\\" : *c == '\n' || *c == '\r' ? " " : NULL;
+            break;
+        }
+
+        if (replacement != NULL)
+        {
+            const size_t length = strlen(replacement);
+            memcpy(out, replacement, length);
+            __ut_report.length += length;
+        }
+        else
+        {
+            *out = (char)*c;
+            ++__ut_report.length;
+        }
+    }
+}
+
+/*!
+    \brief     Добавить строку в таблицу строк двоичного журнала
+    \details   Одинаковые строки (наименования, файлы, сообщения) хранятся однократно
+    \param[in] string указатель на строку; \p NULL - строка отсутствует
+    \return    Смещение строки в таблице; #__UT_LOG_NO_STRING, если строка отсутствует или не добавлена
+    \protected
+*/
+static uint32_t __ut_report_intern(const char *string)
+{
+    if (string == NULL)
+    {
+        return __UT_LOG_NO_STRING;
+    }
+
+    // Поддерживаем заполненность хэш-таблицы не более чем наполовину
+    if (__ut_report.slots_count * 2 >= __ut_report.slots_capacity)
+    {
+        const size_t capacity = __ut_report.slots_capacity != 0 ? __ut_report.slots_capacity * 2 : 1024;
+        uint32_t *slots = (uint32_t *)calloc(capacity, sizeof(uint32_t));
+        if (slots == NULL)
+        {
+            return __UT_LOG_NO_STRING;
+        }
+        for (size_t i = 0; i < __ut_report.slots_capacity; ++i)
+        {
+            const uint32_t slot = __ut_report.slots[i];
+            if (slot != 0)
+            {
+                size_t j = __ut_hash_string(14695981039346656037ull, __ut_report.strings + slot - 1) & (capacity - 1);
+                while (slots[j] != 0)
+                {
+                    j = (j + 1) & (capacity - 1);
+                }
+                slots[j] = slot;
+            }
+        }
+        free(__ut_report.slots);
+        __ut_report.slots = slots;
+        __ut_report.slots_capacity = capacity;
+    }
+
+    // Ищем строку; слот хранит смещение строки, увеличенное на 1 (0 - свободный слот)
+    size_t i = __ut_hash_string(14695981039346656037ull, string) & (__ut_report.slots_capacity - 1);
+    for (; __ut_report.slots[i] != 0; i = (i + 1) & (__ut_report.slots_capacity - 1))
+    {
+        if (strcmp(__ut_report.strings + __ut_report.slots[i] - 1, string) == 0)
+        {
+            return __ut_report.slots[i] - 1;
+        }
+    }
+
+    const size_t size = strlen(string) + 1;
+    if (__ut_report.strings_size + size >= __UT_LOG_NO_STRING)
+    {
+        return __UT_LOG_NO_STRING;
+    }
+    if (__ut_report.strings_size + size > __ut_report.strings_capacity)
+    {
+        const size_t capacity = (__ut_report.strings_size + size) * 2;
+        char *strings = (char *)realloc(__ut_report.strings, capacity);
+        if (strings == NULL)
+        {
+            return __UT_LOG_NO_STRING;
+        }
+        __ut_report.strings = strings;
+        __ut_report.strings_capacity = capacity;
+    }
+
+    const uint32_t offset = (uint32_t)__ut_report.strings_size;
+    memcpy(__ut_report.strings + offset, string, size);
+    __ut_report.strings_size += size;
+    __ut_report.slots[i] = offset + 1;
+    ++__ut_report.slots_count;
+
+    return offset;
+}
+
+/*!
+    \brief     Завершить отчет
+    \details   Регистрируется \p atexit при открытии отчета; в дочерних процессах ничего не делает.
+        Набор тестов, не завершенный к выходу из процесса (см. #__ut_timeout_watchdog), закрывается.
+        Двоичный журнал дополняется таблицей строк и заключительной структурой
+    \protected
+*/
+static void __ut_report_close(void)
+{
+    if (!__ut_report.opened || __ut_report.pid != getpid())
+    {
+        return;
+    }
+
+    switch (__ut_report.format)
+    {
+    case __UT_REPORT_JUNIT:
+        __ut_report_puts(__ut_report.suite_opened ? "  </testsuite>\n</testsuites>\n" : "</testsuites>\n");
+        break;
+    case __UT_REPORT_TAP:
+        __ut_report_printf("1..%u\n", __ut_report.test_number);
+        break;
+    case __UT_REPORT_BINARY:
+    {
+        struct __ut_log_footer footer;
+        memset(&footer, 0, sizeof(footer));
+        footer.record_count = __ut_report.test_number;
+        footer.strings_offset = sizeof(struct __ut_log_header) + footer.record_count * sizeof(struct __ut_log_record);
+        footer.strings_size = __ut_report.strings_size;
+        memcpy(footer.magic, __ut_log_footer_magic, sizeof(footer.magic));
+
+        __ut_report_flush(__ut_report.strings, __ut_report.strings_size);
+        __ut_report_write((const char *)&footer, sizeof(footer));
+
+        free(__ut_report.strings);
+        free(__ut_report.slots);
+        __ut_report.strings = NULL;
+        __ut_report.slots = NULL;
+        __ut_report.strings_size = __ut_report.strings_capacity = 0;
+        __ut_report.slots_count = __ut_report.slots_capacity = 0;
+        break;
+    }
+    }
+    __ut_report_flush(NULL, 0);
+
+    if (__ut_report.fd != STDOUT_FILENO)
+    {
+        close(__ut_report.fd);
+    }
+    __ut_report.opened = false;
+}
+
+/*!
+    \brief     Открыть отчет (однократно)
+    \return    \p true, если отчет формируется; \p false иначе
+    \protected
+*/
+static bool __ut_report_open(void)
+{
+    if (__ut_report.opened || __ut_report.format == __UT_REPORT_NONE)
+    {
+        return __ut_report.opened;
+    }
+
+    __ut_report.fd = *__ut_report.path == '\0'
+        ? STDOUT_FILENO
+        : open(__ut_report.path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (__ut_report.fd < 0)
+    {
+        __ut_report.format = __UT_REPORT_NONE;
+        return false;
+    }
+    __ut_report.opened = true;
+    __ut_report.pid = getpid();
+    __ut_report.test_number = 0;
+    if (!__ut_report.close_registered)
+    {
+        __ut_report.close_registered = true;
+        atexit(__ut_report_close);
+    }
+
+    switch (__ut_report.format)
+    {
+    case __UT_REPORT_JUNIT:
+        __ut_report_puts("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<testsuites>\n");
+        break;
+    case __UT_REPORT_TAP:
+        __ut_report_puts("TAP version 13\n");
+        break;
+    case __UT_REPORT_BINARY:
+    {
+        struct __ut_log_header header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, __ut_log_header_magic, sizeof(header.magic));
+        header.record_size = sizeof(struct __ut_log_record);
+#ifdef UT_ENABLE_RUSAGE
+        header.flags = __UT_LOG_TIMED;
+#endif
+        __ut_report_write((const char *)&header, sizeof(header));
+        break;
+    }
+    }
+
+    return true;
+}
+
+/*!
+    \brief     Начать набор тестов в отчете
+    \param[in] name       указатель на строку, наименование набора тестов
+    \param[in] test_count количество тестов в наборе
+    \protected
+*/
+static void __ut_report_suite_begin(const char *name, unsigned int test_count)
+{
+    if (!__ut_report_open())
+    {
+        return;
+    }
+
+    memset(__ut_report.suite_counts, 0, sizeof(__ut_report.suite_counts));
+    __ut_report.suite_opened = true;
+
+    switch (__ut_report.format)
+    {
+    case __UT_REPORT_JUNIT:
+        __ut_report_puts("  <testsuite name=\"");
+        __ut_report_escape(name, __UT_REPORT_ESCAPE_XML);
+        __ut_report_printf("\" tests=\"%u\">\n", test_count);
+        break;
+    case __UT_REPORT_TAP:
+        __ut_report_puts("# ");
+        __ut_report_escape(name, __UT_REPORT_ESCAPE_TAP);
+        __ut_report_puts("\n");
+        break;
+    }
+}
+
+/*!
+    \brief     Записать запись о тесте в отчет
+    \param[in] entry указатель на запись
+    \protected
+*/
+static void __ut_report_write_entry(const struct __ut_report_entry *entry)
+{
+    if (!__ut_report.opened)
+    {
+        return;
+    }
+
+    const int status = entry->status;
+    const char *message = entry->message;
+    if (message == NULL && status == __UT_LOG_FAILED)
+    {
+        message = "test failed";
+    }
+
+    ++__ut_report.test_number;
+    ++__ut_report.suite_counts[status];
+
+    switch (__ut_report.format)
+    {
+    case __UT_REPORT_JUNIT:
+        __ut_report_puts("    <testcase classname=\"");
+        __ut_report_escape(entry->suite, __UT_REPORT_ESCAPE_XML);
+        __ut_report_puts("\" name=\"");
+        __ut_report_escape(entry->name, __UT_REPORT_ESCAPE_XML);
+        __ut_report_puts("\" file=\"");
+        __ut_report_escape(entry->file, __UT_REPORT_ESCAPE_XML);
+        __ut_report_printf("\" line=\"%u\"", entry->line);
+        if (entry->timed)
+        {
+            __ut_report_printf(" time=\"%llu.%09llu\"", entry->wall_ns / 1000000000ull, entry->wall_ns % 1000000000ull);
+        }
+        if (status == __UT_LOG_PASSED)
+        {
+            __ut_report_puts("/>\n");
+            break;
+        }
+        __ut_report_puts(status == __UT_LOG_FAILED ? ">\n      <failure message=\"" : ">\n      <skipped message=\"");
+        __ut_report_escape(message, __UT_REPORT_ESCAPE_XML);
+        __ut_report_puts("\"/>\n    </testcase>\n");
+        break;
+
+    case __UT_REPORT_TAP:
+        __ut_report_printf("%s %u - ", status == __UT_LOG_FAILED ? "not ok" : "ok", __ut_report.test_number);
+        __ut_report_escape(entry->suite, __UT_REPORT_ESCAPE_TAP);
+        __ut_report_puts(".");
+        __ut_report_escape(entry->name, __UT_REPORT_ESCAPE_TAP);
+        if (status == __UT_LOG_SKIPPED)
+        {
+            __ut_report_puts(" # SKIP ");
+            __ut_report_escape(message, __UT_REPORT_ESCAPE_TAP);
+        }
+        __ut_report_puts("\n");
+        if (status == __UT_LOG_FAILED)
+        {
+            __ut_report_puts("  ---\n  message: \"");
+            __ut_report_escape(message, __UT_REPORT_ESCAPE_JSON);
+            __ut_report_puts("\"\n  at: \"");
+            __ut_report_escape(entry->file, __UT_REPORT_ESCAPE_JSON);
+            __ut_report_printf(":%u\"\n  ...\n", entry->line);
+        }
+        break;
+
+    case __UT_REPORT_JSONL:
+        __ut_report_puts("{\"type\":\"test\",\"suite\":\"");
+        __ut_report_escape(entry->suite, __UT_REPORT_ESCAPE_JSON);
+        __ut_report_puts("\",\"name\":\"");
+        __ut_report_escape(entry->name, __UT_REPORT_ESCAPE_JSON);
+        __ut_report_puts("\",\"file\":\"");
+        __ut_report_escape(entry->file, __UT_REPORT_ESCAPE_JSON);
+        __ut_report_printf("\",\"line\":%u,\"status\":\"%s\"", entry->line, __ut_report_statuses[status]);
+        if (entry->timed)
+        {
+            __ut_report_printf(",\"duration_ns\":%llu", entry->wall_ns);
+        }
+        if (message != NULL)
+        {
+            __ut_report_puts(",\"message\":\"");
+            __ut_report_escape(message, __UT_REPORT_ESCAPE_JSON);
+            __ut_report_puts("\"");
+        }
+        __ut_report_puts("}\n");
+        break;
+
+    case __UT_REPORT_BINARY:
+    {
+        struct __ut_log_record record;
+        memset(&record, 0, sizeof(record));
+        record.suite = __ut_report_intern(entry->suite);
+        record.name = __ut_report_intern(entry->name);
+        record.file = __ut_report_intern(entry->file);
+        record.message = __ut_report_intern(message);
+        record.line = entry->line;
+        record.index = entry->index;
+        record.performed_count = entry->performed_count;
+        record.successed_count = entry->successed_count;
+        record.status = (uint8_t)status;
+        record.wall_ns = entry->wall_ns;
+        record.user_ns = entry->user_ns;
+        record.system_ns = entry->system_ns;
+        __ut_report_write((const char *)&record, sizeof(record));
+        break;
+    }
+    }
+}
+
+/*!
+    \brief     Записать результат теста в отчет
+    \details   Успешный, проваленный или отмененный (см. #UT_ON_SKIPPED_TEST) тест;
+        тесты, не выбранные для выполнения, в отчет не попадают
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \param[in] test_state      указатель на состояние теста; \p NULL - провал startup-функции
+        (записывается как проваленный тест \p startup)
+    \protected
+*/
+static void __ut_report_test(const struct __ut_test_suite_desc *test_suite_desc, const struct __ut_test_state *test_state)
+{
+    if (!__ut_report.opened)
+    {
+        return;
+    }
+
+    struct __ut_report_entry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.suite = test_suite_desc->name;
+    if (test_state == NULL)
+    {
+        entry.name = "startup";
+        entry.file = "";
+        entry.index = __UT_LOG_NO_INDEX;
+        entry.status = __UT_LOG_FAILED;
+        entry.message = "test suite startup failed";
+        __ut_report_write_entry(&entry);
+        return;
+    }
+
+    entry.name = test_state->test->name;
+    entry.file = test_state->test->file;
+    entry.line = (unsigned int)test_state->test->line;
+    entry.index = (unsigned int)(test_state - test_suite_desc->test_states);
+    entry.status = UT_IS_TEST_SKIPPED(test_state) ? __UT_LOG_SKIPPED
+        : UT_IS_TEST_FAILED(test_state) ? __UT_LOG_FAILED : __UT_LOG_PASSED;
+    entry.message = entry.status == __UT_LOG_SKIPPED ? test_state->skip_reason : test_state->failure_message;
+    entry.performed_count = test_state->performed_count;
+    entry.successed_count = test_state->successed_count;
+#ifdef UT_ENABLE_RUSAGE
+    entry.timed = true;
+    entry.wall_ns = test_state->usage.wall_ns;
+    entry.user_ns = test_state->usage.user_ns;
+    entry.system_ns = test_state->usage.system_ns;
+#endif
+    __ut_report_write_entry(&entry);
+}
+
+/*!
+    \brief     Завершить набор тестов в отчете
+    \details   Сбрасывает буфер отчета и освобождает хранилище сообщений:
+        поле \p failure_message состояний тестов набора становится недействительным
+    \param[in] name указатель на строку, наименование набора тестов
+    \protected
+*/
+static void __ut_report_suite_end(const char *name)
+{
+    __ut_report.suite_opened = false;
+    if (__ut_report.opened)
+    {
+        switch (__ut_report.format)
+        {
+        case __UT_REPORT_JUNIT:
+            __ut_report_puts("  </testsuite>\n");
+            break;
+        case __UT_REPORT_JSONL:
+            __ut_report_puts("{\"type\":\"suite\",\"name\":\"");
+            __ut_report_escape(name, __UT_REPORT_ESCAPE_JSON);
+            __ut_report_printf("\",\"passed\":%u,\"failed\":%u,\"skipped\":%u}\n", __ut_report.suite_counts[__UT_LOG_PASSED],
+                __ut_report.suite_counts[__UT_LOG_FAILED], __ut_report.suite_counts[__UT_LOG_SKIPPED]);
+            break;
+        }
+        __ut_report_flush(NULL, 0);
+    }
+
+    while (__ut_report.chunks != NULL)
+    {
+        struct __ut_report_chunk *chunk = __ut_report.chunks;
+        __ut_report.chunks = chunk->next;
+        free(chunk);
+    }
+}
+
+/*!
+    \brief     Открыть двоичный журнал результатов для чтения
+    \details   Файл отображается в память; записи и строки читаются без копирования
+    \param[out] log  указатель на структуру журнала
+    \param[in]  path путь к файлу журнала
+    \return    \p true, если журнал открыт; \p false, если файл недоступен, поврежден
+        или не завершен (например, процесс тестов завершился аварийно)
+*/
+static inline bool __ut_log_open(struct __ut_log *log, const char *path)
+{
+    memset(log, 0, sizeof(*log));
+
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat file_stat;
+    void *data = MAP_FAILED;
+    if (fstat(fd, &file_stat) == 0
+        && (size_t)file_stat.st_size >= sizeof(struct __ut_log_header) + sizeof(struct __ut_log_footer))
+    {
+        data = mmap(NULL, (size_t)file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+
+    const size_t size = (size_t)file_stat.st_size;
+    const struct __ut_log_header *header = (const struct __ut_log_header *)data;
+    const struct __ut_log_footer *footer = (const struct __ut_log_footer *)((const char *)data + size - sizeof(struct __ut_log_footer));
+    const size_t records_size = size - sizeof(struct __ut_log_header) - sizeof(struct __ut_log_footer);
+
+    // Проверяем сигнатуры и согласованность размеров разделов
+    if (memcmp(header->magic, __ut_log_header_magic, sizeof(header->magic)) != 0
+        || memcmp(footer->magic, __ut_log_footer_magic, sizeof(footer->magic)) != 0
+        || header->record_size != sizeof(struct __ut_log_record)
+        || footer->strings_size > records_size
+        || footer->record_count != (records_size - footer->strings_size) / sizeof(struct __ut_log_record)
+        || footer->strings_offset != sizeof(struct __ut_log_header) + footer->record_count * sizeof(struct __ut_log_record)
+        || footer->strings_offset + footer->strings_size + sizeof(struct __ut_log_footer) != size
+        || (footer->strings_size > 0 && ((const char *)data)[footer->strings_offset + footer->strings_size - 1] != '\0'))
+    {
+        munmap(data, size);
+        return false;
+    }
+
+    log->data = data;
+    log->size = size;
+    log->records = (const struct __ut_log_record *)((const char *)data + sizeof(struct __ut_log_header));
+    log->record_count = (size_t)footer->record_count;
+    log->strings = (const char *)data + footer->strings_offset;
+    log->strings_size = (size_t)footer->strings_size;
+    log->timed = (header->flags & __UT_LOG_TIMED) != 0;
+
+    return true;
+}
+
+/*!
+    \brief     Закрыть двоичный журнал результатов
+    \param[in,out] log указатель на структуру журнала
+*/
+static inline void __ut_log_close(struct __ut_log *log)
+{
+    if (log->data != NULL)
+    {
+        munmap(log->data, log->size);
+    }
+    memset(log, 0, sizeof(*log));
+}
+
+/*!
+    \brief     Получить строку двоичного журнала по смещению
+    \param[in] log    указатель на структуру журнала
+    \param[in] offset смещение строки в таблице строк
+    \return    Указатель на строку; \p NULL, если строка отсутствует
+*/
+static inline const char *__ut_log_string(const struct __ut_log *log, uint32_t offset)
+{
+    return offset < log->strings_size ? log->strings + offset : NULL;
+}
+
+/*!
+    \brief     Подвести итоги двоичного журнала результатов
+    \param[in]  log     указатель на структуру журнала
+    \param[out] summary указатель на структуру итогов
+*/
+static inline void __ut_log_summarize(const struct __ut_log *log, struct __ut_log_summary *summary)
+{
+    memset(summary, 0, sizeof(*summary));
+
+    for (size_t i = 0; i < log->record_count; ++i)
+    {
+        const struct __ut_log_record *record = &(log->records[i]);
+
+        summary->test_counts[record->status < 3 ? record->status : __UT_LOG_FAILED]++;
+        summary->performed_count += record->performed_count;
+        summary->successed_count += record->successed_count;
+        summary->wall_ns += record->wall_ns;
+    }
+}
+
+/*!
+    \brief     Преобразовать двоичный журнал результатов в отчет другого формата
+    \details   Записи подряд идущих тестов одного набора образуют набор тестов отчета
+    \param[in] log    указатель на структуру журнала
+    \param[in] format наименование формата отчета (см. #UT_REPORT_FORMAT)
+    \param[in] path   путь к файлу отчета; пустая строка - стандартный вывод
+    \return    \p true, если отчет сформирован; \p false иначе
+    \warning   Не может вызываться, пока формируется отчет о выполнении тестов
+*/
+static inline bool __ut_log_convert(const struct __ut_log *log, const char *format, const char *path)
+{
+    if (__ut_report.opened)
+    {
+        return false;
+    }
+
+    __ut_report_set(format, path);
+    __ut_report.loaded = false;
+    __ut_report_load();
+    const bool opened = __ut_report_open();
+
+    for (size_t i = 0; opened && i < log->record_count; )
+    {
+        // Определяем границы набора тестов
+        const uint32_t suite = log->records[i].suite;
+        size_t end = i + 1;
+        while (end < log->record_count && log->records[end].suite == suite)
+        {
+            ++end;
+        }
+
+        const char *suite_name = __ut_log_string(log, suite);
+        __ut_report_suite_begin(suite_name, (unsigned int)(end - i));
+        for (; i < end; ++i)
+        {
+            const struct __ut_log_record *record = &(log->records[i]);
+
+            struct __ut_report_entry entry;
+            memset(&entry, 0, sizeof(entry));
+            entry.suite = suite_name;
+            entry.name = __ut_log_string(log, record->name);
+            entry.file = __ut_log_string(log, record->file);
+            entry.line = record->line;
+            entry.index = record->index;
+            entry.status = record->status < 3 ? record->status : __UT_LOG_FAILED;
+            entry.message = __ut_log_string(log, record->message);
+            entry.performed_count = record->performed_count;
+            entry.successed_count = record->successed_count;
+            entry.timed = log->timed;
+            entry.wall_ns = record->wall_ns;
+            entry.user_ns = record->user_ns;
+            entry.system_ns = record->system_ns;
+            __ut_report_write_entry(&entry);
+        }
+        __ut_report_suite_end(suite_name);
+    }
+    __ut_report_close();
+
+    // Следующий отчет снова читает параметры из окружения
+    __ut_report.format_name = __ut_report.path = NULL;
+    __ut_report.format = __UT_REPORT_NONE;
+    __ut_report.loaded = false;
+
+    return opened;
+}
+
+/*!
+    \brief     Задать формат и файл отчета
+    \param[in] format наименование формата: \p "junit", \p "tap", \p "jsonl" или \p "binary"
+    \param[in] path   путь к файлу отчета; пустая строка - стандартный вывод
+    \see       __ut_report_set
+*/
+#define UT_SET_REPORT(format, path) __ut_report_set((format), (path))
+
+/*!
+    \brief     Открыть двоичный журнал результатов для чтения
+    \param[out] log  журнал (переменная типа <tt>struct __ut_log</tt>)
+    \param[in]  path путь к файлу журнала
+    \see       __ut_log_open
+*/
+#define UT_LOG_OPEN(log, path) __ut_log_open(&(log), (path))
+
+/*!
+    \brief     Закрыть двоичный журнал результатов
+    \param[in,out] log журнал
+*/
+#define UT_LOG_CLOSE(log) __ut_log_close(&(log))
+
+/*!
+    \brief     Получить строку двоичного журнала по смещению (\p NULL, если строка отсутствует)
+    \param[in] log    журнал
+    \param[in] offset смещение строки (поле записи #__ut_log_record)
+*/
+#define UT_LOG_STRING(log, offset) __ut_log_string(&(log), (offset))
+
+/*!
+    \brief     Подвести итоги двоичного журнала результатов
+    \param[in]  log     журнал
+    \param[out] summary итоги (переменная типа <tt>struct __ut_log_summary</tt>)
+*/
+#define UT_LOG_SUMMARIZE(log, summary) __ut_log_summarize(&(log), &(summary))
+
+/*!
+    \brief     Преобразовать двоичный журнал результатов в отчет другого формата
+    \param[in] log    журнал
+    \param[in] format наименование формата отчета
+    \param[in] path   путь к файлу отчета; пустая строка - стандартный вывод
+    \see       __ut_log_convert
+*/
+#define UT_LOG_CONVERT(log, format, path) __ut_log_convert(&(log), (format), (path))
+
+#endif  // UT_ENABLE_REPORTER
+
+#ifdef UT_ENABLE_ASSERT_EVENTS
+
+#if (UT_ASSERT_RING_SIZE & (UT_ASSERT_RING_SIZE - 1)) != 0
+#error "UT_ASSERT_RING_SIZE must be a power of two"
+#endif
+
+//! Наибольшая длительность ожидания сборщиком проверок новых событий, нс
+#define __UT_ASSERT_IDLE_WAIT_NS 10000000L
+
+/*!
+    \brief     Событие проверки
+    \details   Сообщение копируется, поскольку часто формируется во временном буфере;
+        строковый литерал передается без копирования
+    \protected
+*/
+struct __ut_assert_event
+{
+    struct __ut_test_state *test_state; //!< Указатель на состояние теста, выполнившего проверку
+    bool successed;                     //!< Флаг успешности проверки
+    const char *message;                //!< Сообщение проверки: строковый литерал или копия (\p copy, \p long_message)
+    char *long_message;                 //!< Копия сообщения в куче, если оно длиннее #UT_ASSERT_MESSAGE_SIZE; \p NULL иначе
+    char copy[UT_ASSERT_MESSAGE_SIZE];  //!< Копия сообщения (усеченная до #UT_ASSERT_MESSAGE_SIZE)
+};
+
+/*!
+    \brief     Буфер событий проверок одного потока
+    \details   Кольцевой буфер с одним производителем (потоком, выполняющим проверки)
+        и одним потребителем (сборщиком, см. #__ut_assert_collect). Счетчики
+        производителя и потребителя размещаются в разных строках кэша. Буфер
+        выделяется \p mmap, чтобы не учитываться перехватом распределителя памяти,
+        и после завершения потока переходит к новому потоку
+    \protected
+*/
+struct __ut_assert_ring
+{
+    unsigned long head __attribute__((aligned(UT_CACHE_LINE_SIZE)));   //!< Количество записанных событий (изменяет производитель)
+    unsigned long tail_cache;           //!< Последнее прочитанное производителем значение \p tail
+    unsigned long tail __attribute__((aligned(UT_CACHE_LINE_SIZE)));   //!< Количество учтенных событий (изменяет сборщик)
+    struct __ut_assert_ring *next;      //!< Указатель на следующий буфер списка
+    bool released;                      //!< Флаг завершения потока, владевшего буфером
+    struct __ut_assert_event events[UT_ASSERT_RING_SIZE] __attribute__((aligned(UT_CACHE_LINE_SIZE)));   //!< События
+};
+
+/*!
+    \brief     Сборщик проверок
+    \details   Список буферов только пополняется, поэтому обходится без блокировки.
+        Мьютекс и условная переменная используются только для ожидания сборщиком
+        новых событий; производитель будит сборщик без блокировки. Слабое определение:
+        один сборщик на программу, сколько бы единиц трансляции ни включали заголовок
+    \protected
+*/
+struct __ut_assert_events_state
+{
+    struct __ut_assert_ring *rings;     //!< Список буферов всех потоков
+    pthread_key_t key;                  //!< Ключ освобождения буфера при завершении потока
+    bool initialized;                   //!< Флаг создания ключа и обработчика \p fork
+    bool started;                       //!< Флаг работы сборщика в текущем процессе
+    bool sleeping;                      //!< Флаг ожидания сборщиком новых событий
+};
+__attribute__((weak)) struct __ut_assert_events_state __ut_assert_events;
+
+//! Мьютекс ожидания сборщика
+__attribute__((weak)) pthread_mutex_t __ut_assert_mutex = PTHREAD_MUTEX_INITIALIZER;
+//! Условная переменная пробуждения сборщика
+__attribute__((weak)) pthread_cond_t __ut_assert_cond = PTHREAD_COND_INITIALIZER;
+
+//! Буфер событий проверок текущего потока; \p NULL до первой проверки
+__attribute__((weak)) __thread struct __ut_assert_ring *__ut_assert_ring;
+
+/*!
+    \brief     Проверить, запущен ли сборщик проверок
+    \protected
+*/
+static inline bool __ut_assert_events_active(void)
+{
+    return __atomic_load_n(&__ut_assert_events.started, __ATOMIC_RELAXED);
+}
+
+/*!
+    \brief     Учесть проверку в состоянии теста
+    \details   Вызывает #UT_ON_SUCCESSFUL_ASSERT или #UT_ON_FAILED_ASSERT
+    \param[in,out] test_state указатель на состояние теста
+    \param[in]     successed  флаг успешности проверки
+    \param[in]     message    указатель на строку-сообщение
+    \protected
+*/
+static void __ut_assert_apply(struct __ut_test_state *test_state, bool successed, const char *message)
+{
+    test_state->performed_count++;
+    if (successed)
+    {
+        test_state->successed_count++;
+        __UT_LEAK_CHECK_PAUSED(UT_ON_SUCCESSFUL_ASSERT(test_state, message));
+    }
+    else
+    {
+#ifdef UT_ENABLE_REPORTER
+        __UT_LEAK_CHECK_PAUSED(__ut_report_record(test_state, message));
+#endif
+        __UT_LEAK_CHECK_PAUSED(UT_ON_FAILED_ASSERT(test_state, message));
+    }
+}
+
+/*!
+    \brief     Разбудить сборщик проверок, если он ожидает событий
+    \details   Не блокирует: может вызываться из прерываемого по времени теста.
+        Пропущенное пробуждение задерживает сборщик не более чем на #__UT_ASSERT_IDLE_WAIT_NS
+    \protected
+*/
+static inline void __ut_assert_wake(void)
+{
+    if (__atomic_load_n(&__ut_assert_events.sleeping, __ATOMIC_SEQ_CST)
+        && __atomic_exchange_n(&__ut_assert_events.sleeping, false, __ATOMIC_SEQ_CST))
+    {
+        pthread_cond_signal(&__ut_assert_cond);
+    }
+}
+
+/*!
+    \brief     Освободить буфер завершившегося потока
+    \details   Деструктор ключа #__ut_assert_events; неучтенные события буфера
+        сборщик учтет до его передачи другому потоку
+    \param[in] ring указатель на буфер
+    \protected
+*/
+static void __ut_assert_ring_release(void *ring)
+{
+    __atomic_store_n(&((struct __ut_assert_ring *)ring)->released, true, __ATOMIC_RELEASE);
+}
+
+/*!
+    \brief     Получить буфер событий для текущего потока
+    \details   Забирает буфер завершившегося потока или выделяет новый
+    \return    Указатель на буфер; \p NULL, если выделить память не удалось
+    \protected
+*/
+static struct __ut_assert_ring *__ut_assert_ring_acquire(void)
+{
+    struct __ut_assert_ring *ring = __atomic_load_n(&__ut_assert_events.rings, __ATOMIC_ACQUIRE);
+    for (; ring != NULL; ring = ring->next)
+    {
+        bool released = true;
+        if (__atomic_compare_exchange_n(&ring->released, &released, false, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+        {
+            break;
+        }
+    }
+
+    if (ring == NULL)
+    {
+        void *memory = mmap(NULL, sizeof(struct __ut_assert_ring), PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED)
+        {
+            return NULL;
+        }
+
+        ring = (struct __ut_assert_ring *)memory;
+        ring->next = __atomic_load_n(&__ut_assert_events.rings, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&__ut_assert_events.rings, &ring->next, ring, true,
+            __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+        {
+        }
+    }
+
+    pthread_setspecific(__ut_assert_events.key, ring);
+    __ut_assert_ring = ring;
+
+    return ring;
+}
+
+/*!
+    \brief     Скопировать в кучу сообщение, не помещающееся в событие
+    \details   Память выделяется распределителем glibc напрямую, чтобы не учитываться
+        в выделениях теста
+    \param[in] message указатель на строку-сообщение
+    \return    Указатель на копию; \p NULL, если выделить память не удалось
+    \protected
+*/
+static char *__ut_assert_message_copy(const char *message)
+{
+    const size_t size = strlen(message) + 1;
+#ifdef UT_ENABLE_TIMEOUT
+    __ut_timeout_defer_begin();
+#endif
+#ifdef UT_ENABLE_ALLOC_TRACKING
+    char *copy = (char *)__libc_malloc(size);
+#else
+    char *copy = (char *)malloc(size);
+#endif
+#ifdef UT_ENABLE_TIMEOUT
+    __ut_timeout_defer_end();
+#endif
+
+    return copy != NULL ? (char *)memcpy(copy, message, size) : NULL;
+}
+
+/*!
+    \brief     Освободить копию сообщения (см. #__ut_assert_message_copy)
+    \protected
+*/
+static inline void __ut_assert_message_free(char *copy)
+{
+#ifdef UT_ENABLE_ALLOC_TRACKING
+    __libc_free(copy);
+#else
+    free(copy);
+#endif
+}
+
+/*!
+    \brief     Передать проверку сборщику
+    \details   Вызывается #UT_ASSERT. Записывает событие в буфер текущего потока
+        без блокировок; ждет только при заполненном буфере. Если буфер выделить
+        не удалось, учитывает проверку сразу
+    \param[in] test_state указатель на состояние теста
+    \param[in] successed  флаг успешности проверки
+    \param[in] message    указатель на строку-сообщение
+    \param[in] literal    флаг строкового литерала: такое сообщение не копируется
+    \return    \p successed
+    \protected
+*/
+static inline bool __ut_assert_push(struct __ut_test_state *test_state, bool successed, const char *message,
+    bool literal)
+{
+    struct __ut_assert_ring *ring = __ut_assert_ring;
+    if (__builtin_expect(ring == NULL, 0) && (ring = __ut_assert_ring_acquire()) == NULL)
+    {
+        __ut_assert_apply(test_state, successed, message);
+        return successed;
+    }
+
+    const unsigned long head = ring->head;
+    while (head - ring->tail_cache >= UT_ASSERT_RING_SIZE)
+    {
+        ring->tail_cache = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+        if (head - ring->tail_cache < UT_ASSERT_RING_SIZE)
+        {
+            break;
+        }
+        __ut_assert_wake();
+        sched_yield();
+    }
+
+    struct __ut_assert_event *event = &ring->events[head & (UT_ASSERT_RING_SIZE - 1)];
+    event->test_state = test_state;
+    event->successed = successed;
+    event->message = message;
+    event->long_message = NULL;
+    // Литерал действителен до завершения программы, остальные сообщения копируем
+    if (!literal && message != NULL)
+    {
+        event->message = event->copy;
+        if (memccpy(event->copy, message, '\0', sizeof(event->copy)) == NULL)
+        {
+            // Длинное сообщение копируем в кучу; если не удалось - оно усекается
+            event->long_message = __ut_assert_message_copy(message);
+            event->copy[sizeof(event->copy) - 1] = '\0';
+            if (event->long_message != NULL)
+            {
+                event->message = event->long_message;
+            }
+        }
+    }
+
+    // Публикуем событие; порядок с чтением флага ожидания (см. #__ut_assert_collect) - последовательный
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_SEQ_CST);
+    __ut_assert_wake();
+
+    return successed;
+}
+
+/*!
+    \brief     Проверить, есть ли неучтенные события
+    \protected
+*/
+static bool __ut_assert_pending(void)
+{
+    for (const struct __ut_assert_ring *ring = __atomic_load_n(&__ut_assert_events.rings, __ATOMIC_ACQUIRE);
+        ring != NULL; ring = ring->next)
+    {
+        if (__atomic_load_n(&ring->head, __ATOMIC_SEQ_CST) != __atomic_load_n(&ring->tail, __ATOMIC_RELAXED))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*!
+    \brief     Функция потока-сборщика проверок
+    \details   Учитывает события всех буферов в состояниях тестов и вызывает
+        обработчики проверок; без событий ожидает пробуждения производителем
+    \protected
+*/
+static void *__ut_assert_collect(void *arg)
+{
+    (void)arg;
+
+    for (;;)
+    {
+        bool collected = false;
+        for (struct __ut_assert_ring *ring = __atomic_load_n(&__ut_assert_events.rings, __ATOMIC_ACQUIRE);
+            ring != NULL; ring = ring->next)
+        {
+            const unsigned long head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+            unsigned long tail = ring->tail;
+            if (tail == head)
+            {
+                continue;
+            }
+
+            for (; tail != head; ++tail)
+            {
+                struct __ut_assert_event *event = &ring->events[tail & (UT_ASSERT_RING_SIZE - 1)];
+                __ut_assert_apply(event->test_state, event->successed, event->message);
+                __ut_assert_message_free(event->long_message);
+            }
+            __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+            collected = true;
+        }
+        if (collected)
+        {
+            continue;
+        }
+
+        // Объявляем ожидание и перепроверяем буферы: событие, опубликованное до объявления, не будет пропущено
+        __atomic_store_n(&__ut_assert_events.sleeping, true, __ATOMIC_SEQ_CST);
+        if (!__ut_assert_pending())
+        {
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_nsec += __UT_ASSERT_IDLE_WAIT_NS;
+            if (deadline.tv_nsec >= 1000000000L)
+            {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000L;
+            }
+
+            pthread_mutex_lock(&__ut_assert_mutex);
+            while (__atomic_load_n(&__ut_assert_events.sleeping, __ATOMIC_SEQ_CST)
+                && pthread_cond_timedwait(&__ut_assert_cond, &__ut_assert_mutex, &deadline) == 0)
+            {
+            }
+            pthread_mutex_unlock(&__ut_assert_mutex);
+        }
+        __atomic_store_n(&__ut_assert_events.sleeping, false, __ATOMIC_SEQ_CST);
+    }
+
+    return NULL;
+}
+
+/*!
+    \brief     Дождаться учета всех опубликованных событий
+    \details   Вызывается исполнителем перед чтением счетчиков проверок теста.
+        Проверки потоков, запущенных тестом, учитываются, если потоки завершены
+        (или выполнили проверки) до завершения функции теста
+    \protected
+*/
+static void __ut_assert_flush(void)
+{
+    if (!__atomic_load_n(&__ut_assert_events.started, __ATOMIC_ACQUIRE))
+    {
+        return;
+    }
+
+    for (const struct __ut_assert_ring *ring = __atomic_load_n(&__ut_assert_events.rings, __ATOMIC_ACQUIRE);
+        ring != NULL; ring = ring->next)
+    {
+        const unsigned long head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        while ((long)(head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE)) > 0)
+        {
+            __ut_assert_wake();
+            sched_yield();
+        }
+    }
+}
+
+/*!
+    \brief     Остановить сборщик проверок в дочернем процессе
+    \details   Поток-сборщик не наследуется при \p fork: до перезапуска
+        (см. #__ut_assert_events_start) проверки учитываются сразу
+    \protected
+*/
+static void __ut_assert_fork_child(void)
+{
+    __ut_assert_events.started = false;
+    __ut_assert_events.sleeping = false;
+    pthread_mutex_init(&__ut_assert_mutex, NULL);
+    pthread_cond_init(&__ut_assert_cond, NULL);
+}
+
+/*!
+    \brief     Запустить сборщик проверок
+    \details   Вызывается до запуска тестов (и в дочернем процессе режима изоляции).
+        Поток-сборщик блокирует все сигналы. Если поток запустить не удалось,
+        проверки учитываются сразу
+    \protected
+*/
+static void __ut_assert_events_start(void)
+{
+    if (__ut_assert_events.started)
+    {
+        return;
+    }
+
+    if (!__ut_assert_events.initialized)
+    {
+        if (pthread_key_create(&__ut_assert_events.key, __ut_assert_ring_release) != 0)
+        {
+            return;
+        }
+        pthread_atfork(NULL, NULL, __ut_assert_fork_child);
+        __ut_assert_events.initialized = true;
+    }
+
+    sigset_t all, saved;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &saved);
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, __ut_assert_collect, NULL) == 0)
+    {
+        pthread_detach(thread);
+        __atomic_store_n(&__ut_assert_events.started, true, __ATOMIC_RELEASE);
+    }
+
+    pthread_sigmask(SIG_SETMASK, &saved, NULL);
+}
+
+#endif  // UT_ENABLE_ASSERT_EVENTS
+
+#if defined(UT_ENABLE_FORK) || defined(UT_ENABLE_BASELINE) || defined(UT_ENABLE_LEAK_CHECK) || defined(UT_ENABLE_TIMEOUT) \
+    || defined(UT_ENABLE_PROPERTY) || defined(UT_ENABLE_FUZZ)
+
+/*!
+    \brief     Зафиксировать неуспешную проверку, выполненную исполнителем тестов
+    \details   Используется, когда тест провален не проверкой #UT_ASSERT,
+        а обнаруженным исполнителем событием (например, аварийным завершением, замедлением, утечкой или зависанием).
+        Вызывает #UT_ON_FAILED_ASSERT
+    \param[in] test_state указатель на состояние теста
+    \param[in] message    указатель на строку-сообщение
+    \protected
+*/
+static void __ut_fail_test(struct __ut_test_state *test_state, const char *message)
+{
+    test_state->started = true;
+    test_state->performed_count++;
+#ifdef UT_ENABLE_REPORTER
+    __ut_report_record(test_state, message);
+#endif
+    UT_ON_FAILED_ASSERT(test_state, message);
+}
+
+#endif
+
+#if defined(UT_ENABLE_PROPERTY) || defined(UT_ENABLE_FUZZ)
+
+/*!
+    \brief     Флаг заглушенных проверок
+    \details   Проверки случаев свойства и входов цели фаззинга учитываются
+        во временном состоянии теста без вызова обработчиков. Слабое определение:
+        исполнитель сбрасывает флаг прерванного теста, определенного в другой единице трансляции
+    \protected
+*/
+__attribute__((weak)) __thread bool __ut_assert_muted;
+
+/*!
+    \brief     Получить следующее значение генератора splitmix64
+    \details   Используется для заполнения состояния xoshiro256**
+    \param[in,out] state указатель на состояние генератора
+    \protected
+*/
+static inline uint64_t __ut_splitmix64(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+
+    return z ^ (z >> 31);
+}
+
+/*!
+    \brief     Получить следующее значение генератора xoshiro256**
+    \param[in,out] s состояние генератора
+    \protected
+*/
+static inline uint64_t __ut_xoshiro256ss(uint64_t s[4])
+{
+    const uint64_t result = ((s[1] * 5) << 7 | (s[1] * 5) >> 57) * 9;
+    const uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = s[3] << 45 | s[3] >> 19;
+
+    return result;
+}
+
+/*!
+    \brief     Перезапустить after each- и before each-функции между случаями свойства (входами цели фаззинга)
+    \details   Каждый случай получает свежее окружение; вызовы функций остаются парными,
+        поскольку первую before each- и последнюю after each-функцию вызывает исполнитель
+    \param[in] desc       указатель на состояние теста
+    \param[in] before_each before each-функция набора тестов
+    \param[in] after_each  after each-функция набора тестов
+    \return    \p true, если проверки функций не добавили неуспешных; \p false иначе
+    \protected
+*/
+static bool __ut_refresh_fixtures(struct __ut_test_state *desc, __ut_test_func before_each, __ut_test_func after_each)
+{
+    const unsigned int failed_count = desc->performed_count - desc->successed_count;
+
+    after_each(desc);
+#ifdef UT_ENABLE_ARENA
+    __ut_arena_reset(&__ut_arena);
+#endif
+    before_each(desc);
+#ifdef UT_ENABLE_ASSERT_EVENTS
+    __ut_assert_flush();
+#endif
+
+    return desc->performed_count - desc->successed_count == failed_count;
+}
+
+#endif
+
+#ifdef UT_ENABLE_PROPERTY
+
+/*!
+    \brief     Параметры проверки свойств
+    \details   Слабое определение: параметры командной строки, разобранные в одной
+        единице трансляции, действуют на свойства из других
+    \protected
+*/
+struct __ut_prop_state
+{
+    bool loaded;                       //!< Флаг задания параметров (из окружения или командной строки)
+    unsigned long long seed;           //!< Начальное значение генератора (общее для всех свойств)
+    unsigned int cases;                //!< Количество случаев каждого свойства
+};
+__attribute__((weak)) struct __ut_prop_state __ut_prop_params;
+
+/*!
+    \brief     Массив байтов, порождаемый #UT_GEN_BYTES
+    \details   Память действительна до завершения случая свойства
+*/
+struct __ut_prop_bytes
+{
+    const unsigned char *data;         //!< Указатель на данные
+    size_t size;                       //!< Размер данных, байт
+};
+
+/*!
+    \brief     Состояние проверки свойства
+    \details   Значения генераторов извлекаются из последовательности выборов:
+        при порождении выборы берутся из генератора xoshiro256** и запоминаются,
+        при упрощении - из заданной последовательности (выборы за ее концом равны \p 0).
+        Меньший выбор соответствует более простому значению, поэтому контрпример
+        упрощается уменьшением выборов без знания о генераторах
+    \protected
+*/
+struct __ut_prop
+{
+    uint64_t rng[4];                   //!< Состояние генератора xoshiro256**
+    uint64_t choices[UT_PROPERTY_MAX_CHOICES];  //!< Последовательность выборов случая
+    unsigned int count;                //!< Количество выборов, извлеченных случаем
+    unsigned int limit;                //!< Длина заданной последовательности при упрощении
+    bool replay;                       //!< Флаг извлечения выборов из заданной последовательности
+    size_t bytes_used;                 //!< Количество байтов буфера, занятых массивами случая
+    char *out;                         //!< Указатель на буфер описания контрпримера
+    size_t out_size;                   //!< Размер буфера описания, байт
+    size_t out_used;                   //!< Длина описания, байт
+    unsigned char bytes[UT_PROPERTY_BYTES_SIZE];    //!< Буфер массивов байтов (см. #UT_GEN_BYTES)
+};
+
+/*!
+    \brief     Тип функции случая свойства
+    \details   Извлекает значения генераторов и вызывает тело свойства
+        или (если \p print) дописывает значения в описание контрпримера
+    \protected
+*/
+typedef void (*__ut_prop_case_func)(struct __ut_test_state *desc, struct __ut_prop *prop, bool print);
+
+/*!
+    \brief     Задать начальное значение генератора свойств
+    \param[in] seed начальное значение; \p 0 - выбрать по времени и номеру процесса
+    \protected
+*/
+static void __ut_prop_set_seed(unsigned long long seed)
+{
+    if (seed == 0)
+    {
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        seed = ((unsigned long long)now.tv_sec * 1000000000ull + (unsigned long long)now.tv_nsec) ^ ((unsigned long long)getpid() << 32);
+    }
+
+    __ut_prop_params.loaded = true;
+    __ut_prop_params.seed = seed != 0 ? seed : 1;
+}
+
+/*!
+    \brief     Прочитать параметры проверки свойств из окружения (однократно)
+    \details   Используются переменные \p UT_SEED и \p UT_PROPERTY_CASES;
+        параметр \p --seed=N (см. #__ut_parse_arguments) имеет приоритет
+    \protected
+*/
+static void __ut_prop_load(void)
+{
+    const char *value = getenv("UT_PROPERTY_CASES");
+    char *end;
+    const unsigned long cases = value != NULL && *value != '\0' ? strtoul(value, &end, 10) : 0;
+    __ut_prop_params.cases = value != NULL && *value != '\0' && *end == '\0' && cases > 0 ? (unsigned int)cases : UT_PROPERTY_CASES;
+
+    if (__ut_prop_params.loaded)
+    {
+        return;
+    }
+
+    value = getenv("UT_SEED");
+    const unsigned long long seed = value != NULL && *value != '\0' ? strtoull(value, &end, 0) : 0;
+    __ut_prop_set_seed(value != NULL && *value != '\0' && *end == '\0' ? seed : UT_SEED);
+}
+
+/*!
+    \brief     Извлечь очередной выбор случая
+    \details   Случай, извлекающий более #UT_PROPERTY_MAX_CHOICES выборов, получает \p 0
+    \param[in,out] prop указатель на состояние проверки свойства
+    \return    Выбор
+    \protected
+*/
+static inline uint64_t __ut_prop_choice(struct __ut_prop *prop)
+{
+    if (prop->count >= UT_PROPERTY_MAX_CHOICES)
+    {
+        return 0;
+    }
+
+    if (prop->replay)
+    {
+        const unsigned int index = prop->count++;
+        return index < prop->limit ? prop->choices[index] : 0;
+    }
+
+    return prop->choices[prop->count++] = __ut_xoshiro256ss(prop->rng);
+}
+
+/*!
+    \brief     Отобразить выбор на номер значения из [0, \p span]
+    \details   Умножением, а не остатком от деления: отображение монотонно,
+        поэтому уменьшение выбора упрощает значение
+    \param[in] choice выбор
+    \param[in] span   наибольший номер значения
+    \protected
+*/
+static inline uint64_t __ut_prop_scale(uint64_t choice, uint64_t span)
+{
+    return span == UINT64_MAX ? choice : (uint64_t)(((unsigned __int128)choice * (span + 1)) >> 64);
+}
+
+/*!
+    \brief     Породить целое число
+    \details   Выбор \p 0 соответствует нулю (или ближайшей к нему границе); если диапазон
+        содержит ноль, старший бит выбора задает знак, поэтому числа каждого знака
+        упрощаются к нулю независимо
+    \param[in,out] prop указатель на состояние проверки свойства
+    \param[in]     min  наименьшее значение
+    \param[in]     max  наибольшее значение
+    \protected
+*/
+static inline long long __ut_prop_int(struct __ut_prop *prop, long long min, long long max)
+{
+    const uint64_t choice = __ut_prop_choice(prop);
+    if (min >= max)
+    {
+        return min;
+    }
+
+    if (min >= 0)
+    {
+        return (long long)((uint64_t)min + __ut_prop_scale(choice, (uint64_t)max - (uint64_t)min));
+    }
+    if (max <= 0)
+    {
+        return (long long)((uint64_t)max - __ut_prop_scale(choice, (uint64_t)max - (uint64_t)min));
+    }
+
+    // Старший бит выбора - знак, остальные - модуль
+    const uint64_t magnitude = choice << 1;
+    return (choice >> 63) == 0
+        ? (long long)__ut_prop_scale(magnitude, (uint64_t)max)
+        : (long long)((uint64_t)0 - __ut_prop_scale(magnitude, (uint64_t)0 - (uint64_t)min));
+}
+
+/*!
+    \brief     Породить беззнаковое целое число
+    \details   Выбор \p 0 соответствует наименьшему значению
+    \param[in,out] prop указатель на состояние проверки свойства
+    \param[in]     min  наименьшее значение
+    \param[in]     max  наибольшее значение
+    \protected
+*/
+static inline unsigned long long __ut_prop_uint(struct __ut_prop *prop, unsigned long long min, unsigned long long max)
+{
+    const uint64_t choice = __ut_prop_choice(prop);
+    if (min >= max)
+    {
+        return min;
+    }
+
+    return min + __ut_prop_scale(choice, max - min);
+}
+
+/*!
+    \brief     Породить логическое значение
+    \details   Выбор \p 0 соответствует \p false
+    \param[in,out] prop указатель на состояние проверки свойства
+    \protected
+*/
+static inline bool __ut_prop_bool(struct __ut_prop *prop)
+{
+    return (__ut_prop_choice(prop) >> 63) != 0;
+}
+
+/*!
+    \brief     Породить число с плавающей точкой
+    \details   Равномерно в [\p min, \p max); выбор \p 0 соответствует \p min
+    \param[in,out] prop указатель на состояние проверки свойства
+    \param[in]     min  наименьшее значение
+    \param[in]     max  верхняя граница
+    \protected
+*/
+static inline double __ut_prop_double(struct __ut_prop *prop, double min, double max)
+{
+    return min + (max - min) * ((double)(__ut_prop_choice(prop) >> 11) * 0x1.0p-53);
+}
+
+/*!
+    \brief     Породить массив байтов
+    \details   Размер извлекается первым; каждый выбор дает 8 байтов. Размер
+        ограничен свободным местом буфера случая (#UT_PROPERTY_BYTES_SIZE)
+    \param[in,out] prop     указатель на состояние проверки свойства
+    \param[in]     max_size наибольший размер, байт
+    \protected
+*/
+static inline struct __ut_prop_bytes __ut_prop_bytes(struct __ut_prop *prop, size_t max_size)
+{
+    const size_t available = sizeof(prop->bytes) - prop->bytes_used;
+    size_t size = (size_t)__ut_prop_uint(prop, 0, max_size);
+    if (size > available)
+    {
+        size = available;
+    }
+
+    unsigned char *data = prop->bytes + prop->bytes_used;
+    for (size_t i = 0; i < size; i += sizeof(uint64_t))
+    {
+        const uint64_t choice = __ut_prop_choice(prop);
+        for (size_t j = 0; j < sizeof(uint64_t) && i + j < size; ++j)
+        {
+            data[i + j] = (unsigned char)(choice >> (8 * j));
+        }
+    }
+    prop->bytes_used += size;
+
+    const struct __ut_prop_bytes bytes = { data, size };
+    return bytes;
+}
+
+/*!
+    \brief     Дописать значение в описание контрпримера
+    \param[in,out] prop   указатель на состояние проверки свойства
+    \param[in]     format строка формата (как у \p printf)
+    \protected
+*/
+static void __attribute__((format(printf, 2, 3))) __ut_prop_printf(struct __ut_prop *prop, const char *format, ...)
+{
+    if (prop->out_used >= prop->out_size)
+    {
+        return;
+    }
+
+    va_list arguments;
+    va_start(arguments, format);
+    const int length = vsnprintf(prop->out + prop->out_used, prop->out_size - prop->out_used, format, arguments);
+    va_end(arguments);
+
+    prop->out_used = length < 0 ? prop->out_size : prop->out_used + (size_t)length;
+}
+
+/*!
+    \brief     Дописать значение генератора в описание контрпримера
+    \protected
+*/
+static inline void __ut_prop_print_int(struct __ut_prop *prop, const char *name, long long value)
+{
+    __ut_prop_printf(prop, "; %s = %lld", name, value);
+}
+
+//! \copydoc __ut_prop_print_int
+static inline void __ut_prop_print_uint(struct __ut_prop *prop, const char *name, unsigned long long value)
+{
+    __ut_prop_printf(prop, "; %s = %llu", name, value);
+}
+
+//! \copydoc __ut_prop_print_int
+static inline void __ut_prop_print_bool(struct __ut_prop *prop, const char *name, bool value)
+{
+    __ut_prop_printf(prop, "; %s = %s", name, value ? "true" : "false");
+}
+
+//! \copydoc __ut_prop_print_int
+static inline void __ut_prop_print_double(struct __ut_prop *prop, const char *name, double value)
+{
+    __ut_prop_printf(prop, "; %s = %.17g", name, value);
+}
+
+//! \copydoc __ut_prop_print_int
+static inline void __ut_prop_print_bytes(struct __ut_prop *prop, const char *name, struct __ut_prop_bytes value)
+{
+    __ut_prop_printf(prop, "; %s = [%zu]", name, value.size);
+    for (size_t i = 0; i < value.size && i < 32; ++i)
+    {
+        __ut_prop_printf(prop, " %02x", value.data[i]);
+    }
+    if (value.size > 32)
+    {
+        __ut_prop_printf(prop, " ...");
+    }
+}
+
+/*!
+    \brief     Выполнить случай свойства
+    \details   Проверки случая учитываются во временной копии состояния теста
+        без вызова обработчиков
+    \param[in,out] prop указатель на состояние проверки свойства
+    \param[in]     desc указатель на состояние теста
+    \param[in]     func функция случая
+    \param[out]    copy временное состояние теста (со счетчиками проверок случая)
+    \return    \p true, если проверки случая успешны; \p false иначе
+    \protected
+*/
+static bool __ut_prop_check(struct __ut_prop *prop, const struct __ut_test_state *desc, __ut_prop_case_func func,
+    struct __ut_test_state *copy)
+{
+    *copy = *desc;
+    copy->performed_count = copy->successed_count = 0;
+    prop->count = 0;
+    prop->bytes_used = 0;
+
+    __ut_assert_muted = true;
+    func(copy, prop, false);
+    __ut_assert_muted = false;
+
+    return copy->performed_count == copy->successed_count;
+}
+
+/*!
+    \brief     Проверить свойство
+    \details   Выполняет #UT_PROPERTY_CASES случаев. Выборы первого неуспешного
+        случая упрощаются (обнулением, затем двоичным поиском наименьшего выбора,
+        сохраняющего неуспех), пока это удается, но не более #UT_PROPERTY_SHRINK_LIMIT
+        запусков. Упрощенный контрпример и начальное значение генератора сообщаются
+        неуспешной проверкой, после чего контрпример выполняется повторно с обработчиками.
+        Если все случаи успешны, их проверки учитываются в состоянии теста
+    \param[in,out] desc        указатель на состояние теста
+    \param[in]     func        функция случая
+    \param[in]     before_each before each-функция набора тестов
+    \param[in]     after_each  after each-функция набора тестов
+    \protected
+*/
+static inline void __ut_prop_run(struct __ut_test_state *desc, __ut_prop_case_func func,
+    __ut_test_func before_each, __ut_test_func after_each)
+{
+    struct __ut_prop prop;
+    struct __ut_test_state copy;
+    unsigned long long performed_count = 0, successed_count = 0;
+
+    // Последовательность каждого свойства зависит только от начального значения и наименования
+    uint64_t seed = __ut_prop_params.seed ^ __ut_hash_string(14695981039346656037ull, desc->test->name);
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        prop.rng[i] = __ut_splitmix64(&seed);
+    }
+    prop.replay = false;
+
+    unsigned int index = 0;
+    for (; index < __ut_prop_params.cases; ++index)
+    {
+        if (index > 0 && !__ut_refresh_fixtures(desc, before_each, after_each))
+        {
+            return;
+        }
+        if (!__ut_prop_check(&prop, desc, func, &copy))
+        {
+            break;
+        }
+        performed_count += copy.performed_count;
+        successed_count += copy.successed_count;
+    }
+
+    if (index == __ut_prop_params.cases)
+    {
+        desc->performed_count += (unsigned int)performed_count;
+        desc->successed_count += (unsigned int)successed_count;
+        return;
+    }
+
+    // Упрощаем контрпример
+    uint64_t best[UT_PROPERTY_MAX_CHOICES];
+    unsigned int best_count = prop.count < UT_PROPERTY_MAX_CHOICES ? prop.count : UT_PROPERTY_MAX_CHOICES;
+    memcpy(best, prop.choices, best_count * sizeof(uint64_t));
+    prop.replay = true;
+
+    unsigned int runs = 0, shrinks = 0;
+    for (bool improved = true; improved && runs < UT_PROPERTY_SHRINK_LIMIT; )
+    {
+        improved = false;
+        for (unsigned int i = 0; i < best_count && runs < UT_PROPERTY_SHRINK_LIMIT; ++i)
+        {
+            // Ищем наименьший выбор в [low, high], сохраняющий неуспех; high заведомо неуспешен
+            uint64_t low = 0, high = best[i];
+            while (low < high && runs < UT_PROPERTY_SHRINK_LIMIT)
+            {
+                const uint64_t candidate = high == best[i] && low == 0 ? 0 : low + (high - low) / 2;
+
+                memcpy(prop.choices, best, best_count * sizeof(uint64_t));
+                prop.choices[i] = candidate;
+                prop.limit = best_count;
+                ++runs;
+                if (!__ut_refresh_fixtures(desc, before_each, after_each))
+                {
+                    return;
+                }
+                if (__ut_prop_check(&prop, desc, func, &copy))
+                {
+                    low = candidate + 1;
+                    continue;
+                }
+
+                // Неуспех сохранился: принимаем более простую последовательность
+                best[i] = high = candidate;
+                if (prop.count < best_count)
+                {
+                    best_count = prop.count;
+                }
+                ++shrinks;
+                improved = true;
+            }
+        }
+    }
+
+    // Сообщаем контрпример и начальное значение генератора
+    char buf[UT_BUFFER_SIZE];
+    memcpy(prop.choices, best, best_count * sizeof(uint64_t));
+    prop.limit = best_count;
+    prop.count = 0;
+    prop.bytes_used = 0;
+    prop.out = buf;
+    prop.out_size = sizeof(buf);
+    prop.out_used = (size_t)snprintf(buf, sizeof(buf), "property falsified by case %u of %u, shrunk %u times (UT_SEED=%llu)",
+        index + 1, __ut_prop_params.cases, shrinks, __ut_prop_params.seed);
+    func(desc, &prop, true);
+
+#ifdef UT_ENABLE_ASSERT_EVENTS
+    __ut_assert_flush();
+#endif
+    __ut_fail_test(desc, buf);
+
+    // Повторяем контрпример с обработчиками проверок
+    if (__ut_refresh_fixtures(desc, before_each, after_each))
+    {
+        prop.count = 0;
+        prop.bytes_used = 0;
+        func(desc, &prop, false);
+    }
+}
+
+/*!
+    \brief     Применить макрос к каждому генератору свойства
+    \details   Генератор - кортеж (тип, имя, выражение порождения, выражение описания);
+        поддерживается до 8 генераторов
+    \protected
+*/
+#define __UT_PROP_MAP(macro, separator, ...) \
+    __UT_PROP_CONCAT(__UT_PROP_MAP_, __UT_PROP_NARGS(__VA_ARGS__))(macro, separator, __VA_ARGS__)
+#define __UT_PROP_NARGS(...) __UT_PROP_NARGS_(__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define __UT_PROP_NARGS_(_1, _2, _3, _4, _5, _6, _7, _8, n, ...) n
+#define __UT_PROP_CONCAT(a, b) __UT_PROP_CONCAT_(a, b)
+#define __UT_PROP_CONCAT_(a, b) a##b
+#define __UT_PROP_MAP_1(m, s, x) m x
+#define __UT_PROP_MAP_2(m, s, x, ...) m x s() __UT_PROP_MAP_1(m, s, __VA_ARGS__)
+#define __UT_PROP_MAP_3(m, s, x, ...) m x s() __UT_PROP_MAP_2(m, s, __VA_ARGS__)
+#define __UT_PROP_MAP_4(m, s, x, ...) m x s() __UT_PROP_MAP_3(m, s, __VA_ARGS__)
+#define __UT_PROP_MAP_5(m, s, x, ...) m x s() __UT_PROP_MAP_4(m, s, __VA_ARGS__)
+#define __UT_PROP_MAP_6(m, s, x, ...) m x s() __UT_PROP_MAP_5(m, s, __VA_ARGS__)
+#define __UT_PROP_MAP_7(m, s, x, ...) m x s() __UT_PROP_MAP_6(m, s, __VA_ARGS__)
+#define __UT_PROP_MAP_8(m, s, x, ...) m x s() __UT_PROP_MAP_7(m, s, __VA_ARGS__)
+#define __UT_PROP_COMMA() ,
+#define __UT_PROP_NOTHING()
+#define __UT_PROP_PARAMETER(type, name, generate, print) type name
+#define __UT_PROP_ARGUMENT(type, name, generate, print) name
+#define __UT_PROP_GENERATE(type, name, generate, print) type name = generate;
+#define __UT_PROP_PRINT(type, name, generate, print) print;
+
+/*!
+    \brief     Генератор целого числа \p long \p long из [\p min, \p max]
+    \details   Упрощается к нулю (или ближайшей к нему границе)
+    \param[in] name имя параметра свойства
+    \param[in] min  наименьшее значение
+    \param[in] max  наибольшее значение
+*/
+#define UT_GEN_INT(name, min, max) \
+    (long long, name, __ut_prop_int(__ut_prop, (min), (max)), __ut_prop_print_int(__ut_prop, #name, name))
+
+/*!
+    \brief     Генератор беззнакового целого числа \p unsigned \p long \p long из [\p min, \p max]
+    \details   Упрощается к \p min
+    \param[in] name имя параметра свойства
+    \param[in] min  наименьшее значение
+    \param[in] max  наибольшее значение
+*/
+#define UT_GEN_UINT(name, min, max) \
+    (unsigned long long, name, __ut_prop_uint(__ut_prop, (min), (max)), __ut_prop_print_uint(__ut_prop, #name, name))
+
+/*!
+    \brief     Генератор логического значения
+    \details   Упрощается к \p false
+    \param[in] name имя параметра свойства
+*/
+#define UT_GEN_BOOL(name) \
+    (bool, name, __ut_prop_bool(__ut_prop), __ut_prop_print_bool(__ut_prop, #name, name))
+
+/*!
+    \brief     Генератор числа \p double из [\p min, \p max)
+    \details   Упрощается к \p min
+    \param[in] name имя параметра свойства
+    \param[in] min  наименьшее значение
+    \param[in] max  верхняя граница
+*/
+#define UT_GEN_DOUBLE(name, min, max) \
+    (double, name, __ut_prop_double(__ut_prop, (min), (max)), __ut_prop_print_double(__ut_prop, #name, name))
+
+/*!
+    \brief     Генератор массива байтов (#__ut_prop_bytes) размером не более \p max_size
+    \details   Упрощается к пустому массиву и нулевым байтам
+    \param[in] name     имя параметра свойства
+    \param[in] max_size наибольший размер, байт
+*/
+#define UT_GEN_BYTES(name, max_size) \
+    (struct __ut_prop_bytes, name, __ut_prop_bytes(__ut_prop, (max_size)), __ut_prop_print_bytes(__ut_prop, #name, name))
+
+/*!
+    \brief     Определить свойство - тест, проверяемый на порожденных значениях
+    \details   Тело свойства получает \p desc и параметры, перечисленные генераторами
+        (#UT_GEN_INT, #UT_GEN_UINT, #UT_GEN_BOOL, #UT_GEN_DOUBLE, #UT_GEN_BYTES; до 8),
+        и выполняется для #UT_PROPERTY_CASES случаев (см. #__ut_prop_run).
+        Перед каждым случаем вызываются after each- и before each-функции набора тестов.
+        Свойство добавляется в набор тестов макросом #UT_ADD_TEST
+    \param[in] test_suite набор тестов
+    \param[in] property   свойство
+    \param[in] ...        генераторы
+*/
+#define UT_PROPERTY(test_suite, property, ...)                                                  \
+    static void test_suite##_##property##_property(struct __ut_test_state *desc,                \
+        __UT_PROP_MAP(__UT_PROP_PARAMETER, __UT_PROP_COMMA, __VA_ARGS__));                      \
+                                                                                                \
+    static void test_suite##_##property##_case(struct __ut_test_state *desc,                    \
+        struct __ut_prop *__ut_prop, bool __ut_print)                                           \
+    {                                                                                           \
+        __UT_PROP_MAP(__UT_PROP_GENERATE, __UT_PROP_NOTHING, __VA_ARGS__)                       \
+        if (__ut_print)                                                                         \
+        {                                                                                       \
+            __UT_PROP_MAP(__UT_PROP_PRINT, __UT_PROP_NOTHING, __VA_ARGS__)                      \
+            return;                                                                             \
+        }                                                                                       \
+        test_suite##_##property##_property(desc,                                                \
+            __UT_PROP_MAP(__UT_PROP_ARGUMENT, __UT_PROP_COMMA, __VA_ARGS__));                   \
+    }                                                                                           \
+                                                                                                \
+    void test_suite##_before_each(struct __ut_test_state *desc);                                \
+    void test_suite##_after_each(struct __ut_test_state *desc);                                 \
+                                                                                                \
+    UT_TEST(test_suite, property)                                                               \
+    {                                                                                           \
+        __ut_prop_run(desc, test_suite##_##property##_case,                                     \
+            test_suite##_before_each, test_suite##_after_each);                                 \
+    }                                                                                           \
+                                                                                                \
+    static void test_suite##_##property##_property(struct __ut_test_state *desc,                \
+        __UT_PROP_MAP(__UT_PROP_PARAMETER, __UT_PROP_COMMA, __VA_ARGS__))
+
+#endif  // UT_ENABLE_PROPERTY
+
+#ifdef UT_ENABLE_FUZZ
+
+#if (UT_FUZZ_MAP_SIZE & (UT_FUZZ_MAP_SIZE - 1)) != 0 || UT_FUZZ_MAP_SIZE < 8
+#error "UT_FUZZ_MAP_SIZE must be a power of two"
+#endif
+
+//! Наибольшая длина пути к каталогу корпуса цели, байт
+#define __UT_FUZZ_PATH_SIZE 4096
+//! Наибольшая длина имени файла входа в каталоге корпуса (префикс и 16 шестнадцатеричных цифр), байт
+#define __UT_FUZZ_NAME_SIZE 32
+
+/*!
+    \brief     Запретить инструментирование покрытия функции
+    \details   Обработчики инструментирования не должны вызывать сами себя
+    \protected
+*/
+#if defined(__has_attribute)
+#if __has_attribute(no_sanitize_coverage)
+#define __UT_NO_COVERAGE __attribute__((no_sanitize_coverage))
+#endif
+#endif
+#if !defined(__UT_NO_COVERAGE) && defined(__clang__)
+#define __UT_NO_COVERAGE __attribute__((no_sanitize("coverage")))
+#endif
+#ifndef __UT_NO_COVERAGE
+#define __UT_NO_COVERAGE
+#endif
+
+/*!
+    \brief     Счетчики переходов, выполненных целью фаззинга
+    \details   Заполняются обработчиками инструментирования покрытия: код, проверяемый
+        целью, компилируется с \p -fsanitize-coverage=trace-pc-guard (Clang) или
+        \p -fsanitize-coverage=trace-pc (GCC). Без инструментирования входы мутируют
+        вслепую, и корпус не пополняется. Слабые определения объединяются компоновщиком
+    \protected
+*/
+__attribute__((weak)) uint8_t __ut_fuzz_map[UT_FUZZ_MAP_SIZE];
+//! Номер предыдущего выполненного блока (для переходов \p trace-pc)
+__attribute__((weak)) uintptr_t __ut_fuzz_previous;
+//! Количество пронумерованных меток \p trace-pc-guard
+__attribute__((weak)) uint32_t __ut_fuzz_guards;
+
+/*!
+    \brief     Пронумеровать метки переходов модуля (\p trace-pc-guard)
+    \param[in] start указатель на первую метку
+    \param[in] stop  указатель на конец меток
+    \protected
+*/
+__attribute__((weak)) __UT_NO_COVERAGE void __sanitizer_cov_trace_pc_guard_init(uint32_t *start, uint32_t *stop)
+{
+    if (start == stop || *start != 0)
+    {
+        return;
+    }
+
+    for (uint32_t *guard = start; guard < stop; ++guard)
+    {
+        *guard = ++__ut_fuzz_guards;
+    }
+}
+
+/*!
+    \brief     Учесть выполненный переход (\p trace-pc-guard)
+    \param[in] guard указатель на метку перехода
+    \protected
+*/
+__attribute__((weak)) __UT_NO_COVERAGE void __sanitizer_cov_trace_pc_guard(uint32_t *guard)
+{
+    __ut_fuzz_map[*guard & (UT_FUZZ_MAP_SIZE - 1)]++;
+}
+
+/*!
+    \brief     Учесть выполненный блок (\p trace-pc)
+    \details   GCC сообщает только адреса блоков, поэтому переход определяется парой
+        из предыдущего и текущего блоков
+    \protected
+*/
+__attribute__((weak)) __UT_NO_COVERAGE void __sanitizer_cov_trace_pc(void)
+{
+    const uintptr_t location = (uintptr_t)__builtin_return_address(0);
+    const uintptr_t block = (location ^ (location >> 12)) * 2654435761u;
+
+    __ut_fuzz_map[(block ^ __ut_fuzz_previous) & (UT_FUZZ_MAP_SIZE - 1)]++;
+    __ut_fuzz_previous = block >> 1;
+}
+
+//! Сигналы аварийного завершения, при которых сохраняется вход цели
+static const int __ut_fuzz_signals[] = { SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT };
+
+/*!
+    \brief     Параметры и состояние фаззинга
+    \details   Вход, выполняемый целью, доступен обработчику аварийного завершения.
+        Слабое определение: исполнитель, прервавший цель по времени, и параметры
+        командной строки могут находиться в другой единице трансляции, чем цель
+    \protected
+*/
+struct __ut_fuzz_state
+{
+    bool loaded;                       //!< Флаг задания параметров (из окружения или командной строки)
+    unsigned long runs;                //!< Количество мутированных входов каждой цели
+    const char *corpus;                //!< Каталог корпусов
+    uint64_t rng[4];                   //!< Состояние генератора мутаций
+    char path[__UT_FUZZ_PATH_SIZE];    //!< Каталог корпуса текущей цели
+    size_t path_length;                //!< Длина пути к каталогу корпуса текущей цели
+    const uint8_t * volatile input;    //!< Вход, выполняемый целью; \p NULL вне выполнения
+    volatile size_t input_size;        //!< Размер входа, байт
+    const char * volatile input_path;  //!< Путь к файлу входа из корпуса; \p NULL, если вход мутирован
+    struct sigaction saved[sizeof(__ut_fuzz_signals) / sizeof(__ut_fuzz_signals[0])];    //!< Прежние обработчики сигналов
+};
+__attribute__((weak)) struct __ut_fuzz_state __ut_fuzz;
+
+#ifdef UT_ENABLE_PARALLEL
+//! Блокировка: карта покрытия и обработчики сигналов общие, цели выполняются по одной
+__attribute__((weak)) pthread_mutex_t __ut_fuzz_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+//! Флаг выполнения цели фаззинга потоком
+__attribute__((weak)) __thread bool __ut_fuzz_running;
+
+/*!
+    \brief     Вход корпуса цели
+    \protected
+*/
+struct __ut_fuzz_input
+{
+    const uint8_t *data;               //!< Указатель на данные
+    size_t size;                       //!< Размер данных, байт
+    size_t mapped_size;                //!< Размер отображения файла; \p 0, если данные выделены \p malloc
+    char *path;                        //!< Путь к файлу входа
+};
+
+/*!
+    \brief     Корпус цели
+    \protected
+*/
+struct __ut_fuzz_corpus
+{
+    struct __ut_fuzz_input *inputs;    //!< Массив входов
+    size_t count;                      //!< Количество входов
+    size_t capacity;                   //!< Емкость массива входов
+};
+
+/*!
+    \brief     Тип функции цели фаззинга
+    \protected
+*/
+typedef void (*__ut_fuzz_func)(struct __ut_test_state *desc, const uint8_t *data, size_t size);
+
+/*!
+    \brief     Задать количество мутированных входов каждой цели
+    \param[in] runs количество входов; \p 0 - только повтор корпуса
+    \protected
+*/
+static void __ut_fuzz_set_runs(unsigned long runs)
+{
+    __ut_fuzz.loaded = true;
+    __ut_fuzz.runs = runs;
+}
+
+/*!
+    \brief     Прочитать параметры фаззинга из окружения
+    \details   Используются переменные \p UT_FUZZ_RUNS и \p UT_FUZZ_CORPUS;
+        параметр \p --fuzz=N (см. #__ut_parse_arguments) имеет приоритет.
+        Генератор мутаций инициализируется временем и номером процесса:
+        найденные входы воспроизводятся по файлам, а не по начальному значению
+    \protected
+*/
+static void __ut_fuzz_load(void)
+{
+    const char *value = getenv("UT_FUZZ_CORPUS");
+    __ut_fuzz.corpus = value != NULL && *value != '\0' ? value : UT_FUZZ_CORPUS;
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    uint64_t seed = ((uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec) ^ ((uint64_t)getpid() << 32);
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        __ut_fuzz.rng[i] = __ut_splitmix64(&seed);
+    }
+
+    if (__ut_fuzz.loaded)
+    {
+        return;
+    }
+
+    value = getenv("UT_FUZZ_RUNS");
+    char *end;
+    const unsigned long runs = value != NULL && *value != '\0' ? strtoul(value, &end, 10) : 0;
+    __ut_fuzz_set_runs(value != NULL && *value != '\0' && *end == '\0' ? runs : UT_FUZZ_RUNS);
+}
+
+/*!
+    \brief     Получить псевдослучайное число из [0, \p bound)
+    \param[in] bound верхняя граница; больше \p 0
+    \protected
+*/
+static inline size_t __ut_fuzz_random(size_t bound)
+{
+    return (size_t)(__ut_xoshiro256ss(__ut_fuzz.rng) % bound);
+}
+
+/*!
+    \brief     Вычислить 64-битный хэш FNV-1a данных
+    \details   Безопасна для вызова из обработчика сигнала
+    \protected
+*/
+static uint64_t __ut_fuzz_hash(const uint8_t *data, size_t size)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash = (hash ^ data[i]) * 1099511628211ull;
+    }
+
+    return hash;
+}
+
+/*!
+    \brief     Сформировать путь к файлу входа в каталоге корпуса текущей цели
+    \details   Имя файла - префикс и хэш содержимого. Безопасна для вызова из обработчика сигнала
+    \param[out] path   буфер размером не менее #__UT_FUZZ_PATH_SIZE + #__UT_FUZZ_NAME_SIZE байтов
+    \param[in]  prefix префикс имени (короче 16 символов)
+    \param[in]  hash   хэш содержимого
+    \protected
+*/
+static void __ut_fuzz_file_path(char *path, const char *prefix, uint64_t hash)
+{
+    memcpy(path, __ut_fuzz.path, __ut_fuzz.path_length);
+    char *end = path + __ut_fuzz.path_length;
+    *end++ = '/';
+    while (*prefix != '\0')
+    {
+        *end++ = *prefix++;
+    }
+    for (int shift = 60; shift >= 0; shift -= 4)
+    {
+        *end++ = "0123456789abcdef"[(hash >> shift) & 0xF];
+    }
+    *end = '\0';
+}
+
+/*!
+    \brief     Записать вход в новый файл
+    \details   Каталоги корпуса создаются при первой записи, поэтому повтор корпуса
+        их не создает. Существующий файл не перезаписывается. Безопасна для вызова
+        из обработчика сигнала
+    \param[in] path путь к файлу
+    \param[in] data указатель на данные
+    \param[in] size размер данных, байт
+    \return    \p true, если файл записан или уже существует; \p false иначе
+    \protected
+*/
+static bool __ut_fuzz_write(const char *path, const uint8_t *data, size_t size)
+{
+    mkdir(__ut_fuzz.corpus, 0777);
+    mkdir(__ut_fuzz.path, 0777);
+
+    const int fd = open(path, O_WRONLY | O_CREAT | O_EXCL, 0644);
+    if (fd < 0)
+    {
+        return errno == EEXIST;
+    }
+
+    bool written = true;
+    while (size > 0)
+    {
+        const ssize_t count = write(fd, data, size);
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (count <= 0)
+        {
+            written = false;
+            break;
+        }
+        data += count;
+        size -= (size_t)count;
+    }
+    close(fd);
+
+    return written;
+}
+
+/*!
+    \brief     Обработчик аварийного завершения цели
+    \details   Сохраняет мутированный вход в файл \p crash-<хэш> в каталоге корпуса
+        цели, сообщает путь к нему в \p stderr и завершает процесс прежним
+        обработчиком сигнала (или действием по умолчанию)
+    \param[in] signal номер сигнала
+    \protected
+*/
+static void __ut_fuzz_crash_handler(int signal)
+{
+    const uint8_t *input = __ut_fuzz.input;
+    if (input != NULL)
+    {
+        char path[__UT_FUZZ_PATH_SIZE + __UT_FUZZ_NAME_SIZE];
+        const char *reproducer = __ut_fuzz.input_path;
+        if (reproducer == NULL)
+        {
+            __ut_fuzz_file_path(path, "crash-", __ut_fuzz_hash(input, __ut_fuzz.input_size));
+            __ut_fuzz_write(path, input, __ut_fuzz.input_size);
+            reproducer = path;
+        }
+
+        static const char message[] = "fuzz target crashed; reproducer: ";
+        ssize_t written = write(STDERR_FILENO, message, sizeof(message) - 1);
+        written = write(STDERR_FILENO, reproducer, strlen(reproducer));
+        written = write(STDERR_FILENO, "\n", 1);
+        (void)written;
+    }
+
+    for (size_t i = 0; i < sizeof(__ut_fuzz_signals) / sizeof(__ut_fuzz_signals[0]); ++i)
+    {
+        if (__ut_fuzz_signals[i] == signal)
+        {
+            sigaction(signal, &__ut_fuzz.saved[i], NULL);
+        }
+    }
+    raise(signal);
+}
+
+/*!
+    \brief     Установить (или снять) обработчик аварийного завершения цели
+    \details   Обработчик выполняется на отдельном стеке, чтобы сохранить вход
+        и при переполнении стека целью
+    \param[in] enable \p true - установить; \p false - восстановить прежние обработчики
+    \protected
+*/
+static void __ut_fuzz_catch(bool enable)
+{
+    static __thread void *stack;
+
+    if (enable && stack == NULL)
+    {
+        stack_t current;
+        if (sigaltstack(NULL, &current) == 0 && (current.ss_flags & SS_DISABLE) != 0)
+        {
+            const size_t size = 64 * 1024;
+            void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (memory != MAP_FAILED)
+            {
+                stack_t alternate;
+                alternate.ss_sp = memory;
+                alternate.ss_size = size;
+                alternate.ss_flags = 0;
+                sigaltstack(&alternate, NULL);
+                stack = memory;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < sizeof(__ut_fuzz_signals) / sizeof(__ut_fuzz_signals[0]); ++i)
+    {
+        if (enable)
+        {
+            struct sigaction action;
+            memset(&action, 0, sizeof(action));
+            action.sa_handler = __ut_fuzz_crash_handler;
+            action.sa_flags = SA_ONSTACK;
+            sigemptyset(&action.sa_mask);
+            sigaction(__ut_fuzz_signals[i], &action, &__ut_fuzz.saved[i]);
+        }
+        else
+        {
+            sigaction(__ut_fuzz_signals[i], &__ut_fuzz.saved[i], NULL);
+        }
+    }
+}
+
+/*!
+    \brief     Добавить вход в корпус
+    \param[in,out] corpus      указатель на корпус
+    \param[in]     data        указатель на данные (корпус становится их владельцем)
+    \param[in]     size        размер данных, байт
+    \param[in]     mapped_size размер отображения файла; \p 0, если данные выделены \p malloc
+    \param[in]     path        путь к файлу входа (копируется)
+    \return    \p true, если вход добавлен; \p false иначе
+    \protected
+*/
+static bool __ut_fuzz_add(struct __ut_fuzz_corpus *corpus, const uint8_t *data, size_t size, size_t mapped_size,
+    const char *path)
+{
+    if (corpus->count == corpus->capacity)
+    {
+        const size_t capacity = corpus->capacity > 0 ? corpus->capacity * 2 : 64;
+        struct __ut_fuzz_input *inputs = (struct __ut_fuzz_input *)realloc(corpus->inputs, capacity * sizeof(struct __ut_fuzz_input));
+        if (inputs == NULL)
+        {
+            return false;
+        }
+        corpus->inputs = inputs;
+        corpus->capacity = capacity;
+    }
+
+    struct __ut_fuzz_input *input = &corpus->inputs[corpus->count++];
+    input->data = data;
+    input->size = size;
+    input->mapped_size = mapped_size;
+    input->path = strdup(path);
+
+    return true;
+}
+
+/*!
+    \brief     Сравнить входы по пути к файлу (для \p qsort)
+    \protected
+*/
+static int __ut_fuzz_compare(const void *a, const void *b)
+{
+    const char *x = ((const struct __ut_fuzz_input *)a)->path, *y = ((const struct __ut_fuzz_input *)b)->path;
+
+    return strcmp(x != NULL ? x : "", y != NULL ? y : "");
+}
+
+/*!
+    \brief     Загрузить корпус текущей цели
+    \details   Файлы каталога корпуса отображаются в память только для чтения;
+        входы длиннее #UT_FUZZ_MAX_LEN усекаются. Входы упорядочиваются по имени файла
+    \param[out] corpus указатель на пустой корпус
+    \protected
+*/
+static void __ut_fuzz_load_corpus(struct __ut_fuzz_corpus *corpus)
+{
+    DIR *dir = opendir(__ut_fuzz.path);
+    if (dir == NULL)
+    {
+        return;
+    }
+
+    for (const struct dirent *entry; (entry = readdir(dir)) != NULL; )
+    {
+        char path[__UT_FUZZ_PATH_SIZE + 256];
+        if (entry->d_name[0] == '.'
+            || snprintf(path, sizeof(path), "%s/%s", __ut_fuzz.path, entry->d_name) >= (int)sizeof(path))
+        {
+            continue;
+        }
+
+        const int fd = open(path, O_RDONLY);
+        if (fd < 0)
+        {
+            continue;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
+        {
+            const size_t mapped_size = (size_t)st.st_size;
+            void *data = mapped_size > 0 ? mmap(NULL, mapped_size, PROT_READ, MAP_PRIVATE, fd, 0) : NULL;
+            if (data != MAP_FAILED
+                && !__ut_fuzz_add(corpus, (const uint8_t *)data, mapped_size < UT_FUZZ_MAX_LEN ? mapped_size : UT_FUZZ_MAX_LEN,
+                    mapped_size, path)
+                && data != NULL)
+            {
+                munmap(data, mapped_size);
+            }
+        }
+        close(fd);
+    }
+    closedir(dir);
+
+    if (corpus->count > 1)
+    {
+        qsort(corpus->inputs, corpus->count, sizeof(struct __ut_fuzz_input), __ut_fuzz_compare);
+    }
+}
+
+/*!
+    \brief     Освободить корпус
+    \protected
+*/
+static void __ut_fuzz_free_corpus(struct __ut_fuzz_corpus *corpus)
+{
+    for (size_t i = 0; i < corpus->count; ++i)
+    {
+        const struct __ut_fuzz_input *input = &corpus->inputs[i];
+        if (input->mapped_size > 0)
+        {
+            munmap((void *)input->data, input->mapped_size);
+        }
+        else
+        {
+            free((void *)input->data);
+        }
+        free(input->path);
+    }
+    free(corpus->inputs);
+}
+
+/*!
+    \brief     Мутировать вход
+    \details   Применяет подряд от 1 до #UT_FUZZ_MAX_MUTATIONS мутаций: инверсию бита,
+        замену байта, прибавление небольшого числа, запись «интересного» значения,
+        вставку и удаление байтов, копирование части входа и вставку части другого входа корпуса
+    \param[in,out] data     указатель на вход (буфер размером \p max_size)
+    \param[in]     size     размер входа, байт
+    \param[in]     max_size наибольший размер входа, байт
+    \param[in]     other    указатель на другой вход корпуса; \p NULL - нет
+    \return    Новый размер входа, байт
+    \protected
+*/
+static size_t __ut_fuzz_mutate(uint8_t *data, size_t size, size_t max_size, const struct __ut_fuzz_input *other)
+{
+    static const uint32_t interesting[] = {
+        0, 1, 0x10, 0x20, 0x40, 0x64, 0x7F, 0x80, 0xFF, 0x100, 0x200, 0x3E8, 0x400, 0x1000,
+        0x7FFF, 0x8000, 0xFFFF, 0x10000, 0x7FFFFFFF, 0x80000000, 0xFFFFFFFF
+    };
+
+    for (size_t n = 1 + __ut_fuzz_random(UT_FUZZ_MAX_MUTATIONS); n > 0; --n)
+    {
+        switch (__ut_fuzz_random(8))
+        {
+        case 0:
+            // Инвертируем бит
+            if (size > 0)
+            {
+                data[__ut_fuzz_random(size)] ^= (uint8_t)(1u << __ut_fuzz_random(8));
+            }
+            break;
+        case 1:
+            // Заменяем байт
+            if (size > 0)
+            {
+                data[__ut_fuzz_random(size)] = (uint8_t)__ut_fuzz_random(256);
+            }
+            break;
+        case 2:
+            // Прибавляем (или вычитаем) небольшое число
+            if (size > 0)
+            {
+                const size_t position = __ut_fuzz_random(size);
+                data[position] = (uint8_t)(data[position] + 1 + __ut_fuzz_random(16) * (__ut_fuzz_random(2) ? 1 : 255));
+            }
+            break;
+        case 3:
+        {
+            // Записываем «интересное» значение шириной 1, 2 или 4 байта в случайном порядке байтов
+            const size_t width = (size_t)1 << __ut_fuzz_random(3);
+            if (size >= width)
+            {
+                const uint32_t value = interesting[__ut_fuzz_random(sizeof(interesting) / sizeof(interesting[0]))];
+                const size_t position = __ut_fuzz_random(size - width + 1);
+                const bool big_endian = __ut_fuzz_random(2) != 0;
+                for (size_t i = 0; i < width; ++i)
+                {
+                    data[position + i] = (uint8_t)(value >> (8 * (big_endian ? width - 1 - i : i)));
+                }
+            }
+            break;
+        }
+        case 4:
+            // Вставляем байты (случайные или повторяющийся байт)
+            if (size < max_size)
+            {
+                const size_t count = 1 + __ut_fuzz_random(max_size - size < 8 ? max_size - size : 8);
+                const size_t position = __ut_fuzz_random(size + 1);
+                const int repeated = __ut_fuzz_random(2) ? (int)__ut_fuzz_random(256) : -1;
+                memmove(data + position + count, data + position, size - position);
+                for (size_t i = 0; i < count; ++i)
+                {
+                    data[position + i] = (uint8_t)(repeated >= 0 ? repeated : (int)__ut_fuzz_random(256));
+                }
+                size += count;
+            }
+            break;
+        case 5:
+            // Удаляем байты
+            if (size > 0)
+            {
+                const size_t count = 1 + __ut_fuzz_random(size < 8 ? size : 8);
+                const size_t position = __ut_fuzz_random(size - count + 1);
+                memmove(data + position, data + position + count, size - position - count);
+                size -= count;
+            }
+            break;
+        case 6:
+            // Копируем часть входа на другое место
+            if (size > 1)
+            {
+                const size_t count = 1 + __ut_fuzz_random(size - 1);
+                memmove(data + __ut_fuzz_random(size - count + 1), data + __ut_fuzz_random(size - count + 1), count);
+            }
+            break;
+        default:
+            // Вставляем часть другого входа вместо части этого
+            if (other != NULL && other->size > 0)
+            {
+                const size_t count = 1 + __ut_fuzz_random(other->size < max_size ? other->size : max_size);
+                const size_t source = __ut_fuzz_random(other->size - count + 1);
+                const size_t position = __ut_fuzz_random(size + 1);
+                const size_t tail = size - position;
+                const size_t kept = position + count + tail > max_size ? max_size - position - count : tail;
+                memmove(data + position + count, data + position, kept);
+                memcpy(data + position, other->data + source, count);
+                size = position + count + kept;
+            }
+            break;
+        }
+    }
+
+    return size;
+}
+
+/*!
+    \brief     Выполнить цель на входе
+    \details   Цель получает копию входа точного размера (выход за границу обнаруживают
+        санитайзеры). Проверки учитываются во временной копии состояния теста без вызова
+        обработчиков; счетчики покрытия перед выполнением обнуляются
+    \param[in]  desc указатель на состояние теста
+    \param[in]  func функция цели
+    \param[in]  data указатель на вход
+    \param[in]  size размер входа, байт
+    \param[in]  path путь к файлу входа из корпуса; \p NULL, если вход мутирован
+    \param[out] copy временное состояние теста (со счетчиками проверок входа)
+    \return    \p true, если проверки успешны; \p false иначе
+    \protected
+*/
+static bool __ut_fuzz_check(const struct __ut_test_state *desc, __ut_fuzz_func func, const uint8_t *data, size_t size,
+    const char *path, struct __ut_test_state *copy)
+{
+    uint8_t *input = (uint8_t *)malloc(size > 0 ? size : 1);
+    if (input == NULL)
+    {
+        return true;
+    }
+    if (size > 0)
+    {
+        memcpy(input, data, size);
+    }
+
+    *copy = *desc;
+    copy->performed_count = copy->successed_count = 0;
+    memset(__ut_fuzz_map, 0, sizeof(__ut_fuzz_map));
+    __ut_fuzz_previous = 0;
+
+    __ut_fuzz.input_size = size;
+    __ut_fuzz.input_path = path;
+    __ut_fuzz.input = input;
+    __ut_assert_muted = true;
+    func(copy, input, size);
+    __ut_assert_muted = false;
+    __ut_fuzz.input = NULL;
+
+    free(input);
+
+    return copy->performed_count == copy->successed_count;
+}
+
+/*!
+    \brief     Учесть покрытие выполненного входа
+    \details   Количества выполнений переходов округляются до групп (1, 2, 3, 4-7,
+        8-15, 16-31, 32-127, 128+); новой считается ранее не встречавшаяся группа перехода
+    \param[in,out] seen встречавшиеся группы переходов (по битам)
+    \return    \p true, если вход дал новое покрытие; \p false иначе
+    \protected
+*/
+static bool __ut_fuzz_update(uint8_t *seen)
+{
+    bool found = false;
+
+    for (size_t i = 0; i < UT_FUZZ_MAP_SIZE; i += sizeof(uint64_t))
+    {
+        uint64_t word;
+        memcpy(&word, &__ut_fuzz_map[i], sizeof(word));
+        if (word == 0)
+        {
+            continue;
+        }
+
+        for (size_t j = i; j < i + sizeof(uint64_t); ++j)
+        {
+            const uint8_t count = __ut_fuzz_map[j];
+            const uint8_t bucket = count >= 128 ? 128 : count >= 32 ? 64 : count >= 16 ? 32 : count >= 8 ? 16
+                : count >= 4 ? 8 : count == 3 ? 4 : count;
+            if ((bucket & ~seen[j]) != 0)
+            {
+                seen[j] |= bucket;
+                found = true;
+            }
+        }
+    }
+
+    return found;
+}
+
+/*!
+    \brief     Выполнить цель фаззинга
+    \details   Выполняет цель на пустом входе и входах корпуса (каталог
+        <#UT_FUZZ_CORPUS>/<набор тестов>.<цель>), затем на #UT_FUZZ_RUNS мутированных
+        входах. Вход, давший новое покрытие, сохраняется в корпусе. Вход, на котором
+        проверка цели неуспешна, сохраняется в файле \p failure-<хэш>, при аварийном
+        завершении - в файле \p crash-<хэш> (в каталоге корпуса, поэтому найденная
+        ошибка повторяется следующими запусками). Неуспех сообщается проверкой
+        с путем к файлу, после чего вход выполняется повторно с обработчиками.
+        Если все входы успешны, в состоянии теста учитываются проверки входов корпуса
+    \param[in,out] desc            указатель на состояние теста
+    \param[in]     test_suite_name наименование набора тестов
+    \param[in]     func            функция цели
+    \param[in]     before_each     before each-функция набора тестов
+    \param[in]     after_each      after each-функция набора тестов
+    \protected
+*/
+static inline void __ut_fuzz_run(struct __ut_test_state *desc, const char *test_suite_name, __ut_fuzz_func func,
+    __ut_test_func before_each, __ut_test_func after_each)
+{
+#ifdef UT_ENABLE_PARALLEL
+    pthread_mutex_lock(&__ut_fuzz_mutex);
+#endif
+    __ut_fuzz_running = true;
+
+    const int length = snprintf(__ut_fuzz.path, sizeof(__ut_fuzz.path), "%s/%s.%s",
+        __ut_fuzz.corpus, test_suite_name, desc->test->name);
+    if (length < 0 || (size_t)length >= sizeof(__ut_fuzz.path))
+    {
+        __ut_fail_test(desc, "fuzz corpus path is too long");
+        __ut_fuzz_running = false;
+#ifdef UT_ENABLE_PARALLEL
+        pthread_mutex_unlock(&__ut_fuzz_mutex);
+#endif
+        return;
+    }
+    __ut_fuzz.path_length = (size_t)length;
+
+    struct __ut_fuzz_corpus corpus = { NULL, 0, 0 };
+    __ut_fuzz_load_corpus(&corpus);
+    uint8_t *seen = (uint8_t *)calloc(UT_FUZZ_MAP_SIZE, 1);
+    uint8_t *buffer = (uint8_t *)malloc(UT_FUZZ_MAX_LEN);
+
+    struct __ut_test_state copy;
+    unsigned int performed_count = 0, successed_count = 0;
+    char path[__UT_FUZZ_PATH_SIZE + __UT_FUZZ_NAME_SIZE];
+    char buf[UT_BUFFER_SIZE + sizeof(path)] = "";
+    const uint8_t *found = NULL;
+    size_t found_size = 0;
+    bool stopped = seen == NULL || buffer == NULL;
+
+    __ut_fuzz_catch(true);
+
+    // Повторяем пустой вход и входы корпуса
+    for (size_t i = 0; !stopped && i <= corpus.count; ++i)
+    {
+        const struct __ut_fuzz_input *input = i > 0 ? &corpus.inputs[i - 1] : NULL;
+        const uint8_t *data = input != NULL ? input->data : NULL;
+        const size_t size = input != NULL ? input->size : 0;
+
+        if (i > 0 && !__ut_refresh_fixtures(desc, before_each, after_each))
+        {
+            stopped = true;
+            break;
+        }
+        if (!__ut_fuzz_check(desc, func, data, size, input != NULL ? input->path : NULL, &copy))
+        {
+            snprintf(buf, sizeof(buf), "fuzz target failed on corpus input %s",
+                input != NULL && input->path != NULL ? input->path : "(empty)");
+            found = data;
+            found_size = size;
+            break;
+        }
+        performed_count += copy.performed_count;
+        successed_count += copy.successed_count;
+        __ut_fuzz_update(seen);
+    }
+
+    // Мутируем входы корпуса
+    for (unsigned long run = 0; !stopped && found == NULL && run < __ut_fuzz.runs; ++run)
+    {
+        const struct __ut_fuzz_input *base = corpus.count > 0 ? &corpus.inputs[__ut_fuzz_random(corpus.count)] : NULL;
+        const struct __ut_fuzz_input *other = corpus.count > 0 ? &corpus.inputs[__ut_fuzz_random(corpus.count)] : NULL;
+        size_t size = base != NULL ? base->size : 0;
+        if (size > 0)
+        {
+            memcpy(buffer, base->data, size);
+        }
+        size = __ut_fuzz_mutate(buffer, size, UT_FUZZ_MAX_LEN, other);
+
+        if (!__ut_refresh_fixtures(desc, before_each, after_each))
+        {
+            stopped = true;
+            break;
+        }
+        if (!__ut_fuzz_check(desc, func, buffer, size, NULL, &copy))
+        {
+            __ut_fuzz_file_path(path, "failure-", __ut_fuzz_hash(buffer, size));
+            __ut_fuzz_write(path, buffer, size);
+            snprintf(buf, sizeof(buf), "fuzz target failed after %lu runs; reproducer: %s", run + 1, path);
+            found = buffer;
+            found_size = size;
+            break;
+        }
+
+        // Вход с новым покрытием сохраняем в корпусе
+        uint8_t *data;
+        if (__ut_fuzz_update(seen) && (data = (uint8_t *)malloc(size > 0 ? size : 1)) != NULL)
+        {
+            memcpy(data, buffer, size);
+            __ut_fuzz_file_path(path, "", __ut_fuzz_hash(data, size));
+            __ut_fuzz_write(path, data, size);
+            if (!__ut_fuzz_add(&corpus, data, size, 0, path))
+            {
+                free(data);
+            }
+        }
+    }
+
+    __ut_fuzz_catch(false);
+    __ut_fuzz_running = false;
+#ifdef UT_ENABLE_PARALLEL
+    pthread_mutex_unlock(&__ut_fuzz_mutex);
+#endif
+
+    if (stopped)
+    {
+        if (seen == NULL || buffer == NULL)
+        {
+            __ut_fail_test(desc, "fuzz target: out of memory");
+        }
+    }
+    else if (found == NULL)
+    {
+        desc->performed_count += performed_count;
+        desc->successed_count += successed_count;
+    }
+    else
+    {
+#ifdef UT_ENABLE_ASSERT_EVENTS
+        __ut_assert_flush();
+#endif
+        __ut_fail_test(desc, buf);
+
+        // Повторяем вход с обработчиками проверок
+        if (__ut_refresh_fixtures(desc, before_each, after_each))
+        {
+            func(desc, found, found_size);
+        }
+    }
+
+    __ut_fuzz_free_corpus(&corpus);
+    free(seen);
+    free(buffer);
+}
+
+/*!
+    \brief     Завершить цель фаззинга, прерванную по истечении времени
+    \details   Мутированный вход, выполнявшийся целью, сохраняется в файле
+        \p timeout-<хэш> в каталоге корпуса цели; путь к нему сообщается проверкой.
+        Восстанавливает обработчики сигналов и снимает блокировку; память корпуса
+        прерванной цели не освобождается
+    \param[in,out] test_state указатель на состояние прерванного теста
+    \protected
+*/
+static inline void __ut_fuzz_abandon(struct __ut_test_state *test_state)
+{
+    if (!__ut_fuzz_running)
+    {
+        return;
+    }
+
+    const uint8_t *input = __ut_fuzz.input;
+    __ut_fuzz.input = NULL;
+    if (input != NULL)
+    {
+        char path[__UT_FUZZ_PATH_SIZE + __UT_FUZZ_NAME_SIZE];
+        const char *reproducer = __ut_fuzz.input_path;
+        if (reproducer == NULL)
+        {
+            __ut_fuzz_file_path(path, "timeout-", __ut_fuzz_hash(input, __ut_fuzz.input_size));
+            __ut_fuzz_write(path, input, __ut_fuzz.input_size);
+            reproducer = path;
+        }
+
+        char buf[UT_BUFFER_SIZE + sizeof(path)];
+        snprintf(buf, sizeof(buf), "fuzz target timed out; reproducer: %s", reproducer);
+        __ut_fail_test(test_state, buf);
+    }
+    __ut_fuzz_catch(false);
+    __ut_fuzz_running = false;
+#ifdef UT_ENABLE_PARALLEL
+    pthread_mutex_unlock(&__ut_fuzz_mutex);
+#endif
+}
+
+/*!
+    \brief     Определить цель фаззинга - тест, выполняемый на входах-массивах байтов
+    \details   Тело цели получает \p desc, указатель на вход \p data и его размер \p size
+        (\p const \p uint8_t \p *, \p size_t). Неуспешная проверка или аварийное
+        завершение цели считаются найденной ошибкой (см. #__ut_fuzz_run). Перед каждым
+        входом вызываются after each- и before each-функции набора тестов. Цель
+        добавляется в набор тестов макросом #UT_ADD_TEST. При параллельном выполнении
+        тестов цели выполняются по одной: счетчики покрытия общие для процесса
+    \param[in] test_suite набор тестов
+    \param[in] target     цель
+*/
+#define UT_FUZZ(test_suite, target)                                                             \
+    static void test_suite##_##target##_fuzz(struct __ut_test_state *desc,                      \
+        const uint8_t *data, size_t size);                                                      \
+                                                                                                \
+    void test_suite##_before_each(struct __ut_test_state *desc);                                \
+    void test_suite##_after_each(struct __ut_test_state *desc);                                 \
+                                                                                                \
+    UT_TEST(test_suite, target)                                                                 \
+    {                                                                                           \
+        __ut_fuzz_run(desc, #test_suite, test_suite##_##target##_fuzz,                          \
+            test_suite##_before_each, test_suite##_after_each);                                 \
+    }                                                                                           \
+                                                                                                \
+    static void test_suite##_##target##_fuzz(struct __ut_test_state *desc,                      \
+        const uint8_t *data, size_t size)
+
+#endif  // UT_ENABLE_FUZZ
+
+#ifdef UT_ENABLE_BASELINE
+
+#ifdef UT_ENABLE_BENCH
+//! Максимальное количество замеров в записи базовой линии
+#define __UT_BASELINE_SAMPLES UT_BENCH_SAMPLES
+#else
+#define __UT_BASELINE_SAMPLES 1
+#endif
+
+/*!
+    \brief     Запись базовой линии производительности
+    \protected
+*/
+struct __ut_baseline_record
+{
+    uint64_t key;                               //!< Ключ наименования теста, см. #__ut_test_name_key
+    uint64_t samples_count;                     //!< Количество замеров
+    double samples[__UT_BASELINE_SAMPLES];      //!< Замеры бенчмарка (нс на итерацию), по возрастанию, или длительность теста (нс)
+};
+
+/*!
+    \brief     Базовая линия производительности
+    \details   Записи упорядочены по ключу. Файл содержит сигнатуру
+        \p "UTBL1\0\0\0", вместимость записи (\p uint64_t, #__UT_BASELINE_SAMPLES),
+        количество записей (\p uint64_t) и сами записи. Слабое определение: одна базовая
+        линия на программу, иначе наборы тестов из разных единиц трансляции
+        перезаписывали бы файл записями только своих тестов
+    \protected
+*/
+struct __ut_baseline_state
+{
+    bool loaded;                                //!< Флаг загрузки базовой линии из файла
+    bool update;                                //!< Флаг перезаписи базовой линии (переменная окружения \p UT_BASELINE_UPDATE)
+    struct __ut_baseline_record *records;       //!< Массив записей
+    size_t count;                               //!< Количество записей
+    size_t capacity;                            //!< Вместимость массива записей
+};
+__attribute__((weak)) struct __ut_baseline_state __ut_baseline;
+
+//! Сигнатура файла базовой линии
+static const char __ut_baseline_magic[8] = "UTBL1";
+
+/*!
+    \brief     Получить путь к файлу базовой линии
+    \protected
+*/
+static const char *__ut_baseline_path(void)
+{
+    const char *path = getenv("UT_BASELINE");
+
+    return path != NULL && *path != '\0' ? path : UT_BASELINE_FILE;
+}
+
+/*!
+    \brief     Сравнить две записи базовой линии по ключу (для \p qsort и \p bsearch)
+    \protected
+*/
+static int __ut_baseline_compare(const void *a, const void *b)
+{
+    const uint64_t x = ((const struct __ut_baseline_record *)a)->key, y = ((const struct __ut_baseline_record *)b)->key;
+
+    return (x > y) - (x < y);
+}
+
+/*!
+    \brief     Загрузить базовую линию (однократно)
+    \details   Отсутствующий, поврежденный (в том числе с количеством замеров записи
+        больше ее вместимости) или записанный с другой вместимостью записи файл
+        равносилен пустой базовой линии
+    \protected
+*/
+static void __ut_baseline_load(void)
+{
+    if (__ut_baseline.loaded)
+    {
+        return;
+    }
+    __ut_baseline.loaded = true;
+
+    const char *update = getenv("UT_BASELINE_UPDATE");
+    __ut_baseline.update = update != NULL && *update != '\0' && strcmp(update, "0") != 0;
+
+    FILE *file = fopen(__ut_baseline_path(), "rb");
+    if (file == NULL)
+    {
+        return;
+    }
+
+    char magic[sizeof(__ut_baseline_magic)];
+    uint64_t samples_capacity, count;
+    if (fread(magic, sizeof(magic), 1, file) == 1 && memcmp(magic, __ut_baseline_magic, sizeof(magic)) == 0
+        && fread(&samples_capacity, sizeof(samples_capacity), 1, file) == 1 && samples_capacity == __UT_BASELINE_SAMPLES
+        && fread(&count, sizeof(count), 1, file) == 1 && count <= SIZE_MAX / sizeof(struct __ut_baseline_record))
+    {
+        __ut_baseline.records = (struct __ut_baseline_record *)malloc(count * sizeof(struct __ut_baseline_record));
+        if (__ut_baseline.records != NULL
+            && fread(__ut_baseline.records, sizeof(struct __ut_baseline_record), count, file) == count)
+        {
+            __ut_baseline.count = __ut_baseline.capacity = count;
+        }
+
+        // Количество замеров записи не может превышать ее вместимость
+        for (size_t i = 0; i < __ut_baseline.count; ++i)
+        {
+            if (__ut_baseline.records[i].samples_count > __UT_BASELINE_SAMPLES)
+            {
+                __ut_baseline.count = 0;
+                break;
+            }
+        }
+    }
+
+    fclose(file);
+}
+
+/*!
+    \brief     Найти тест в базовой линии
+    \param[in] key   ключ наименования теста
+    \param[in] count количество первых (упорядоченных по ключу) записей, среди которых ищется тест
+    \return    Указатель на запись; \p NULL, если тест не найден
+    \protected
+*/
+static struct __ut_baseline_record *__ut_baseline_find(uint64_t key, size_t count)
+{
+    struct __ut_baseline_record needle;
+    needle.key = key;
+
+    return count == 0 ? NULL : (struct __ut_baseline_record *)bsearch(&needle,
+        __ut_baseline.records, count, sizeof(struct __ut_baseline_record), __ut_baseline_compare);
+}
+
+#ifdef UT_ENABLE_BENCH
+
+/*!
+    \brief     Проверить, что замеры стали значимо больше базовых
+    \details   Односторонний U-критерий Манна-Уитни в нормальном приближении
+        (с поправкой на непрерывность)
+    \param[in] base       массив базовых замеров
+    \param[in] base_count количество базовых замеров
+    \param[in] cur        массив текущих замеров
+    \param[in] cur_count  количество текущих замеров
+    \return    \p true, если статистика превышает #UT_BASELINE_CRITICAL_Z
+    \protected
+*/
+static bool __ut_baseline_slower(const double *base, unsigned int base_count, const double *cur, unsigned int cur_count)
+{
+    // U - количество пар, в которых текущий замер больше базового (ничьи - пополам)
+    double u = 0;
+    for (unsigned int i = 0; i < cur_count; ++i)
+    {
+        for (unsigned int j = 0; j < base_count; ++j)
+        {
+            u += cur[i] > base[j] ? 1.0 : cur[i] == base[j] ? 0.5 : 0.0;
+        }
+    }
+
+    const double n1 = cur_count, n2 = base_count;
+    const double d = u - n1 * n2 / 2 - 0.5;
+    const double variance = n1 * n2 * (n1 + n2 + 1) / 12;
+
+    // z = d / sqrt(variance) > z_crit, без обращения к libm
+    return d > 0 && d * d > (double)UT_BASELINE_CRITICAL_Z * (double)UT_BASELINE_CRITICAL_Z * variance;
+}
+
+#endif
+
+/*!
+    \brief     Сравнить длительность успешного теста с базовой линией
+    \details   Бенчмарк считается замедлившимся, если его медиана выросла более чем
+        на #UT_BASELINE_BENCH_THRESHOLD и замедление значимо по критерию Манна-Уитни;
+        обычный тест - если его длительность выросла более чем на #UT_BASELINE_TEST_THRESHOLD
+        и на #UT_BASELINE_MIN_DELTA_NS. Замедление фиксируется неуспешной проверкой
+        с указанием изменения
+    \param[in]     test_suite_desc указатель на структуру набора тестов
+    \param[in,out] test_state      указатель на состояние теста
+    \protected
+*/
+static void __ut_baseline_check(const struct __ut_test_suite_desc *test_suite_desc, struct __ut_test_state *test_state)
+{
+    test_state->baseline_delta = 0;
+
+    __ut_baseline_load();
+    if (__ut_baseline.update || !UT_IS_TEST_SUCCESSED(test_state))
+    {
+        return;
+    }
+
+    const struct __ut_baseline_record *record = __ut_baseline_find(__ut_test_name_key(test_suite_desc, test_state->test),
+        __ut_baseline.count);
+    if (record == NULL || record->samples_count == 0)
+    {
+        return;
+    }
+
+    char buf[UT_BUFFER_SIZE];
+    bool slower;
+
+#ifdef UT_ENABLE_BENCH
+    const struct __ut_bench_stats *bench = test_state->test->bench;
+    if (bench != NULL && bench->samples_count > 0)
+    {
+        const double base = record->samples[record->samples_count / 2];
+        test_state->baseline_delta = base > 0 ? bench->median / base - 1 : 0;
+        slower = test_state->baseline_delta > UT_BASELINE_BENCH_THRESHOLD
+            && (UT_BASELINE_CRITICAL_Z <= 0
+                || __ut_baseline_slower(record->samples, (unsigned int)record->samples_count, bench->samples, bench->samples_count));
+        snprintf(buf, sizeof(buf), "benchmark slower than baseline: median %.1f ns -> %.1f ns (%+.1f%%)",
+            base, bench->median, 100 * test_state->baseline_delta);
+    }
+    else
+#endif
+    {
+        const double base = record->samples[0], cur = (double)test_state->usage.wall_ns;
+        test_state->baseline_delta = base > 0 ? cur / base - 1 : 0;
+        slower = test_state->baseline_delta > UT_BASELINE_TEST_THRESHOLD && cur - base > (double)UT_BASELINE_MIN_DELTA_NS;
+        snprintf(buf, sizeof(buf), "test slower than baseline: %.3f ms -> %.3f ms (%+.1f%%)",
+            base / 1e6, cur / 1e6, 100 * test_state->baseline_delta);
+    }
+
+    if (slower)
+    {
+        __ut_fail_test(test_state, buf);
+    }
+}
+
+/*!
+    \brief     Добавить в базовую линию успешные тесты набора и сохранить ее в файл
+    \details   Записи уже имеющихся тестов перезаписываются, только если задана
+        переменная окружения \p UT_BASELINE_UPDATE: иначе базовая линия
+        «ползла» бы вслед за постепенным замедлением.
+        Файл перезаписывается атомарно (через временный файл)
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \param[in] test_count      количество тестов в наборе
+    \protected
+*/
+static void __ut_baseline_update(const struct __ut_test_suite_desc *test_suite_desc, unsigned int test_count)
+{
+    __ut_baseline_load();
+
+    const size_t sorted_count = __ut_baseline.count;
+    bool changed = false;
+
+    for (unsigned int i = 0; i < test_count; ++i)
+    {
+        const struct __ut_test_state *test_state = &(test_suite_desc->test_states[i]);
+        if (!UT_IS_TEST_SUCCESSED(test_state))
+        {
+            continue;
+        }
+
+        const uint64_t key = __ut_test_name_key(test_suite_desc, test_state->test);
+        // Добавленные в конец записи не упорядочены - ищем среди прежних
+        struct __ut_baseline_record *record = __ut_baseline_find(key, sorted_count);
+        if (record != NULL && !__ut_baseline.update)
+        {
+            continue;
+        }
+
+        // Новую запись добавляем в конец; порядок восстановим после цикла
+        if (record == NULL)
+        {
+            if (__ut_baseline.count == __ut_baseline.capacity)
+            {
+                const size_t capacity = __ut_baseline.capacity * 2 + test_count;
+                struct __ut_baseline_record *records = (struct __ut_baseline_record *)realloc(__ut_baseline.records,
+                    capacity * sizeof(struct __ut_baseline_record));
+                if (records == NULL)
+                {
+                    break;
+                }
+                __ut_baseline.records = records;
+                __ut_baseline.capacity = capacity;
+            }
+            record = &__ut_baseline.records[__ut_baseline.count++];
+        }
+
+        memset(record, 0, sizeof(*record));
+        record->key = key;
+#ifdef UT_ENABLE_BENCH
+        if (test_state->test->bench != NULL && test_state->test->bench->samples_count > 0)
+        {
+            record->samples_count = test_state->test->bench->samples_count;
+            memcpy(record->samples, test_state->test->bench->samples, test_state->test->bench->samples_count * sizeof(double));
+        }
+        else
+#endif
+        {
+            record->samples_count = 1;
+            record->samples[0] = (double)test_state->usage.wall_ns;
+        }
+        changed = true;
+    }
+
+    if (!changed)
+    {
+        return;
+    }
+
+    if (__ut_baseline.count != sorted_count)
+    {
+        qsort(__ut_baseline.records, __ut_baseline.count, sizeof(struct __ut_baseline_record), __ut_baseline_compare);
+    }
+
+    // Сохраняем базовую линию
+    const char *path = __ut_baseline_path();
+    char temp_path[UT_BUFFER_SIZE];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+
+    FILE *file = fopen(temp_path, "wb");
+    if (file == NULL)
+    {
+        return;
+    }
+
+    const uint64_t samples_capacity = __UT_BASELINE_SAMPLES, count = __ut_baseline.count;
+    const bool written = fwrite(__ut_baseline_magic, sizeof(__ut_baseline_magic), 1, file) == 1
+        && fwrite(&samples_capacity, sizeof(samples_capacity), 1, file) == 1
+        && fwrite(&count, sizeof(count), 1, file) == 1
+        && fwrite(__ut_baseline.records, sizeof(struct __ut_baseline_record), count, file) == count;
+    if (fclose(file) == 0 && written)
+    {
+        rename(temp_path, path);
+    }
+    else
+    {
+        remove(temp_path);
+    }
+}
+
+#endif  // UT_ENABLE_BASELINE
+
+#ifdef UT_ENABLE_SHARDING
+
+/*!
+    \brief     Параметры разбиения тестов между процессами
+    \details   Слабое определение: одни параметры на программу, сколько бы
+        единиц трансляции ни включали заголовок
+    \protected
+*/
+struct __ut_shard_state
+{
+    bool loaded;                       //!< Флаг чтения параметров из окружения
+    unsigned long total;               //!< Количество частей; \p 0 - разбиение не используется
+    unsigned long index;               //!< Номер части, выполняемой текущим процессом
+};
+__attribute__((weak)) struct __ut_shard_state __ut_shard;
+
+/*!
+    \brief     Прочитать параметры разбиения тестов из окружения (однократно)
+    \details   Используются переменные \p UT_TOTAL_SHARDS и \p UT_SHARD_INDEX.
+        Если хотя бы одна из них не задана или задана некорректно, то разбиение не используется
+    \protected
+*/
+static void __ut_shard_load(void)
+{
+    if (__ut_shard.loaded)
+    {
+        return;
+    }
+    __ut_shard.loaded = true;
+
+    const char *total = getenv("UT_TOTAL_SHARDS");
+    const char *index = getenv("UT_SHARD_INDEX");
+    if (total == NULL || index == NULL || *total == '\0' || *index == '\0')
+    {
+        return;
+    }
+
+    char *total_end, *index_end;
+    const unsigned long total_value = strtoul(total, &total_end, 10);
+    const unsigned long index_value = strtoul(index, &index_end, 10);
+    if (*total_end == '\0' && *index_end == '\0' && index_value < total_value)
+    {
+        __ut_shard.total = total_value;
+        __ut_shard.index = index_value;
+    }
+}
+
+/*!
+    \brief     Проверить, относится ли тест к части, выполняемой текущим процессом
+    \details   Тест относится к части с номером, равным остатку от деления
+        перемешанного ключа наименования теста (см. #__ut_test_name_key) на количество частей.
+        Разбиение стабильно: оно одинаково во всех процессах и между запусками
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \param[in] test_desc       указатель на структуру теста
+    \return    \p true, если тест нужно выполнить; \p false иначе
+    \protected
+*/
+static bool __ut_shard_contains(const struct __ut_test_suite_desc *test_suite_desc, const struct __ut_test_desc *test_desc)
+{
+    __ut_shard_load();
+
+    if (__ut_shard.total == 0)
+    {
+        return true;
+    }
+
+    // Перемешиваем биты ключа (финализатор MurmurHash3): остатки FNV-1a
+    // по малым модулям распределены неравномерно
+    uint64_t key = __ut_test_name_key(test_suite_desc, test_desc);
+    key = (key ^ (key >> 33)) * 0xFF51AFD7ED558CCDull;
+    key = (key ^ (key >> 33)) * 0xC4CEB9FE1A85EC53ull;
+    key ^= key >> 33;
+
+    return key % __ut_shard.total == __ut_shard.index;
+}
+
+#endif  // UT_ENABLE_SHARDING
+
+#ifdef UT_ENABLE_FILTER
+
+/*!
+    \brief     Элемент множества строк фильтра
+    \protected
+*/
+struct __ut_filter_entry
+{
+    uint64_t hash;                     //!< Хэш FNV-1a строки
+    const char *string;                //!< Указатель на начало строки (не обязательно завершенной нулем)
+    size_t length;                     //!< Длина строки
+};
+
+/*!
+    \brief     Множество строк фильтра (хэш-таблица с открытой адресацией)
+    \protected
+*/
+struct __ut_filter_set
+{
+    struct __ut_filter_entry *entries; //!< Массив элементов; \p string == NULL - свободный элемент
+    size_t capacity;                   //!< Вместимость (степень двойки)
+    size_t count;                      //!< Количество элементов
+};
+
+/*!
+    \brief     Скомпилированный список шаблонов наименований тестов
+    \details   Шаблоны разделены на три вида, чтобы проверка наименования
+        не зависела от количества шаблонов первых двух видов:
+        - без символов подстановки - проверяются поиском в хэш-таблице;
+        - вида \p prefix* - проверяются поиском префиксов наименования в хэш-таблице,
+          только для длин, встречающихся среди шаблонов;
+        - остальные - проверяются последовательно
+    \protected
+*/
+struct __ut_filter_patterns
+{
+    bool any;                                   //!< Флаг наличия шаблона \p *
+    struct __ut_filter_set exact;               //!< Шаблоны без символов подстановки
+    struct __ut_filter_set prefixes;            //!< Префиксы шаблонов вида \p prefix*
+    bool prefix_lengths[UT_BUFFER_SIZE];        //!< Флаги наличия префиксов каждой длины
+    const char **globs;                         //!< Остальные шаблоны
+    size_t globs_count;                         //!< Количество остальных шаблонов
+};
+
+/*!
+    \brief     Фильтр наименований тестов
+    \details   Слабое определение: фильтр, заданный параметром командной строки
+        в одной единице трансляции, действует на наборы тестов из других
+    \protected
+*/
+struct __ut_filter_state
+{
+    bool loaded;                                //!< Флаг компиляции фильтра
+    char *text;                                 //!< Копия текста фильтра, на которую ссылаются шаблоны
+    bool has_positive;                          //!< Флаг наличия положительных шаблонов
+    struct __ut_filter_patterns positive;       //!< Шаблоны выполняемых тестов
+    struct __ut_filter_patterns negative;       //!< Шаблоны исключаемых тестов
+};
+__attribute__((weak)) struct __ut_filter_state __ut_filter;
+
+/*!
+    \brief     Вычислить хэш FNV-1a последовательности символов
+    \protected
+*/
+static uint64_t __ut_filter_hash(const char *string, size_t length)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash = (hash ^ (unsigned char)string[i]) * 1099511628211ull;
+    }
+
+    return hash;
+}
+
+/*!
+    \brief     Найти строку в множестве
+    \return    \p true, если строка найдена; \p false иначе
+    \protected
+*/
+static bool __ut_filter_set_contains(const struct __ut_filter_set *set, uint64_t hash, const char *string, size_t length)
+{
+    if (set->count == 0)
+    {
+        return false;
+    }
+
+    for (size_t i = hash & (set->capacity - 1); set->entries[i].string != NULL; i = (i + 1) & (set->capacity - 1))
+    {
+        const struct __ut_filter_entry *entry = &(set->entries[i]);
+        if (entry->hash == hash && entry->length == length && memcmp(entry->string, string, length) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*!
+    \brief     Добавить строку в множество
+    \details   Заполненность таблицы поддерживается не выше половины
+    \return    \p true в случае успеха; \p false, если не хватило памяти
+    \protected
+*/
+static bool __ut_filter_set_add(struct __ut_filter_set *set, const char *string, size_t length)
+{
+    if ((set->count + 1) * 2 > set->capacity)
+    {
+        const size_t capacity = set->capacity == 0 ? 16 : set->capacity * 2;
+        struct __ut_filter_entry *entries = (struct __ut_filter_entry *)calloc(capacity, sizeof(struct __ut_filter_entry));
+        if (entries == NULL)
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i < set->capacity; ++i)
+        {
+            if (set->entries[i].string != NULL)
+            {
+                size_t j = set->entries[i].hash & (capacity - 1);
+                while (entries[j].string != NULL)
+                {
+                    j = (j + 1) & (capacity - 1);
+                }
+                entries[j] = set->entries[i];
+            }
+        }
+
+        free(set->entries);
+        set->entries = entries;
+        set->capacity = capacity;
+    }
+
+    const uint64_t hash = __ut_filter_hash(string, length);
+    if (__ut_filter_set_contains(set, hash, string, length))
+    {
+        return true;
+    }
+
+    size_t i = hash & (set->capacity - 1);
+    while (set->entries[i].string != NULL)
+    {
+        i = (i + 1) & (set->capacity - 1);
+    }
+    set->entries[i].hash = hash;
+    set->entries[i].string = string;
+    set->entries[i].length = length;
+    ++set->count;
+
+    return true;
+}
+
+/*!
+    \brief     Добавить шаблон в скомпилированный список шаблонов
+    \param[in] patterns указатель на список шаблонов
+    \param[in] pattern  указатель на строку-шаблон (должна существовать, пока используется фильтр)
+    \return    \p true в случае успеха; \p false, если не хватило памяти
+    \protected
+*/
+static bool __ut_filter_add_pattern(struct __ut_filter_patterns *patterns, const char *pattern)
+{
+    const size_t length = strlen(pattern);
+    const char *wildcard = strpbrk(pattern, "*?");
+
+    if (wildcard == NULL)
+    {
+        return __ut_filter_set_add(&patterns->exact, pattern, length);
+    }
+
+    if (*wildcard == '*' && wildcard == pattern + length - 1 && (size_t)(wildcard - pattern) < UT_BUFFER_SIZE)
+    {
+        const size_t prefix_length = (size_t)(wildcard - pattern);
+        if (prefix_length == 0)
+        {
+            patterns->any = true;
+            return true;
+        }
+
+        patterns->prefix_lengths[prefix_length] = true;
+        return __ut_filter_set_add(&patterns->prefixes, pattern, prefix_length);
+    }
+
+    const char **globs = (const char **)realloc((void *)patterns->globs, (patterns->globs_count + 1) * sizeof(const char *));
+    if (globs == NULL)
+    {
+        return false;
+    }
+    patterns->globs = globs;
+    patterns->globs[patterns->globs_count++] = pattern;
+
+    return true;
+}
+
+/*!
+    \brief     Сопоставить строку с шаблоном
+    \details   \p * - любая последовательность символов, \p ? - любой символ.
+        Используется жадный алгоритм с возвратом к последней \p *,
+        время работы не более O(длина шаблона * длина строки)
+    \protected
+*/
+static bool __ut_glob_match(const char *pattern, const char *string)
+{
+    const char *star = NULL, *resume = NULL;
+
+    while (*string != '\0')
+    {
+        if (*pattern == '?' || (*pattern == *string && *pattern != '*'))
+        {
+            ++pattern;
+            ++string;
+        }
+        else if (*pattern == '*')
+        {
+            star = pattern++;
+            resume = string;
+        }
+        else if (star != NULL)
+        {
+            pattern = star + 1;
+            string = ++resume;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    while (*pattern == '*')
+    {
+        ++pattern;
+    }
+
+    return *pattern == '\0';
+}
+
+/*!
+    \brief     Проверить, соответствует ли наименование хотя бы одному шаблону списка
+    \param[in] patterns указатель на список шаблонов
+    \param[in] name     наименование теста (\p suite.test)
+    \param[in] length   длина наименования
+    \protected
+*/
+static bool __ut_filter_patterns_match(const struct __ut_filter_patterns *patterns, const char *name, size_t length)
+{
+    if (patterns->any || __ut_filter_set_contains(&patterns->exact, __ut_filter_hash(name, length), name, length))
+    {
+        return true;
+    }
+
+    // Хэш префикса наращиваем посимвольно
+    if (patterns->prefixes.count > 0)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 1; i <= length && i < UT_BUFFER_SIZE; ++i)
+        {
+            hash = (hash ^ (unsigned char)name[i - 1]) * 1099511628211ull;
+            if (patterns->prefix_lengths[i] && __ut_filter_set_contains(&patterns->prefixes, hash, name, i))
+            {
+                return true;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < patterns->globs_count; ++i)
+    {
+        if (__ut_glob_match(patterns->globs[i], name))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*!
+    \brief     Скомпилировать фильтр наименований тестов
+    \details   Фильтр имеет вид \p POSITIVE[-NEGATIVE] (как у \p --gtest_filter), где обе части -
+        списки шаблонов наименований вида \p suite.test, разделенных символом \p :.
+        Например, \p "net.*:db.*-*.slow_*" выполняет тесты наборов \p net и \p db, кроме медленных.
+        Тест выполняется, если он соответствует хотя бы одному положительному шаблону
+        (или положительных шаблонов нет) и не соответствует ни одному исключающему.
+        Пустая строка или \p NULL отключают фильтр
+    \param[in] filter указатель на строку-фильтр
+    \return    \p true в случае успеха; \p false, если не хватило памяти (фильтр отключается)
+    \protected
+*/
+static bool __ut_filter_compile(const char *filter)
+{
+    // Освобождаем предыдущий фильтр
+    free(__ut_filter.positive.exact.entries);
+    free(__ut_filter.positive.prefixes.entries);
+    free((void *)__ut_filter.positive.globs);
+    free(__ut_filter.negative.exact.entries);
+    free(__ut_filter.negative.prefixes.entries);
+    free((void *)__ut_filter.negative.globs);
+    free(__ut_filter.text);
+    memset(&__ut_filter, 0, sizeof(__ut_filter));
+    __ut_filter.loaded = true;
+
+    if (filter == NULL || *filter == '\0')
+    {
+        return true;
+    }
+
+    __ut_filter.text = strdup(filter);
+    if (__ut_filter.text == NULL)
+    {
+        return false;
+    }
+
+    // Отделяем исключающие шаблоны
+    char *negative = strchr(__ut_filter.text, '-');
+    if (negative != NULL)
+    {
+        *negative++ = '\0';
+    }
+
+    bool successed = true;
+    for (char *pattern = __ut_filter.text; pattern != NULL && successed; )
+    {
+        char *next = strchr(pattern, ':');
+        if (next != NULL)
+        {
+            *next++ = '\0';
+        }
+        else if (negative != NULL && pattern < negative)
+        {
+            // Положительные шаблоны закончились - переходим к исключающим
+            next = negative;
+        }
+
+        if (*pattern != '\0')
+        {
+            const bool is_negative = negative != NULL && pattern >= negative;
+            successed = __ut_filter_add_pattern(is_negative ? &__ut_filter.negative : &__ut_filter.positive, pattern);
+            __ut_filter.has_positive = __ut_filter.has_positive || !is_negative;
+        }
+
+        pattern = next;
+    }
+
+    if (!successed)
+    {
+        __ut_filter_compile(NULL);
+    }
+
+    return successed;
+}
+
+/*!
+    \brief     Скомпилировать фильтр из переменной окружения \p UT_FILTER,
+        если фильтр еще не задан
+    \protected
+*/
+static void __ut_filter_load(void)
+{
+    if (!__ut_filter.loaded)
+    {
+        __ut_filter_compile(getenv("UT_FILTER"));
+    }
+}
+
+/*!
+    \brief     Проверить, проходит ли тест фильтр наименований
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \param[in] test_desc       указатель на структуру теста
+    \return    \p true, если тест нужно выполнить; \p false иначе
+    \protected
+*/
+static bool __ut_filter_matches(const struct __ut_test_suite_desc *test_suite_desc, const struct __ut_test_desc *test_desc)
+{
+    __ut_filter_load();
+
+    if (__ut_filter.text == NULL)
+    {
+        return true;
+    }
+
+    char name[UT_BUFFER_SIZE];
+    const int length = snprintf(name, sizeof(name), "%s.%s", test_suite_desc->name, test_desc->name);
+    if (length < 0)
+    {
+        return true;
+    }
+    const size_t name_length = (size_t)length < sizeof(name) ? (size_t)length : sizeof(name) - 1;
+
+    return (!__ut_filter.has_positive || __ut_filter_patterns_match(&__ut_filter.positive, name, name_length))
+        && !__ut_filter_patterns_match(&__ut_filter.negative, name, name_length);
+}
+
+/*!
+    \brief     Задать фильтр наименований тестов
+    \details   Переопределяет фильтр из переменной окружения \p UT_FILTER
+    \param[in] filter указатель на строку-фильтр, см. #__ut_filter_compile
+*/
+#define UT_SET_FILTER(filter) __ut_filter_compile(filter)
+
+#endif  // UT_ENABLE_FILTER
+
+#ifdef UT_ENABLE_TIMEOUT
+
+/*!
+    \brief     Количество кадров стека, принадлежащих обработчику #UT_TIMEOUT_SIGNAL
+    \details   Обработчик и трамплин возврата из обработчика сигнала
+    \protected
+*/
+#define __UT_TIMEOUT_HANDLER_FRAMES 2
+
+/*!
+    \brief     Запись потока, выполняющего тест под наблюдением
+    \protected
+*/
+struct __ut_timeout_slot
+{
+    struct __ut_timeout_slot *next;    //!< Следующая запись в списке наблюдаемых потоков
+    pthread_t thread;                  //!< Поток, выполняющий тест
+    unsigned long long deadline_ns;    //!< Момент истечения отведенного времени, нс; \p 0 - не ограничено
+    bool suite;                        //!< Флаг ограничения временем набора тестов (а не теста)
+    bool armed;                        //!< Флаг выполнения теста под наблюдением
+    bool fired;                        //!< Флаг отправки потоку #UT_TIMEOUT_SIGNAL
+    bool interrupted;                  //!< Флаг прерывания текущего теста
+    bool after_each;                   //!< Флаг запуска after each-функции текущего теста
+    const struct __ut_test_state *test_state;    //!< Выполняемый тест
+    sigjmp_buf env;                    //!< Точка возврата из прерванного теста
+    void *frames[__UT_TIMEOUT_HANDLER_FRAMES + UT_TIMEOUT_BACKTRACE_DEPTH];    //!< Стек вызовов прерванного теста
+    int frames_count;                  //!< Количество кадров стека
+};
+
+/*!
+    \brief     Параметры ограничения времени и список наблюдаемых потоков
+    \details   Обработчик сигнала устанавливается один на процесс, поэтому
+        состояние, с которым он работает, тоже одно на программу (слабое определение)
+    \protected
+*/
+struct __ut_timeout_state
+{
+    bool loaded;                       //!< Флаг чтения параметров из окружения
+    bool started;                      //!< Флаг запуска сторожевого потока
+    bool external;                     //!< Флаг наблюдения внешним процессом (зиготой изолированного запуска) вместо сторожевого потока
+    unsigned long long test_ns;        //!< Время, отведенное на тест, нс; \p 0 - не ограничено
+    unsigned long long suite_ns;       //!< Время, отведенное на тесты набора, нс; \p 0 - не ограничено
+    struct __ut_timeout_slot *slots;   //!< Список наблюдаемых потоков
+    pthread_mutex_t mutex;             //!< Мьютекс, защищающий список
+    pthread_cond_t cond;               //!< Условие изменения списка
+};
+__attribute__((weak)) struct __ut_timeout_state __ut_timeout = { false, false, false, 0, 0, NULL, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER };
+
+/*!
+    \brief     Запись текущего потока
+    \details   Поток одновременно выполняет не более одного теста. Слабое определение:
+        одна переменная на программу
+    \protected
+*/
+__attribute__((weak)) __thread struct __ut_timeout_slot __ut_timeout_slot;
+
+/*!
+    \brief     Прочитать время из переменной окружения
+    \param[in] name       имя переменной окружения (значение в мс)
+    \param[in] default_ms значение по умолчанию, мс
+    \return    Время, нс
+    \protected
+*/
+static unsigned long long __ut_timeout_env_ns(const char *name, unsigned long long default_ms)
+{
+    const char *value = getenv(name);
+    if (value != NULL && *value != '\0')
+    {
+        char *end;
+        const unsigned long long ms = strtoull(value, &end, 10);
+        if (*end == '\0')
+        {
+            return ms * 1000000ull;
+        }
+    }
+
+    return default_ms * 1000000ull;
+}
+
+/*!
+    \brief     Обработчик #UT_TIMEOUT_SIGNAL
+    \details   Сохраняет стек вызовов теста и возвращается в #__ut_run_test.
+        Опоздавший сигнал (тест уже завершен или время следующего теста
+        не истекло) игнорируется. Внутри участка, отложившего прерывание
+        (см. #__ut_timeout_defer), прерывание только помечается.
+        Слабое определение: один обработчик на программу
+    \param[in] signum номер сигнала
+    \protected
+*/
+__attribute__((weak)) void __ut_timeout_handler(int signum)
+{
+    struct __ut_timeout_slot *slot = &__ut_timeout_slot;
+    (void)signum;
+
+    if (!__atomic_load_n(&slot->armed, __ATOMIC_ACQUIRE) || __ut_now_ns() < slot->deadline_ns)
+    {
+        return;
+    }
+    if (__ut_timeout_defer.depth != 0)
+    {
+        __ut_timeout_defer.pending = true;
+        return;
+    }
+
+    slot->frames_count = backtrace(slot->frames, (int)(sizeof(slot->frames) / sizeof(slot->frames[0])));
+    __atomic_store_n(&slot->armed, false, __ATOMIC_RELEASE);
+    __ut_timeout_defer.pending = false;
+    siglongjmp(slot->env, 1);
+}
+
+/*!
+    \brief     Прочитать параметры ограничения времени (однократно) и установить обработчик сигнала
+    \details   Используются переменные окружения \p UT_TEST_TIMEOUT и \p UT_TEST_SUITE_TIMEOUT
+    \protected
+*/
+static void __ut_timeout_load(void)
+{
+    if (__ut_timeout.loaded)
+    {
+        return;
+    }
+    __ut_timeout.loaded = true;
+
+    __ut_timeout.test_ns = __ut_timeout_env_ns("UT_TEST_TIMEOUT", UT_TEST_TIMEOUT_MS);
+    __ut_timeout.suite_ns = __ut_timeout_env_ns("UT_TEST_SUITE_TIMEOUT", UT_TEST_SUITE_TIMEOUT_MS);
+
+    // При первом вызове backtrace загружает библиотеку раскрутки стека:
+    // делаем это заранее, а не в обработчике сигнала
+    void *frame;
+    backtrace(&frame, 1);
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = __ut_timeout_handler;
+    sigemptyset(&action.sa_mask);
+    sigaction(UT_TIMEOUT_SIGNAL, &action, NULL);
+}
+
+/*!
+    \brief     Вычислить момент истечения времени теста
+    \param[in]  test_suite_desc указатель на структуру набора тестов
+    \param[in]  started_ns      момент запуска теста, нс
+    \param[out] suite           флаг ограничения временем набора тестов (а не теста)
+    \return    Момент истечения времени, нс; \p 0 - не ограничено
+    \protected
+*/
+static unsigned long long __ut_timeout_deadline(const struct __ut_test_suite_desc *test_suite_desc,
+    unsigned long long started_ns, bool *suite)
+{
+    const unsigned long long test_deadline = __ut_timeout.test_ns != 0 ? started_ns + __ut_timeout.test_ns : 0;
+    const unsigned long long suite_deadline = test_suite_desc->deadline_ns;
+
+    *suite = suite_deadline != 0 && (test_deadline == 0 || suite_deadline < test_deadline);
+
+    return *suite ? suite_deadline : test_deadline;
+}
+
+/*!
+    \brief     Проверить, истекло ли время набора тестов
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \return    \p true, если время истекло; \p false иначе
+    \protected
+*/
+static bool __ut_timeout_suite_expired(const struct __ut_test_suite_desc *test_suite_desc)
+{
+    return test_suite_desc->deadline_ns != 0 && __ut_now_ns() >= test_suite_desc->deadline_ns;
+}
+
+/*!
+    \brief     Функция сторожевого потока
+    \details   Посылает #UT_TIMEOUT_SIGNAL потокам, время тестов которых истекло.
+        Если тест не прерван за #UT_TIMEOUT_GRACE_MS (например, сигнал заблокирован
+        или поток остался ждать блокировку, захваченную прерванным тестом), то продолжать
+        выполнение нельзя - процесс завершается вызовом \p exit: стандартный вывод
+        сбрасывается, а отчет (см. #__ut_report_close) завершается
+    \param[in] arg не используется
+    \return    \p NULL
+    \protected
+*/
+static void *__ut_timeout_watchdog(void *arg)
+{
+    (void)arg;
+
+    pthread_mutex_lock(&__ut_timeout.mutex);
+    for (;;)
+    {
+        const unsigned long long now = __ut_now_ns();
+        unsigned long long next = 0;
+
+        for (struct __ut_timeout_slot *slot = __ut_timeout.slots; slot != NULL; slot = slot->next)
+        {
+            const unsigned long long deadline = slot->fired
+                ? slot->deadline_ns + UT_TIMEOUT_GRACE_MS * 1000000ull
+                : slot->deadline_ns;
+            if (deadline > now)
+            {
+                next = next == 0 || deadline < next ? deadline : next;
+                continue;
+            }
+
+            if (slot->fired)
+            {
+                char message[UT_BUFFER_SIZE];
+                const int length = snprintf(message, sizeof(message), "microut: test %s timed out and was not interrupted, exiting\n",
+                    slot->test_state != NULL ? slot->test_state->test->name : "?");
+                if (length > 0 && write(STDERR_FILENO, message, (size_t)length < sizeof(message) ? (size_t)length : sizeof(message) - 1) < 0)
+                {
+                }
+                exit(EXIT_FAILURE);
+            }
+
+            slot->fired = true;
+            pthread_kill(slot->thread, UT_TIMEOUT_SIGNAL);
+            const unsigned long long abort_at = slot->deadline_ns + UT_TIMEOUT_GRACE_MS * 1000000ull;
+            next = next == 0 || abort_at < next ? abort_at : next;
+        }
+
+        if (next == 0)
+        {
+            pthread_cond_wait(&__ut_timeout.cond, &__ut_timeout.mutex);
+            continue;
+        }
+
+        // Условная переменная ожидает по часам реального времени
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        const unsigned long long at = (unsigned long long)ts.tv_sec * 1000000000ull + (unsigned long long)ts.tv_nsec + (next - now);
+        ts.tv_sec = (time_t)(at / 1000000000ull);
+        ts.tv_nsec = (long)(at % 1000000000ull);
+        pthread_cond_timedwait(&__ut_timeout.cond, &__ut_timeout.mutex, &ts);
+    }
+
+    return NULL;
+}
+
+/*!
+    \brief     Начать наблюдение за тестом, выполняемым текущим потоком
+    \details   Сторожевой поток запускается при первом вызове
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \param[in] test_state      указатель на состояние теста
+    \protected
+*/
+static void __ut_timeout_arm(const struct __ut_test_suite_desc *test_suite_desc, const struct __ut_test_state *test_state)
+{
+    struct __ut_timeout_slot *slot = &__ut_timeout_slot;
+
+    slot->test_state = test_state;
+    slot->interrupted = false;
+    slot->after_each = false;
+    slot->deadline_ns = __ut_timeout_deadline(test_suite_desc, __ut_now_ns(), &slot->suite);
+    slot->frames_count = 0;
+    if (slot->deadline_ns == 0)
+    {
+        return;
+    }
+
+    // За временем следит зигота (см. #__ut_fork_wait)
+    if (__ut_timeout.external)
+    {
+        __atomic_store_n(&slot->armed, true, __ATOMIC_RELEASE);
+        return;
+    }
+
+    pthread_mutex_lock(&__ut_timeout.mutex);
+    if (!__ut_timeout.started)
+    {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, __ut_timeout_watchdog, NULL) == 0)
+        {
+            pthread_detach(thread);
+            __ut_timeout.started = true;
+        }
+    }
+    slot->thread = pthread_self();
+    slot->fired = false;
+    slot->next = __ut_timeout.slots;
+    __ut_timeout.slots = slot;
+    __atomic_store_n(&slot->armed, true, __ATOMIC_RELEASE);
+    pthread_cond_signal(&__ut_timeout.cond);
+    pthread_mutex_unlock(&__ut_timeout.mutex);
+}
+
+/*!
+    \brief     Продлить наблюдение за прерванным тестом на #UT_TIMEOUT_GRACE_MS
+    \details   Отводит время after each-функции прерванного теста
+    \protected
+*/
+static void __ut_timeout_extend(void)
+{
+    struct __ut_timeout_slot *slot = &__ut_timeout_slot;
+
+    if (slot->deadline_ns == 0)
+    {
+        return;
+    }
+    slot->deadline_ns = __ut_now_ns() + UT_TIMEOUT_GRACE_MS * 1000000ull;
+
+    // В изолированном запуске время after each-функции ограничивает
+    // отсрочка принудительного завершения (см. #__ut_fork_wait)
+    if (__ut_timeout.external)
+    {
+        __atomic_store_n(&slot->armed, true, __ATOMIC_RELEASE);
+        return;
+    }
+
+    pthread_mutex_lock(&__ut_timeout.mutex);
+    slot->fired = false;
+    __atomic_store_n(&slot->armed, true, __ATOMIC_RELEASE);
+    pthread_cond_signal(&__ut_timeout.cond);
+    pthread_mutex_unlock(&__ut_timeout.mutex);
+}
+
+/*!
+    \brief     Закончить наблюдение за тестом, выполняемым текущим потоком
+    \protected
+*/
+static void __ut_timeout_disarm(void)
+{
+    struct __ut_timeout_slot *slot = &__ut_timeout_slot;
+
+    if (slot->deadline_ns == 0)
+    {
+        return;
+    }
+    __atomic_store_n(&slot->armed, false, __ATOMIC_RELEASE);
+
+    if (__ut_timeout.external)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&__ut_timeout.mutex);
+    for (struct __ut_timeout_slot **link = &__ut_timeout.slots; *link != NULL; link = &(*link)->next)
+    {
+        if (*link == slot)
+        {
+            *link = slot->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&__ut_timeout.mutex);
+}
+
+/*!
+    \brief     Провалить прерванный тест
+    \details   Сообщение содержит стек вызовов теста в момент прерывания;
+        имена функций доступны при компоновке с \p -rdynamic
+    \param[in] test_state указатель на состояние теста
+    \protected
+*/
+static void __ut_timeout_fail(struct __ut_test_state *test_state)
+{
+    const struct __ut_timeout_slot *slot = &__ut_timeout_slot;
+
+#ifdef UT_ENABLE_LEAK_CHECK
+    // Блоки прерванного теста утечками не считаем: он не дошел до освобождения памяти
+    __ut_leak_end(&__ut_leak_thread_run, NULL, 0);
+#endif
+#ifdef UT_ENABLE_PERF_COUNTERS
+    // Прерванный тест не дошел до #__ut_perf_end: иначе группа считает события потока
+    // до следующего теста. Дескрипторы, унаследованные от родителя, принадлежат его группе
+    if (__ut_perf_group.count != 0 && __ut_perf_group.pid == getpid())
+    {
+        ioctl(__ut_perf_group.fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    }
+    memset(&test_state->perf_counters, 0, sizeof(test_state->perf_counters));
+#endif
+#ifdef UT_ENABLE_ALLOC_TRACKING
+    memset(&test_state->alloc_stats, 0, sizeof(test_state->alloc_stats));
+#endif
+
+    char buf[UT_BUFFER_SIZE];
+    int length = slot->suite
+        ? snprintf(buf, sizeof(buf), "test suite timed out after %llu ms", __ut_timeout.suite_ns / 1000000ull)
+        : snprintf(buf, sizeof(buf), "test timed out after %llu ms", __ut_timeout.test_ns / 1000000ull);
+
+    char **symbols = backtrace_symbols(slot->frames, slot->frames_count);
+    for (int i = __UT_TIMEOUT_HANDLER_FRAMES; i < slot->frames_count && length >= 0 && (size_t)length < sizeof(buf); ++i)
+    {
+        length += symbols != NULL
+            ? snprintf(buf + length, sizeof(buf) - (size_t)length, "; at %s", symbols[i])
+            : snprintf(buf + length, sizeof(buf) - (size_t)length, "; at %p", slot->frames[i]);
+    }
+    free(symbols);
+
+    __ut_fail_test(test_state, buf);
+}
+
+#endif  // UT_ENABLE_TIMEOUT
+
+#ifdef UT_ENABLE_FAIL_FAST
+
+//! Причина отмены тестов после #UT_MAX_FAILURES провалов
+#define __UT_FAIL_FAST_SKIP_REASON "max failures reached"
+
+/*!
+    \brief     Параметры досрочного завершения и счетчик проваленных тестов
+    \details   Слабое определение: провалы считаются по всем наборам тестов программы,
+        а параметры командной строки, разобранные в одной единице трансляции,
+        действуют на наборы тестов из других
+    \protected
+*/
+struct __ut_fail_fast_state
+{
+    bool loaded;                       //!< Флаг задания параметров (из окружения или командной строки)
+    unsigned int max_failures;         //!< Количество провалов, после которого тесты не запускаются; \p 0 - не ограничено
+    unsigned int failed_count;         //!< Количество проваленных тестов (во всех наборах тестов)
+};
+__attribute__((weak)) struct __ut_fail_fast_state __ut_fail_fast;
+
+/*!
+    \brief     Задать количество провалов, после которого тесты не запускаются
+    \param[in] max_failures количество провалов; \p 0 - не ограничено
+    \protected
+*/
+static void __ut_fail_fast_set(unsigned long max_failures)
+{
+    __ut_fail_fast.loaded = true;
+    __ut_fail_fast.max_failures = (unsigned int)max_failures;
+}
+
+/*!
+    \brief     Прочитать параметры досрочного завершения из окружения (однократно)
+    \details   Используется переменная \p UT_MAX_FAILURES; параметры командной строки
+        (см. #__ut_parse_arguments) имеют приоритет
+    \protected
+*/
+static void __ut_fail_fast_load(void)
+{
+    if (__ut_fail_fast.loaded)
+    {
+        return;
+    }
+
+    const char *value = getenv("UT_MAX_FAILURES");
+    char *end;
+    const unsigned long max_failures = value != NULL && *value != '\0' ? strtoul(value, &end, 10) : 0;
+    __ut_fail_fast_set(value != NULL && *value != '\0' && *end == '\0' ? max_failures : UT_MAX_FAILURES);
+}
+
+/*!
+    \brief     Проверить, достигнуто ли наибольшее количество провалов
+    \return    \p true, если тесты больше не запускаются; \p false иначе
+    \protected
+*/
+static inline bool __ut_fail_fast_stopped(void)
+{
+    return __ut_fail_fast.max_failures != 0
+        && __atomic_load_n(&__ut_fail_fast.failed_count, __ATOMIC_RELAXED) >= __ut_fail_fast.max_failures;
+}
+
+/*!
+    \brief     Учесть выполненный тест в счетчике провалов
+    \details   Вызывается при учете результата теста (см. #__ut_complete_test),
+        после того как возможности могли провалить тест
+    \param[in] test_state указатель на состояние выполненного теста
+    \protected
+*/
+static inline void __ut_fail_fast_count(const struct __ut_test_state *test_state)
+{
+    if (UT_IS_TEST_STARTED(test_state) && UT_IS_TEST_FAILED(test_state))
+    {
+        __atomic_add_fetch(&__ut_fail_fast.failed_count, 1, __ATOMIC_RELAXED);
+    }
+}
+
+/*!
+    \brief     Задать количество провалов, после которого оставшиеся тесты не запускаются
+    \param[in] max_failures количество провалов; \p 0 - не ограничено
+*/
+#define UT_SET_MAX_FAILURES(max_failures) __ut_fail_fast_set(max_failures)
+
+#endif  // UT_ENABLE_FAIL_FAST
+
+#ifdef UT_ENABLE_BENCH
+
+/*!
+    \brief     Выполнить один замер бенчмарка
+    \param[in] test_state указатель на состояние бенчмарка
+    \return    Длительность замера, нс
+    \protected
+*/
+static unsigned long long __ut_bench_sample(struct __ut_test_state *test_state)
+{
+    const unsigned long long started_at = __ut_now_ns();
+    test_state->test->func(test_state);
+    const unsigned long long elapsed = __ut_now_ns() - started_at;
+
+#ifdef UT_ENABLE_ASSERT_EVENTS
+    // Учитываем проверки замера до проверки успешности бенчмарка
+    __ut_assert_flush();
+#endif
+
+    return elapsed;
+}
+
+/*!
+    \brief     Сравнить два замера (для \p qsort)
+    \protected
+*/
+static int __ut_bench_compare(const void *a, const void *b)
+{
+    const double x = *(const double *)a, y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+/*!
+    \brief     Выполнить бенчмарк
+    \details   Подбирает количество итераций, выполняет прогревочные замеры,
+        затем #UT_BENCH_SAMPLES учитываемых замеров, и вычисляет статистики.
+        Прекращает работу при первой неуспешной проверке
+    \param[in] test_state указатель на состояние бенчмарка
+    \protected
+*/
+static void __ut_run_bench(struct __ut_test_state *test_state)
+{
+    struct __ut_bench_stats *stats = test_state->test->bench;
+    const unsigned long long sample_target_ns = UT_BENCH_TARGET_TIME_NS / UT_BENCH_SAMPLES;
+
+    stats->samples_count = 0;
+
+    // Подбираем количество итераций
+    stats->iterations = 1;
+    for (;;)
+    {
+        const unsigned long long elapsed = __ut_bench_sample(test_state);
+        if (!UT_IS_TEST_SUCCESSED(test_state))
+        {
+            return;
+        }
+        if (elapsed >= sample_target_ns || stats->iterations >= UT_BENCH_MAX_ITERATIONS)
+        {
+            break;
+        }
+
+        // Экстраполируем с запасом, но не более чем в 100 раз за шаг
+        unsigned long long next = elapsed > 0 ? stats->iterations * sample_target_ns * 6 / 5 / elapsed : 0;
+        if (next < stats->iterations * 2)
+        {
+            next = stats->iterations * 2;
+        }
+        if (next > stats->iterations * 100)
+        {
+            next = stats->iterations * 100;
+        }
+        stats->iterations = next < UT_BENCH_MAX_ITERATIONS ? (unsigned long)next : UT_BENCH_MAX_ITERATIONS;
+    }
+
+    // Прогреваем
+    for (unsigned int i = 0; i < UT_BENCH_WARMUP_ROUNDS; ++i)
+    {
+        __ut_bench_sample(test_state);
+        if (!UT_IS_TEST_SUCCESSED(test_state))
+        {
+            return;
+        }
+    }
+
+    // Измеряем
+    double sum = 0;
+    for (unsigned int i = 0; i < UT_BENCH_SAMPLES; ++i)
+    {
+        const unsigned long long elapsed = __ut_bench_sample(test_state);
+        if (!UT_IS_TEST_SUCCESSED(test_state))
+        {
+            return;
+        }
+
+        stats->samples[i] = (double)elapsed / stats->iterations;
+        sum += stats->samples[i];
+    }
+    stats->samples_count = UT_BENCH_SAMPLES;
+
+    // Вычисляем статистики (процентили - по ближайшему рангу)
+    qsort(stats->samples, UT_BENCH_SAMPLES, sizeof(stats->samples[0]), __ut_bench_compare);
+    stats->min = stats->samples[0];
+    stats->median = stats->samples[UT_BENCH_SAMPLES / 2];
+    stats->mean = sum / UT_BENCH_SAMPLES;
+    stats->p90 = stats->samples[(UT_BENCH_SAMPLES * 90 + 99) / 100 - 1];
+    stats->p99 = stats->samples[(UT_BENCH_SAMPLES * 99 + 99) / 100 - 1];
+    stats->max = stats->samples[UT_BENCH_SAMPLES - 1];
+}
+
+#endif  // UT_ENABLE_BENCH
+
+/*!
+    \brief     Получить количество тестов в наборе тестов
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \return    Количество тестов
+    \protected
+*/
+static unsigned int __ut_test_count(const struct __ut_test_suite_desc *test_suite_desc)
+{
+    // Зарегистрированных тестов нет
+    if (test_suite_desc->test_descs == NULL)
+    {
+        return 0;
+    }
+
+    // Границы массива известны - считать не нужно
+    if (test_suite_desc->test_descs_end != NULL)
+    {
+        return (unsigned int)(test_suite_desc->test_descs_end - test_suite_desc->test_descs);
+    }
+
+    // Иначе количество известно при компиляции; завершающий элемент не учитываем
+    unsigned int test_count = test_suite_desc->test_descs_count;
+    if (test_count > 0 && test_suite_desc->test_descs[test_count - 1].func == NULL)
+    {
+        --test_count;
+    }
+
+    return test_count;
+}
+
+/*!
+    \brief     Подготовить состояния тестов набора
+    \details   Связывает состояния со структурами тестов. Для набора тестов
+        без статического массива состояний (#UT_REGISTER_TEST_SUITE) массив
+        выделяется при первом запуске
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \return    \p false, если не удалось выделить память; \p true иначе
+    \protected
+*/
+static bool __ut_prepare_test_states(struct __ut_test_suite_desc *test_suite_desc)
+{
+    const unsigned int test_count = __ut_test_count(test_suite_desc);
+
+    if (test_suite_desc->test_states == NULL && test_count > 0)
+    {
+#ifdef UT_ENABLE_AUTO_REGISTRATION
+        struct __ut_test_state *test_states = (struct __ut_test_state *)aligned_alloc(
+            __alignof__(struct __ut_test_state), test_count * sizeof(struct __ut_test_state));
+        if (test_states == NULL)
+        {
+            return false;
+        }
+        memset(test_states, 0, test_count * sizeof(struct __ut_test_state));
+        test_suite_desc->test_states = test_states;
+#else
+        return false;
+#endif
+    }
+
+    for (unsigned int i = 0; i < test_count; ++i)
+    {
+        test_suite_desc->test_states[i].test = &(test_suite_desc->test_descs[i]);
+    }
+
+    return true;
+}
+
+/*!
+    \name      Шаги возможностей в функциях запуска
+    \details   Функции запуска тестов вызывают возможности только через эти функции.
+        Шаг отключенной возможности не выполняет действий и удаляется компилятором
+    @{
+*/
+
+/*!
+    \brief     Отметки возможностей, снятые перед вызовом функции
+    \details   Хранит между парными шагами (\p begin / \p end) то, что
+        возможности запоминают перед вызовом функции набора тестов или теста
+    \protected
+*/
+struct __ut_features_mark
+{
+#ifdef UT_ENABLE_RUSAGE
+    struct __ut_usage_mark usage;         //!< Отметка потребления ресурсов
+#endif
+#ifdef UT_ENABLE_ALLOC_TRACKING
+    struct __ut_alloc_stats alloc;        //!< Счетчики выделений памяти потока
+#endif
+#ifdef UT_ENABLE_LEAK_CHECK
+    struct __ut_leak_run *leak_run;       //!< Отслеживаемые блоки теста; \p NULL - не отслеживаются
+#endif
+#ifdef UT_ENABLE_PERF_COUNTERS
+    struct __ut_perf_group *perf_group;   //!< Группа аппаратных счетчиков
+#endif
+};
+
+/*!
+    \brief     Прочитать параметры возможностей
+    \details   Вызывается до запуска рабочих потоков
+    \protected
+*/
+static inline void __ut_features_load(void)
+{
+#ifdef UT_ENABLE_SHARDING
+    __ut_shard_load();
+#endif
+#ifdef UT_ENABLE_FILTER
+    __ut_filter_load();
+#endif
+#ifdef UT_ENABLE_TIMEOUT
+    __ut_timeout_load();
+#endif
+#ifdef UT_ENABLE_FAIL_FAST
+    __ut_fail_fast_load();
+#endif
+#ifdef UT_ENABLE_FAILED_FIRST
+    __ut_failed_load();
+#endif
+#ifdef UT_ENABLE_REPORTER
+    __ut_report_load();
+#endif
+#ifdef UT_ENABLE_PROPERTY
+    __ut_prop_load();
+#endif
+#ifdef UT_ENABLE_FUZZ
+    __ut_fuzz_load();
+#endif
+#ifdef UT_ENABLE_LEAK_CHECK
+    __ut_leak_load();
+#endif
+#ifdef UT_ENABLE_ASSERT_EVENTS
+    __ut_assert_events_start();
+#endif
+}
+
+/*!
+    \brief     Проверить, выбран ли тест возможностями выбора тестов
+    \param[in]  test_suite_desc указатель на структуру набора тестов
+    \param[in]  test           указатель на структуру теста
+    \param[out] skip_reason    причина отмены запуска; не изменяется, если тест исключен фильтром
+    \return    \p true, если тест нужно выполнить; \p false иначе
+    \protected
+*/
+static inline bool __ut_features_select(const struct __ut_test_suite_desc *test_suite_desc,
+                                        const struct __ut_test_desc *test, const char **skip_reason)
+{
+    bool selected = true;
+    // Не используются, если выбор тестов отключен
+    (void)test_suite_desc;
+    (void)test;
+    (void)skip_reason;
+
+#ifdef UT_ENABLE_SHARDING
+    selected = selected && __ut_shard_contains(test_suite_desc, test);
+#endif
+#ifdef UT_ENABLE_FILTER
+    selected = selected && __ut_filter_matches(test_suite_desc, test);
+#endif
+#ifdef UT_ENABLE_FAILED_FIRST
+    selected = selected && __ut_failed_selected(test_suite_desc, test);
+#endif
+#ifdef UT_ENABLE_TIMEOUT
+    // После истечения времени набора тестов оставшиеся тесты не запускаются
+    if (selected && __ut_timeout_suite_expired(test_suite_desc))
+    {
+        selected = false;
+        *skip_reason = "test suite timed out";
+    }
+#endif
+#ifdef UT_ENABLE_FAIL_FAST
+    // После #UT_MAX_FAILURES провалов оставшиеся тесты не запускаются
+    if (selected && __ut_fail_fast_stopped())
+    {
+        selected = false;
+        *skip_reason = __UT_FAIL_FAST_SKIP_REASON;
+    }
+#endif
+
+    return selected;
+}
+
+/*!
+    \brief     Начать набор тестов в возможностях
+    \param[in]  test_suite_desc указатель на структуру набора тестов
+    \param[out] mark           отметки для #__ut_features_startup_end
+    \protected
+*/
+static inline void __ut_features_startup_begin(const struct __ut_test_suite_desc *test_suite_desc,
+                                               struct __ut_features_mark *mark)
+{
+    (void)test_suite_desc;
+    (void)mark;
+
+#ifdef UT_ENABLE_REPORTER
+    __ut_report_suite_begin(test_suite_desc->name, __ut_test_count(test_suite_desc));
+#endif
+#ifdef UT_ENABLE_RUSAGE
+    __ut_usage_begin(&mark->usage);
+#endif
+}
+
+/*!
+    \brief     Учесть в возможностях завершение startup-функции
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \param[in] mark            отметки #__ut_features_startup_begin
+    \protected
+*/
+static inline void __ut_features_startup_end(struct __ut_test_suite_desc *test_suite_desc,
+                                             struct __ut_features_mark *mark)
+{
+    (void)test_suite_desc;
+    (void)mark;
+
+#ifdef UT_ENABLE_RUSAGE
+    __ut_usage_end(&mark->usage, &test_suite_desc->startup_usage);
+#endif
+#ifdef UT_ENABLE_TIMEOUT
+    // Время набора тестов отсчитывается от завершения startup-функции
+    test_suite_desc->deadline_ns = __ut_timeout.suite_ns != 0 ? __ut_now_ns() + __ut_timeout.suite_ns : 0;
+#endif
+#ifdef UT_ENABLE_REPORTER
+    // Набор тестов с проваленной startup-функцией не завершается - завершаем его в отчете
+    if (!UT_IS_TEST_SUITE_SUCCESSED(test_suite_desc))
+    {
+        __ut_report_test(test_suite_desc, NULL);
+        __ut_report_suite_end(test_suite_desc->name);
+    }
+#endif
+}
+
+/*!
+    \brief     Подготовить возможности к выполнению теста
+    \param[in]  test_state указатель на состояние теста
+    \param[out] mark       отметки для #__ut_features_run_end
+    \protected
+*/
+static inline void __ut_features_run_begin(struct __ut_test_state *test_state, struct __ut_features_mark *mark)
+{
+    (void)test_state;
+    (void)mark;
+
+#ifdef UT_ENABLE_RUSAGE
+    __ut_usage_begin(&mark->usage);
+#endif
+#ifdef UT_ENABLE_ARENA
+    test_state->arena = &__ut_arena;
+#endif
+#ifdef UT_ENABLE_REPORTER
+    test_state->failure_message = NULL;
+    __ut_report_current = test_state;
+#endif
+}
+
+/*!
+    \brief     Учесть в возможностях завершение теста
+    \param[in] test_state указатель на состояние теста
+    \param[in] mark       отметки #__ut_features_run_begin
+    \protected
+*/
+static inline void __ut_features_run_end(struct __ut_test_state *test_state, struct __ut_features_mark *mark)
+{
+    (void)test_state;
+    (void)mark;
+
+#ifdef UT_ENABLE_ARENA
+    // Освобождаем память, выделенную тестом в арене
+    test_state->arena = NULL;
+    __ut_arena_reset(&__ut_arena);
+#endif
+#ifdef UT_ENABLE_REPORTER
+    __ut_report_current = NULL;
+#endif
+#ifdef UT_ENABLE_RUSAGE
+    __ut_usage_end(&mark->usage, &test_state->usage);
+#endif
+}
+
+/*!
+    \brief     Учесть проверки, сделанные с момента предыдущего вызова
+    \details   Вызывается после каждой функции теста, до проверки его успешности
+    \protected
+*/
+static inline void __ut_features_flush(void)
+{
+#ifdef UT_ENABLE_ASSERT_EVENTS
+    __ut_assert_flush();
+#endif
+}
+
+/*!
+    \brief     Начать замеры возможностей перед функцией теста
+    \param[out] mark отметки для #__ut_features_test_end и #__ut_features_after_each
+    \protected
+*/
+static inline void __ut_features_test_begin(struct __ut_features_mark *mark)
+{
+    (void)mark;
+
+#ifdef UT_ENABLE_ALLOC_TRACKING
+    mark->alloc = __ut_alloc_thread_stats;
+#endif
+#ifdef UT_ENABLE_LEAK_CHECK
+    mark->leak_run = __ut_leak_begin();
+#endif
+#ifdef UT_ENABLE_PERF_COUNTERS
+    mark->perf_group = __ut_perf_begin();
+#endif
+}
+
+/*!
+    \brief     Вызвать функцию теста
+    \details   Бенчмарк вызывается многократно, с замером времени
+    \param[in] test_state указатель на состояние теста
+    \protected
+*/
+static inline void __ut_features_test_call(struct __ut_test_state *test_state)
+{
+#ifdef UT_ENABLE_BENCH
+    if (test_state->test->bench != NULL)
+    {
+        __ut_run_bench(test_state);
+        return;
+    }
+#endif
+
+    test_state->test->func(test_state);
+}
+
+/*!
+    \brief     Завершить замеры возможностей после функции теста
+    \param[in] test_state указатель на состояние теста
+    \param[in] mark       отметки #__ut_features_test_begin
+    \protected
+*/
+static inline void __ut_features_test_end(struct __ut_test_state *test_state, struct __ut_features_mark *mark)
+{
+    (void)test_state;
+    (void)mark;
+
+#ifdef UT_ENABLE_PERF_COUNTERS
+    __ut_perf_end(mark->perf_group, &test_state->perf_counters);
+#endif
+#ifdef UT_ENABLE_ALLOC_TRACKING
+    test_state->alloc_stats = __ut_alloc_since(mark->alloc);
+#endif
+}
+
+/*!
+    \brief     Сбросить замеры возможностей теста, функция которого не вызывалась
+    \param[in]  test_state указатель на состояние теста
+    \param[out] mark       отметки для #__ut_features_after_each
+    \protected
+*/
+static inline void __ut_features_test_not_called(struct __ut_test_state *test_state, struct __ut_features_mark *mark)
+{
+    (void)test_state;
+    (void)mark;
+
+#ifdef UT_ENABLE_LEAK_CHECK
+    mark->leak_run = NULL;
+#endif
+#ifdef UT_ENABLE_PERF_COUNTERS
+    memset(&test_state->perf_counters, 0, sizeof(test_state->perf_counters));
+#endif
+#ifdef UT_ENABLE_ALLOC_TRACKING
+    memset(&test_state->alloc_stats, 0, sizeof(test_state->alloc_stats));
+#endif
+}
+
+/*!
+    \brief     Учесть в возможностях запуск after each-функции
+    \protected
+*/
+static inline void __ut_features_after_each_begin(void)
+{
+#ifdef UT_ENABLE_TIMEOUT
+    // Прерывание after each-функции не должно запускать ее повторно
+    __ut_timeout_slot.after_each = true;
+#endif
+}
+
+/*!
+    \brief     Учесть в возможностях завершение after each-функции
+    \param[in] test_state указатель на состояние теста
+    \param[in] mark       отметки #__ut_features_test_begin
+    \protected
+*/
+static inline void __ut_features_after_each(struct __ut_test_state *test_state, struct __ut_features_mark *mark)
+{
+    (void)test_state;
+    (void)mark;
+
+#ifdef UT_ENABLE_LEAK_CHECK
+    // Блоки, выделенные функцией теста и не освобожденные к концу after each-функции, - утечки.
+    // Утечки проваленного теста не сообщаем: он мог не дойти до освобождения памяти
+    if (mark->leak_run != NULL)
+    {
+        const bool successed = UT_IS_TEST_SUCCESSED(test_state);
+        char buf[UT_BUFFER_SIZE];
+
+        if (__ut_leak_end(mark->leak_run, successed ? buf : NULL, sizeof(buf)) && successed)
+        {
+            __ut_fail_test(test_state, buf);
+        }
+        // Без перехвата распределителя утечки не видны - не считаем тест успешным
+        else if (successed && !__ut_alloc_active())
+        {
+            __ut_fail_test(test_state, "leak check" __UT_ALLOC_INACTIVE_MESSAGE);
+        }
+    }
+#endif
+}
+
+/*!
+    \brief     Сообщить возможностям результат теста
+    \details   Вызывается для отмененного теста и для учтенного в наборе тестов
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \param[in] test_state      указатель на состояние теста
+    \protected
+*/
+static inline void __ut_features_report(const struct __ut_test_suite_desc *test_suite_desc,
+                                        const struct __ut_test_state *test_state)
+{
+    (void)test_suite_desc;
+    (void)test_state;
+
+#ifdef UT_ENABLE_REPORTER
+    __ut_report_test(test_suite_desc, test_state);
+#endif
+}
+
+/*!
+    \brief     Сообщить возможностям о выполненном тесте
+    \details   Вызывается до учета теста в наборе тестов, поэтому возможности
+        могут провалить тест (например, при превышении базовой линии)
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \param[in] test_state      указатель на состояние теста
+    \protected
+*/
+static inline void __ut_features_performed(const struct __ut_test_suite_desc *test_suite_desc,
+                                           struct __ut_test_state *test_state)
+{
+    (void)test_suite_desc;
+    (void)test_state;
+
+#ifdef UT_ENABLE_BASELINE
+    // Сравниваем длительность теста с базовой линией
+    __ut_baseline_check(test_suite_desc, test_state);
+#endif
+#ifdef UT_ENABLE_RUSAGE
+    UT_ON_TEST_USAGE(test_state, &test_state->usage);
+#endif
+#ifdef UT_ENABLE_PERF_COUNTERS
+    UT_ON_TEST_PERF_COUNTERS(test_state, &test_state->perf_counters);
+#endif
+#ifdef UT_ENABLE_ALLOC_TRACKING
+    UT_ON_TEST_ALLOC_STATS(test_state, &test_state->alloc_stats);
+#endif
+}
+
+/*!
+    \brief     Выполнить обработчик успешного теста
+    \param[in] test_state указатель на состояние теста
+    \protected
+*/
+static inline void __ut_features_successful(const struct __ut_test_state *test_state)
+{
+#ifdef UT_ENABLE_BENCH
+    if (test_state->test->bench != NULL)
+    {
+        UT_ON_SUCCESSFUL_BENCH(test_state);
+        return;
+    }
+#endif
+
+    UT_ON_SUCCESSFUL_TEST(test_state);
+}
+
+/*!
+    \brief     Начать замеры возможностей перед teardown-функцией
+    \param[out] mark отметки для #__ut_features_teardown_end
+    \protected
+*/
+static inline void __ut_features_teardown_begin(struct __ut_features_mark *mark)
+{
+    (void)mark;
+
+#ifdef UT_ENABLE_RUSAGE
+    __ut_usage_begin(&mark->usage);
+#endif
+}
+
+/*!
+    \brief     Завершить набор тестов в возможностях
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \param[in] mark            отметки #__ut_features_teardown_begin
+    \protected
+*/
+static inline void __ut_features_teardown_end(struct __ut_test_suite_desc *test_suite_desc,
+                                              struct __ut_features_mark *mark)
+{
+    (void)test_suite_desc;
+    (void)mark;
+
+#ifdef UT_ENABLE_RUSAGE
+    __ut_usage_end(&mark->usage, &test_suite_desc->teardown_usage);
+    UT_ON_TEST_SUITE_USAGE(test_suite_desc, &test_suite_desc->startup_usage, &test_suite_desc->teardown_usage);
+#endif
+#ifdef UT_ENABLE_FAILED_FIRST
+    // Запоминаем проваленные тесты для повторного запуска
+    __ut_failed_update(test_suite_desc, __ut_test_count(test_suite_desc));
+#endif
+#ifdef UT_ENABLE_BASELINE
+    // Дополняем базовую линию производительности
+    __ut_baseline_update(test_suite_desc, __ut_test_count(test_suite_desc));
+#endif
+#ifdef UT_ENABLE_REPORTER
+    __ut_report_suite_end(test_suite_desc->name);
+#endif
+}
+
+//! @}
+
+/*!
+    \brief     Проверить, нужно ли выполнять тест
+    \details   Невыполняемый тест объявляется незапущенным (см. #UT_IS_TEST_SKIPPED)
+        и не учитывается в наборе тестов. Если запуск теста отменен (а не исключен
+        фильтром), то причина сохраняется в поле \p skip_reason
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \param[in] test_state      указатель на состояние теста
+    \return    \p true, если тест нужно выполнить; \p false иначе
+    \protected
+*/
+static bool __ut_select_test(const struct __ut_test_suite_desc *test_suite_desc, struct __ut_test_state *test_state)
+{
+    const char *skip_reason = NULL;
+    const bool selected = __ut_features_select(test_suite_desc, test_state->test, &skip_reason);
+
+    test_state->skip_reason = skip_reason;
+    if (!selected)
+    {
+        test_state->started = false;
+        test_state->successed_count = test_state->performed_count = 0;
+    }
+
+    return selected;
+}
+
+/*!
+    \brief     Начать выполнение набора тестов
+    \details   Объявляет набор тестов запущенным и вызывает его startup-функцию
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \return    \p true, если startup-функция не содержала неуспешных проверок; \p false иначе
+    \protected
+*/
+static bool __ut_start_test_suite(struct __ut_test_suite_desc *test_suite_desc)
+{
+    struct __ut_features_mark mark;
+
+    // Читаем параметры возможностей до запуска рабочих потоков
+    __ut_features_load();
+
+    // Связываем состояния тестов со структурами тестов
+    if (!__ut_prepare_test_states(test_suite_desc))
+    {
+        return false;
+    }
+
+    // \name Объявляем набор тестов запущенным
+    // @{
+    test_suite_desc->started = true;
+    test_suite_desc->successed_count = test_suite_desc->performed_count = 0;
+    // @}
+
+    // Вызываем startup-функцию
+    __ut_features_startup_begin(test_suite_desc, &mark);
+    test_suite_desc->startup(test_suite_desc);
+    __ut_features_startup_end(test_suite_desc, &mark);
+
+    return UT_IS_TEST_SUITE_SUCCESSED(test_suite_desc);
+}
+
+/*!
+    \brief     Вызвать функции теста
+    \details   Вызывает последовательность before each-функция, функция теста
+        (или серия замеров бенчмарка), after each-функция
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \param[in] test_state      указатель на состояние теста
+    \protected
+*/
+static void __ut_call_test(const struct __ut_test_suite_desc *test_suite_desc, struct __ut_test_state *test_state)
+{
+    struct __ut_features_mark mark;
+
+    // Запускаем before each-функцию
+    test_suite_desc->before_each(test_state);
+    __ut_features_flush();
+    // Если в ходе ее выполнения не было неуспешных проверки, то продолжаем выполнение теста
+    if (UT_IS_TEST_SUCCESSED(test_state))
+    {
+        // Запускаем функцию теста
+        __ut_features_test_begin(&mark);
+        __ut_features_test_call(test_state);
+        __ut_features_test_end(test_state, &mark);
+    }
+    else
+    {
+        __ut_features_test_not_called(test_state, &mark);
+    }
+
+    // Запускаем after each-функцию
+    __ut_features_after_each_begin();
+    test_suite_desc->after_each(test_state);
+    __ut_features_flush();
+    __ut_features_after_each(test_state, &mark);
+}
+
+#ifdef UT_ENABLE_TIMEOUT
+
+/*!
+    \brief     Вызвать функции теста с ограничением времени
+    \details   Тест, превысивший отведенное время, прерывается сигналом (см. #__ut_timeout_handler)
+        и проваливается. Если after each-функция прерванного теста еще не запускалась,
+        то она вызывается, и на нее отводится #UT_TIMEOUT_GRACE_MS
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \param[in] test_state      указатель на состояние теста
+    \protected
+*/
+static inline void __ut_features_call_test(const struct __ut_test_suite_desc *test_suite_desc,
+                                           struct __ut_test_state *test_state)
+{
+    struct __ut_timeout_slot *slot = &__ut_timeout_slot;
+
+    if (sigsetjmp(slot->env, 1) == 0)
+    {
+        __ut_timeout_arm(test_suite_desc, test_state);
+        __ut_call_test(test_suite_desc, test_state);
+    }
+    else if (slot->interrupted)
+    {
+        // Прервана after each-функция, запущенная после прерывания теста
+        __ut_features_flush();
+        __ut_fail_test(test_state, "after each function of the timed out test timed out");
+    }
+    else
+    {
+        slot->interrupted = true;
+        // Учитываем проверки прерванного теста до его провала
+        __ut_features_flush();
+#if defined(UT_ENABLE_PROPERTY) || defined(UT_ENABLE_FUZZ)
+        // Прерванное свойство или цель фаззинга могли отключить обработчики проверок
+        __ut_assert_muted = false;
+#endif
+#ifdef UT_ENABLE_FUZZ
+        __ut_fuzz_abandon(test_state);
+#endif
+        __ut_timeout_fail(test_state);
+
+        // Освобождаем ресурсы, захваченные before each-функцией
+        if (!slot->after_each)
+        {
+            slot->after_each = true;
+            __ut_timeout_extend();
+            test_suite_desc->after_each(test_state);
+            __ut_features_flush();
+        }
+    }
+    __ut_timeout_disarm();
+}
+
+#else
+
+/*!
+    \brief     Вызвать функции теста
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \param[in] test_state      указатель на состояние теста
+    \protected
+*/
+static inline void __ut_features_call_test(const struct __ut_test_suite_desc *test_suite_desc,
+                                           struct __ut_test_state *test_state)
+{
+    __ut_call_test(test_suite_desc, test_state);
+}
+
+#endif  // UT_ENABLE_TIMEOUT
+
+/*!
+    \brief     Выполнить тест
+    \details   Вызывает последовательность before each-функция, функция теста,
+        after each-функция (если тест выбран для выполнения, см. #__ut_select_test). Изменяет только состояние самого теста, поэтому
+        может вызываться одновременно для разных тестов из разных потоков.
+        Тест, превысивший отведенное время (#UT_TEST_TIMEOUT_MS, #UT_TEST_SUITE_TIMEOUT_MS),
+        прерывается и проваливается с указанием стека вызовов, см. #__ut_timeout_arm
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \param[in] test_state      указатель на состояние теста
+    \warning   Прерванный тест не завершает работу: after each-функция вызывается, но ресурсы,
+        захваченные самой функцией теста (например, блокировки), не освобождаются. Внутри
+        перехватчиков распределителя (#UT_ENABLE_ALLOC_TRACKING) прерывание откладывается;
+        тест, прерванный внутри распределителя без них или внутри вывода \p stdio,
+        может оставить захваченной блокировку библиотеки C; если поток из-за нее зависает,
+        то процесс завершается с сохранением результатов, см. #__ut_timeout_watchdog
+    \protected
+*/
+static void __ut_run_test(const struct __ut_test_suite_desc *test_suite_desc, struct __ut_test_state *test_state)
+{
+    struct __ut_features_mark mark;
+
+    // Невыбранный тест пропускаем
+    if (!__ut_select_test(test_suite_desc, test_state))
+    {
+        return;
+    }
+
+    // \name Объявляем тест запущенным
+    // @{
+    test_state->started = true;
+    test_state->successed_count = test_state->performed_count = 0;
+    // @}
+
+    __ut_features_run_begin(test_state, &mark);
+    __ut_features_call_test(test_suite_desc, test_state);
+    __ut_features_run_end(test_state, &mark);
+}
+
+/*!
+    \brief     Учесть результат выполненного теста
+    \details   Обновляет счетчики набора тестов и вызывает обработчик
+        #UT_ON_SUCCESSFUL_TEST или #UT_ON_FAILED_TEST
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \param[in] test_state      указатель на состояние выполненного теста
+    \protected
+*/
+static void __ut_complete_test(struct __ut_test_suite_desc *test_suite_desc, struct __ut_test_state *test_state)
+{
+    // Пропущенный тест не учитываем; об отмененном тесте сообщаем
+    if (UT_IS_TEST_SKIPPED(test_state))
+    {
+        if (test_state->skip_reason != NULL)
+        {
+            UT_ON_SKIPPED_TEST(test_state, test_state->skip_reason);
+            __ut_features_report(test_suite_desc, test_state);
+        }
+        return;
+    }
+
+    __ut_features_performed(test_suite_desc, test_state);
+#ifdef UT_ENABLE_FAIL_FAST
+    // Учитываем и провалы, зафиксированные возможностями (например, базовой линией)
+    __ut_fail_fast_count(test_state);
+#endif
+
+    // Объявляем (в наборе тестов) тест запущенным
+    ++test_suite_desc->performed_count;
+
+    // Если тест был успешен, то помечаем этот факт в наборе тестов
+    // Выполняем обработчик успехов
+    if (UT_IS_TEST_SUCCESSED(test_state))
+    {
+        ++test_suite_desc->successed_count;
+        __ut_features_successful(test_state);
+    }
+    // Иначе выполняем обработчик неудач
+    else
+    {
+        UT_ON_FAILED_TEST(test_state);
+    }
+
+    __ut_features_report(test_suite_desc, test_state);
+}
+
+/*!
+    \brief     Завершить выполнение набора тестов
+    \details   Вызывает teardown-функцию набора тестов
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \return    Флаг успешного выполнения набора тестов
+    \protected
+*/
+static bool __ut_finish_test_suite(struct __ut_test_suite_desc *test_suite_desc)
+{
+    struct __ut_features_mark mark;
+
+    // Запускаем teardown-функцию набора тестов
+    __ut_features_teardown_begin(&mark);
+    test_suite_desc->teardown(test_suite_desc);
+    __ut_features_teardown_end(test_suite_desc, &mark);
+
+    // Возвращаем флаг успешности набора тестов
+    return UT_IS_TEST_SUITE_SUCCESSED(test_suite_desc);
+}
+
+/*!
+    \brief     Запустить набор тестов
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \return    Флаг успешного выполнения набора тестов
+    \protected
+*/
+static inline bool __ut_run_test_suite(struct __ut_test_suite_desc *test_suite_desc)
+{
+    // Вызываем startup-функцию
+    // Если в ходе ее выполнения были неуспешные проверки, то прерываем выполнение набора тестов
+    if (!__ut_start_test_suite(test_suite_desc))
+    {
+        return false;
+    }
+
+    // Запускаем тесты
+    const unsigned int test_count = __ut_test_count(test_suite_desc);
+#ifdef UT_ENABLE_FAILED_FIRST
+    // Ранее проваленные тесты выполняем первыми
+    unsigned int *order = __ut_failed_order(test_suite_desc, test_count, NULL);
+#endif
+    for (unsigned int i = 0; i < test_count; ++i)
+    {
+        // Получаем указатель на состояние теста
+#ifdef UT_ENABLE_FAILED_FIRST
+        struct __ut_test_state *test_state = &(test_suite_desc->test_states[order != NULL ? order[i] : i]);
+#else
+        struct __ut_test_state *test_state = &(test_suite_desc->test_states[i]);
+#endif
+
+        __ut_run_test(test_suite_desc, test_state);
+        __ut_complete_test(test_suite_desc, test_state);
+    }
+#ifdef UT_ENABLE_FAILED_FIRST
+    free(order);
+#endif
+
+    return __ut_finish_test_suite(test_suite_desc);
+}
+
+/*!
+    \brief     Запустить набор тестов
+    \param[in] test_suite набор тестов
+*/
+#define UT_RUN_TEST_SUITE(test_suite) __ut_run_test_suite(&test_suite##_desc)
+
+
+#ifdef UT_ENABLE_PARALLEL
+
+/*!
+    \brief     Состояние параллельного запуска набора тестов
+    \protected
+*/
+struct __ut_parallel_run
+{
+    const struct __ut_test_suite_desc *test_suite_desc;    //!< Указатель на структуру набора тестов
+    unsigned int test_count;                               //!< Количество тестов в наборе
+    unsigned int next;                                     //!< Номер следующего теста для выдачи потоку
+    const unsigned int *order;                             //!< Индексы тестов в порядке выдачи; \p NULL - в порядке объявления
+    bool *completed;                                       //!< Массив флагов завершения тестов
+    pthread_mutex_t mutex;                                 //!< Мьютекс, защищающий \p completed
+    pthread_cond_t cond;                                   //!< Условие завершения очередного теста
+};
+
+/*!
+    \brief     Функция рабочего потока параллельного запуска
+    \details   Забирает тесты по одному, пока они не закончатся, и выполняет их
+    \param[in] arg указатель на структуру #__ut_parallel_run
+    \return    \p NULL
+    \protected
+*/
+static void *__ut_parallel_worker(void *arg)
+{
+    struct __ut_parallel_run *run = (struct __ut_parallel_run *)arg;
+
+    for (;;)
+    {
+        // Забираем следующий тест
+        const unsigned int n = __atomic_fetch_add(&run->next, 1, __ATOMIC_RELAXED);
+        if (n >= run->test_count)
+        {
+            break;
+        }
+        const unsigned int i = run->order != NULL ? run->order[n] : n;
+
+#ifdef UT_ENABLE_BENCH
+        // Бенчмарки выполняет вызывающий поток, после остановки рабочих потоков
+        if (run->test_suite_desc->test_descs[i].bench != NULL)
+        {
+            continue;
+        }
+#endif
+
+        __ut_run_test(run->test_suite_desc, &(run->test_suite_desc->test_states[i]));
+
+        // Сообщаем о завершении теста
+        pthread_mutex_lock(&run->mutex);
+        run->completed[i] = true;
+        pthread_cond_broadcast(&run->cond);
+        pthread_mutex_unlock(&run->mutex);
+    }
+
+    return NULL;
+}
+
+/*!
+    \brief     Запустить набор тестов последовательно вместо параллельного исполнителя
+    \details   Как и параллельный исполнитель, обновляет кэш длительностей тестов
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \param[in] test_count      количество тестов в наборе
+    \return    Флаг успешного выполнения набора тестов
+    \protected
+*/
+static inline bool __ut_run_test_suite_serial(struct __ut_test_suite_desc *test_suite_desc, unsigned int test_count)
+{
+    const bool successed = __ut_run_test_suite(test_suite_desc);
+
+#ifdef UT_ENABLE_TIMING_CACHE
+    if (test_suite_desc->test_states != NULL)
+    {
+        __ut_timing_cache_update(test_suite_desc, test_count);
+    }
+#else
+    (void)test_count;
+#endif
+
+    return successed;
+}
+
+/*!
+    \brief     Запустить набор тестов параллельно
+    \details   Тесты выполняются пулом из \p n_threads рабочих потоков.
+        Счетчики набора тестов обновляются, а обработчики #UT_ON_SUCCESSFUL_TEST
+        и #UT_ON_FAILED_TEST вызываются только из вызывающего потока,
+        строго в порядке объявления тестов, по мере их завершения.
+        Функции startup и teardown выполняются в вызывающем потоке
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \param[in] n_threads       количество рабочих потоков;
+        \p 0 - по количеству доступных процессоров
+    \return    Флаг успешного выполнения набора тестов
+    \warning   Тесты набора, before each- и after each-функции должны допускать
+        одновременное выполнение
+    \protected
+*/
+static inline bool __ut_run_test_suite_parallel(struct __ut_test_suite_desc *test_suite_desc, unsigned int n_threads)
+{
+    const unsigned int test_count = __ut_test_count(test_suite_desc);
+
+    if (n_threads == 0)
+    {
+        const long n_processors = sysconf(_SC_NPROCESSORS_ONLN);
+        n_threads = n_processors > 0 ? (unsigned int)n_processors : 1;
+    }
+    if (n_threads > test_count)
+    {
+        n_threads = test_count;
+    }
+
+    // Параллелить нечего - запускаем набор тестов последовательно
+    if (n_threads <= 1)
+    {
+        return __ut_run_test_suite_serial(test_suite_desc, test_count);
+    }
+
+    struct __ut_parallel_run run = {
+        test_suite_desc, test_count, 0, NULL,
+        (bool *)calloc(test_count, sizeof(bool)),
+        PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER
+    };
+    pthread_t *threads = (pthread_t *)malloc(n_threads * sizeof(pthread_t));
+    if (run.completed == NULL || threads == NULL)
+    {
+        free(run.completed);
+        free(threads);
+        return __ut_run_test_suite_serial(test_suite_desc, test_count);
+    }
+
+    if (!__ut_start_test_suite(test_suite_desc))
+    {
+        free(run.completed);
+        free(threads);
+        return false;
+    }
+
+    unsigned int *order = NULL;
+#ifdef UT_ENABLE_TIMING_CACHE
+    // Упорядочиваем тесты по убыванию длительности в прошлых запусках
+    order = (unsigned int *)malloc(test_count * sizeof(unsigned int));
+    if (order != NULL)
+    {
+        __ut_timing_order(test_suite_desc, test_count, order);
+    }
+#endif
+#ifdef UT_ENABLE_FAILED_FIRST
+    // Ранее проваленные тесты выдаем первыми
+    order = __ut_failed_order(test_suite_desc, test_count, order);
+#endif
+    run.order = order;
+
+    // Запускаем рабочие потоки
+    unsigned int started_count = 0;
+    for (unsigned int i = 0; i < n_threads; ++i)
+    {
+        if (pthread_create(&threads[started_count], NULL, __ut_parallel_worker, &run) == 0)
+        {
+            ++started_count;
+        }
+    }
+    // Если не удалось запустить ни одного потока, то выполняем тесты сами
+    if (started_count == 0)
+    {
+        __ut_parallel_worker(&run);
+    }
+
+    // Учитываем результаты в порядке объявления тестов
+    for (unsigned int i = 0; i < test_count; ++i)
+    {
+#ifdef UT_ENABLE_BENCH
+        // Бенчмарк выполняем в одиночку, чтобы соседние тесты не искажали замеры
+        if (test_suite_desc->test_descs[i].bench != NULL)
+        {
+            for (; started_count > 0; --started_count)
+            {
+                pthread_join(threads[started_count - 1], NULL);
+            }
+
+            __ut_run_test(test_suite_desc, &(test_suite_desc->test_states[i]));
+            __ut_complete_test(test_suite_desc, &(test_suite_desc->test_states[i]));
+            continue;
+        }
+#endif
+
+        pthread_mutex_lock(&run.mutex);
+        while (!run.completed[i])
+        {
+            pthread_cond_wait(&run.cond, &run.mutex);
+        }
+        pthread_mutex_unlock(&run.mutex);
+
+        __ut_complete_test(test_suite_desc, &(test_suite_desc->test_states[i]));
+    }
+
+    for (unsigned int i = 0; i < started_count; ++i)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&run.cond);
+    pthread_mutex_destroy(&run.mutex);
+    free(run.completed);
+    free(threads);
+    free(order);
+
+#ifdef UT_ENABLE_TIMING_CACHE
+    // Сохраняем длительности тестов для планирования следующих запусков
+    __ut_timing_cache_update(test_suite_desc, test_count);
+#endif
+
+    return __ut_finish_test_suite(test_suite_desc);
+}
+
+/*!
+    \brief     Запустить набор тестов параллельно
+    \param[in] test_suite набор тестов
+    \param[in] n_threads  количество рабочих потоков; \p 0 - по количеству доступных процессоров
+    \see       __ut_run_test_suite_parallel
+*/
+#define UT_RUN_TEST_SUITE_PARALLEL(test_suite, n_threads) __ut_run_test_suite_parallel(&test_suite##_desc, (n_threads))
+
+#endif  // UT_ENABLE_PARALLEL
+
+
+#ifdef UT_ENABLE_FORK
+
+/*!
+    \brief     Результат теста, выполненного в дочернем процессе
+    \protected
+*/
+struct __ut_fork_result
+{
+    bool finished;                     //!< Флаг наличия результата
+    bool started;                      //!< Флаг старта теста
+    bool crashed;                      //!< Флаг аварийного завершения процесса во время теста
+#ifdef UT_ENABLE_TIMEOUT
+    bool timed_out;                    //!< Флаг принудительного завершения процесса, не прервавшего тест по истечении времени
+#endif
+    int signal;                        //!< Номер сигнала, аварийно завершившего процесс теста
+    int exit_code;                     //!< Код завершения процесса, прерванного во время теста; \p -1, если процесс не был создан
+    unsigned int performed_count;      //!< Количество запущенных проверок
+    unsigned int successed_count;      //!< Количество успешных проверок
+    const char *skip_reason;           //!< Причина отмены запуска теста (строка неизменна во всех процессах)
+#ifdef UT_ENABLE_REPORTER
+    char failure_message[UT_REPORT_MESSAGE_SIZE];   //!< Сообщение первой неуспешной проверки; пустая строка, если проверки успешны
+#endif
+#ifdef UT_ENABLE_BENCH
+    struct __ut_bench_stats bench;     //!< Результаты измерений бенчмарка
+#endif
+#ifdef UT_ENABLE_RUSAGE
+    struct __ut_usage usage;           //!< Ресурсы, израсходованные тестом
+#endif
+#ifdef UT_ENABLE_PERF_COUNTERS
+    struct __ut_perf_counters perf_counters;    //!< Показания аппаратных счетчиков
+#endif
+#ifdef UT_ENABLE_ALLOC_TRACKING
+    struct __ut_alloc_stats alloc_stats;        //!< Выделения памяти
+#endif
+};
+
+/*!
+    \brief     Разделяемая (между процессами) память изолированного запуска
+    \protected
+*/
+struct __ut_fork_shared
+{
+    unsigned int current;                       //!< Номер (в порядке выполнения) теста, выполняемого дочерним процессом
+    const unsigned int *order;                  //!< Индексы тестов в порядке выполнения; \p NULL - в порядке объявления
+#ifdef UT_ENABLE_TIMEOUT
+    unsigned long long started_ns;              //!< Момент запуска теста \p current (по монотонным часам), нс
+#endif
+    struct __ut_fork_result results[];          //!< Результаты тестов (в порядке объявления)
+};
+
+/*!
+    \brief     Получить индекс теста по номеру в порядке выполнения
+    \param[in] shared указатель на разделяемую память
+    \param[in] n      номер теста в порядке выполнения
+    \return    Индекс теста
+    \protected
+*/
+static inline unsigned int __ut_fork_index(const struct __ut_fork_shared *shared, unsigned int n)
+{
+    return shared->order != NULL ? shared->order[n] : n;
+}
+
+/*!
+    \brief     Сохранить результат теста в разделяемую память
+    \param[out] result     указатель на структуру результата
+    \param[in]  test_state указатель на состояние теста
+    \protected
+*/
+static void __ut_fork_save(struct __ut_fork_result *result, const struct __ut_test_state *test_state)
+{
+    result->started = test_state->started;
+    result->performed_count = test_state->performed_count;
+    result->successed_count = test_state->successed_count;
+    result->skip_reason = test_state->skip_reason;
+#ifdef UT_ENABLE_REPORTER
+    snprintf(result->failure_message, sizeof(result->failure_message), "%s",
+        test_state->failure_message != NULL ? test_state->failure_message : "");
+#endif
+#ifdef UT_ENABLE_BENCH
+    if (test_state->test->bench != NULL)
+    {
+        result->bench = *test_state->test->bench;
+    }
+#endif
+#ifdef UT_ENABLE_RUSAGE
+    result->usage = test_state->usage;
+#endif
+#ifdef UT_ENABLE_PERF_COUNTERS
+    result->perf_counters = test_state->perf_counters;
+#endif
+#ifdef UT_ENABLE_ALLOC_TRACKING
+    result->alloc_stats = test_state->alloc_stats;
+#endif
+    result->finished = true;
+}
+
+/*!
+    \brief     Перенести результат теста из разделяемой памяти в состояние теста
+    \details   Аварийное завершение процесса теста учитывается как неуспешная проверка
+    \param[out] test_state указатель на состояние теста
+    \param[in]  result     указатель на структуру результата
+    \protected
+*/
+static void __ut_fork_load(struct __ut_test_state *test_state, const struct __ut_fork_result *result)
+{
+    test_state->started = result->started;
+    test_state->performed_count = result->performed_count;
+    test_state->successed_count = result->successed_count;
+    test_state->skip_reason = result->skip_reason;
+    test_state->signal = result->signal;
+#ifdef UT_ENABLE_REPORTER
+    test_state->failure_message = NULL;
+    if (result->failure_message[0] != '\0')
+    {
+        __ut_report_record(test_state, result->failure_message);
+    }
+#endif
+#ifdef UT_ENABLE_BENCH
+    if (test_state->test->bench != NULL)
+    {
+        *test_state->test->bench = result->bench;
+    }
+#endif
+#ifdef UT_ENABLE_RUSAGE
+    test_state->usage = result->usage;
+#endif
+#ifdef UT_ENABLE_PERF_COUNTERS
+    test_state->perf_counters = result->perf_counters;
+#endif
+#ifdef UT_ENABLE_ALLOC_TRACKING
+    test_state->alloc_stats = result->alloc_stats;
+#endif
+
+    if (result->crashed)
+    {
+        char buf[UT_BUFFER_SIZE];
+
+#ifdef UT_ENABLE_TIMEOUT
+        if (result->timed_out)
+        {
+            snprintf(buf, sizeof(buf), "test timed out and was not interrupted within %llu ms; process killed",
+                (unsigned long long)UT_TIMEOUT_GRACE_MS);
+        }
+        else
+#endif
+        if (result->signal != 0)
+        {
+            snprintf(buf, sizeof(buf), "test terminated by signal %d (%s)", result->signal, strsignal(result->signal));
+        }
+        else if (result->exit_code < 0)
+        {
+            snprintf(buf, sizeof(buf), "test process could not be created");
+        }
+        else
+        {
+            snprintf(buf, sizeof(buf), "test process exited with code %d", result->exit_code);
+        }
+        __ut_fail_test(test_state, buf);
+    }
+}
+
+/*!
+    \brief     Сообщить родительскому процессу о появлении результата теста
+    \param[in] fd    дескриптор канала результатов
+    \param[in] index индекс теста
+    \protected
+*/
+static void __ut_fork_notify(int fd, unsigned int index)
+{
+    while (write(fd, &index, sizeof(index)) < 0 && errno == EINTR)
+    {
+    }
+}
+
+#ifdef UT_ENABLE_TIMEOUT
+
+/*!
+    \brief     Дождаться завершения дочернего процесса, ограничивая время тестов
+    \details   Когда время теста истекает, дочернему процессу посылается #UT_TIMEOUT_SIGNAL:
+        процесс прерывает тест (см. #__ut_timeout_handler) и переходит к следующему.
+        Если тест не прерван за #UT_TIMEOUT_GRACE_MS, то процесс завершается принудительно
+    \param[in]  test_suite_desc указатель на структуру набора тестов
+    \param[in]  shared          указатель на разделяемую память
+    \param[in]  pid             идентификатор дочернего процесса
+    \param[out] status          статус завершения дочернего процесса
+    \param[in]  sigchld         множество из сигнала \p SIGCHLD (заблокированного)
+    \protected
+*/
+static void __ut_fork_wait(const struct __ut_test_suite_desc *test_suite_desc, struct __ut_fork_shared *shared,
+    pid_t pid, int *status, const sigset_t *sigchld)
+{
+    unsigned int signalled = 0;        // Номер теста, которому послан сигнал
+    unsigned long long kill_at = 0;    // Момент принудительного завершения; 0 - сигнал не посылался
+
+    for (;;)
+    {
+        const pid_t waited = waitpid(pid, status, WNOHANG);
+        if (waited != 0 && !(waited < 0 && errno == EINTR))
+        {
+            return;
+        }
+
+        const unsigned int j = __atomic_load_n(&shared->current, __ATOMIC_ACQUIRE);
+        const bool interrupting = kill_at != 0 && j == signalled;
+        bool suite;
+        const unsigned long long deadline = interrupting
+            ? kill_at
+            : __ut_timeout_deadline(test_suite_desc, __atomic_load_n(&shared->started_ns, __ATOMIC_RELAXED), &suite);
+        const unsigned long long now = __ut_now_ns();
+
+        if (deadline != 0 && now >= deadline)
+        {
+            if (interrupting)
+            {
+                // Тест не прерван - завершаем процесс
+                shared->results[__ut_fork_index(shared, j)].timed_out = true;
+                kill(pid, SIGKILL);
+                while (waitpid(pid, status, 0) < 0 && errno == EINTR)
+                {
+                }
+                return;
+            }
+
+            kill(pid, UT_TIMEOUT_SIGNAL);
+            signalled = j;
+            kill_at = now + UT_TIMEOUT_GRACE_MS * 1000000ull;
+            continue;
+        }
+
+        // Ждем завершения дочернего процесса или истечения времени
+        if (deadline == 0)
+        {
+            sigwaitinfo(sigchld, NULL);
+        }
+        else
+        {
+            const struct timespec timeout = {
+                (time_t)((deadline - now) / 1000000000ull), (long)((deadline - now) % 1000000000ull)
+            };
+            sigtimedwait(sigchld, NULL, &timeout);
+        }
+    }
+}
+
+#endif  // UT_ENABLE_TIMEOUT
+
+/*!
+    \brief     Основной цикл процесса-зиготы
+    \details   Зигота - копия процесса, в котором уже выполнена startup-функция
+        набора тестов. Для каждой пачки из \p batch_size тестов она порождает
+        дочерний процесс, который выполняет тесты пачки и сохраняет их результаты.
+        Если дочерний процесс завершился аварийно, то тест, на котором это произошло,
+        считается проваленным, а выполнение продолжается со следующего теста.
+        Время тестов ограничивает зигота, см. #__ut_fork_wait
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \param[in] shared          указатель на разделяемую память
+    \param[in] test_count      количество тестов в наборе
+    \param[in] batch_size      количество тестов, выполняемых одним дочерним процессом
+    \param[in] fd              дескриптор канала результатов
+    \protected
+*/
+static void __ut_fork_zygote(const struct __ut_test_suite_desc *test_suite_desc, struct __ut_fork_shared *shared,
+    unsigned int test_count, unsigned int batch_size, int fd)
+{
+#ifdef UT_ENABLE_TIMEOUT
+    // Дочерние процессы не запускают сторожевой поток: время тестов ограничивает зигота.
+    // SIGCHLD блокируется, чтобы ожидать его вместе с истечением времени
+    __ut_timeout.external = true;
+    sigset_t sigchld, mask;
+    sigemptyset(&sigchld);
+    sigaddset(&sigchld, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &sigchld, &mask);
+#endif
+
+    unsigned int i = 0;
+    while (i < test_count)
+    {
+#ifdef UT_ENABLE_FAIL_FAST
+        // После #UT_MAX_FAILURES провалов оставшиеся тесты не запускаем
+        if (__ut_fail_fast_stopped())
+        {
+            for (; i < test_count; ++i)
+            {
+                const unsigned int index = __ut_fork_index(shared, i);
+                shared->results[index].skip_reason = __UT_FAIL_FAST_SKIP_REASON;
+                shared->results[index].finished = true;
+                __ut_fork_notify(fd, index);
+            }
+            break;
+        }
+#endif
+
+        const unsigned int end = test_count - i > batch_size ? i + batch_size : test_count;
+
+        shared->current = i;
+#ifdef UT_ENABLE_TIMEOUT
+        shared->started_ns = __ut_now_ns();
+#endif
+        const pid_t pid = fork();
+        if (pid == 0)
+        {
+#ifdef UT_ENABLE_TIMEOUT
+            sigprocmask(SIG_SETMASK, &mask, NULL);
+#endif
+#ifdef UT_ENABLE_ASSERT_EVENTS
+            // Поток-сборщик проверок не наследуется дочерним процессом
+            __ut_assert_events_start();
+#endif
+
+            // Дочерний процесс: выполняем пачку тестов
+            for (unsigned int j = i; j < end; ++j)
+            {
+#ifdef UT_ENABLE_TIMEOUT
+                __atomic_store_n(&shared->started_ns, __ut_now_ns(), __ATOMIC_RELAXED);
+                __atomic_store_n(&shared->current, j, __ATOMIC_RELEASE);
+#else
+                shared->current = j;
+#endif
+                const unsigned int index = __ut_fork_index(shared, j);
+                __ut_run_test(test_suite_desc, &(test_suite_desc->test_states[index]));
+                __ut_fork_save(&(shared->results[index]), &(test_suite_desc->test_states[index]));
+                // Сбрасываем буферы, чтобы не потерять вывод при аварийном завершении следующего теста
+                fflush(NULL);
+                __ut_fork_notify(fd, index);
+            }
+            _exit(0);
+        }
+
+        int status = 0;
+        if (pid > 0)
+        {
+#ifdef UT_ENABLE_TIMEOUT
+            __ut_fork_wait(test_suite_desc, shared, pid, &status, &sigchld);
+#else
+            while (waitpid(pid, &status, 0) < 0 && errno == EINTR)
+            {
+            }
+#endif
+        }
+
+        // Если процесс не создан или завершился, не выполнив тест current,
+        // то считаем тест аварийно завершенным
+        const unsigned int j = shared->current;
+        struct __ut_fork_result *result = &(shared->results[__ut_fork_index(shared, j)]);
+        if (!result->finished)
+        {
+            result->started = true;
+            result->crashed = true;
+            result->signal = pid > 0 && WIFSIGNALED(status) ? WTERMSIG(status) : 0;
+            result->exit_code = pid < 0 ? -1 : WIFEXITED(status) ? WEXITSTATUS(status) : 0;
+            result->finished = true;
+            __ut_fork_notify(fd, __ut_fork_index(shared, j));
+        }
+
+#ifdef UT_ENABLE_FAIL_FAST
+        // Учитываем провалы пачки: следующие дочерние процессы наследуют счетчик
+        for (unsigned int k = i; k <= j; ++k)
+        {
+            const struct __ut_fork_result *batch_result = &(shared->results[__ut_fork_index(shared, k)]);
+            if (batch_result->finished && batch_result->started
+                && (batch_result->crashed || batch_result->performed_count != batch_result->successed_count))
+            {
+                ++__ut_fail_fast.failed_count;
+            }
+        }
+#endif
+        i = j + 1;
+    }
+}
+
+/*!
+    \brief     Запустить набор тестов, изолируя тесты в дочерних процессах
+    \details   После startup-функции набора тестов порождается процесс-зигота,
+        которая выполняет тесты пачками в дешевых (копируемых при записи)
+        дочерних процессах, см. #__ut_fork_zygote. Результаты передаются
+        через разделяемую память; вызывающий процесс учитывает их и вызывает
+        обработчики в порядке объявления тестов, по мере поступления.
+        Аварийно завершившийся тест считается проваленным (номер сигнала
+        сохраняется в поле \p signal состояния теста), остальные тесты выполняются.
+        Функции startup и teardown выполняются в вызывающем процессе
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \param[in] batch_size      количество тестов, выполняемых одним дочерним процессом;
+        \p 0 трактуется как \p 1
+    \return    Флаг успешного выполнения набора тестов
+    \warning   Изменения глобального состояния, сделанные тестами, не видны
+        вызывающему процессу и тестам из других пачек
+    \protected
+*/
+static inline bool __ut_run_test_suite_forked(struct __ut_test_suite_desc *test_suite_desc, unsigned int batch_size)
+{
+    if (!__ut_start_test_suite(test_suite_desc))
+    {
+        return false;
+    }
+
+    const unsigned int test_count = __ut_test_count(test_suite_desc);
+    if (batch_size == 0)
+    {
+        batch_size = 1;
+    }
+
+#ifdef UT_ENABLE_FAILED_FIRST
+    // Ранее проваленные тесты выполняем первыми
+    unsigned int *order = __ut_failed_order(test_suite_desc, test_count, NULL);
+#else
+    unsigned int *order = NULL;
+#endif
+
+    // Выделяем разделяемую память и канал результатов
+    const size_t shared_size = sizeof(struct __ut_fork_shared) + test_count * sizeof(struct __ut_fork_result);
+    struct __ut_fork_shared *shared = (struct __ut_fork_shared *)mmap(NULL, shared_size,
+        PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    int fds[2] = { -1, -1 };
+    pid_t zygote = -1;
+    if (shared != MAP_FAILED && pipe(fds) == 0)
+    {
+        shared->order = order;
+        // Сбрасываем буферы, чтобы их содержимое не было выведено повторно дочерними процессами
+        fflush(NULL);
+        zygote = fork();
+    }
+
+    if (zygote == 0)
+    {
+        close(fds[0]);
+        __ut_fork_zygote(test_suite_desc, shared, test_count, batch_size, fds[1]);
+        _exit(0);
+    }
+
+    if (zygote < 0)
+    {
+        if (fds[0] >= 0)
+        {
+            close(fds[0]);
+            close(fds[1]);
+        }
+        if (shared != MAP_FAILED)
+        {
+            munmap(shared, shared_size);
+        }
+
+        // Изолировать тесты не удалось - выполняем их в текущем процессе
+        for (unsigned int i = 0; i < test_count; ++i)
+        {
+            struct __ut_test_state *test_state = &(test_suite_desc->test_states[order != NULL ? order[i] : i]);
+
+            __ut_run_test(test_suite_desc, test_state);
+            __ut_complete_test(test_suite_desc, test_state);
+        }
+        free(order);
+
+        return __ut_finish_test_suite(test_suite_desc);
+    }
+
+    close(fds[1]);
+
+    // Учитываем результаты в порядке объявления тестов, по мере их поступления
+    unsigned int next = 0;
+    while (next < test_count)
+    {
+        unsigned int index;
+        const ssize_t size = read(fds[0], &index, sizeof(index));
+        if (size < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        for (; next < test_count && shared->results[next].finished; ++next)
+        {
+            struct __ut_test_state *test_state = &(test_suite_desc->test_states[next]);
+
+            __ut_fork_load(test_state, &(shared->results[next]));
+            __ut_complete_test(test_suite_desc, test_state);
+        }
+
+        // Зигота завершилась: оставшиеся тесты не запускались
+        if (size <= 0)
+        {
+            break;
+        }
+    }
+
+    close(fds[0]);
+    while (waitpid(zygote, NULL, 0) < 0 && errno == EINTR)
+    {
+    }
+    munmap(shared, shared_size);
+    free(order);
+
+    return __ut_finish_test_suite(test_suite_desc);
+}
+
+/*!
+    \brief     Запустить набор тестов, изолируя тесты в дочерних процессах
+    \param[in] test_suite набор тестов
+    \param[in] batch_size количество тестов, выполняемых одним дочерним процессом
+    \see       __ut_run_test_suite_forked
+*/
+#define UT_RUN_TEST_SUITE_FORKED(test_suite, batch_size) __ut_run_test_suite_forked(&test_suite##_desc, (batch_size))
+
+#endif  // UT_ENABLE_FORK
+
+
+#ifdef UT_ENABLE_AUTO_REGISTRATION
+
+//! \name Границы секции зарегистрированных наборов тестов (\p NULL, если наборов нет)
+//! @{
+extern struct __ut_test_suite_desc * const __start_ut_test_suites[] __attribute__((weak));
+extern struct __ut_test_suite_desc * const __stop_ut_test_suites[] __attribute__((weak));
+//! @}
+
+#ifdef UT_ENABLE_FAIL_FAST
+
+/*!
+    \brief     Отменить запуск набора тестов
+    \details   startup- и teardown-функции не вызываются, набор тестов остается
+        незапущенным; о каждом тесте сообщается обработчиком #UT_ON_SKIPPED_TEST
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \param[in] reason          указатель на строку-причину отмены
+    \protected
+*/
+static void __ut_skip_test_suite(struct __ut_test_suite_desc *test_suite_desc, const char *reason)
+{
+    if (!__ut_prepare_test_states(test_suite_desc))
+    {
+        return;
+    }
+
+    const unsigned int test_count = __ut_test_count(test_suite_desc);
+#ifdef UT_ENABLE_REPORTER
+    __ut_report_load();
+    __ut_report_suite_begin(test_suite_desc->name, test_count);
+#endif
+    for (unsigned int i = 0; i < test_count; ++i)
+    {
+        struct __ut_test_state *test_state = &(test_suite_desc->test_states[i]);
+
+        test_state->started = false;
+        test_state->successed_count = test_state->performed_count = 0;
+        test_state->skip_reason = reason;
+        __ut_complete_test(test_suite_desc, test_state);
+    }
+#ifdef UT_ENABLE_REPORTER
+    __ut_report_suite_end(test_suite_desc->name);
+#endif
+}
+
+#endif  // UT_ENABLE_FAIL_FAST
+
+/*!
+    \brief     Запустить все зарегистрированные наборы тестов
+    \details   Выполняет наборы тестов, объявленные макросами #UT_DECLARE_TEST_SUITE
+        и #UT_REGISTER_TEST_SUITE во всех единицах трансляции
+    \param[in] run_test_suite функция запуска одного набора тестов
+    \param[in] n_threads      параметр функции запуска (количество рабочих потоков, размер пачки)
+    \return    \p true, если все наборы тестов успешны; \p false иначе
+    \protected
+*/
+static inline bool __ut_run_all(bool (*run_test_suite)(struct __ut_test_suite_desc *, unsigned int), unsigned int n_threads)
+{
+    bool successed = true;
+
+    for (struct __ut_test_suite_desc * const *test_suite_desc = __start_ut_test_suites;
+         test_suite_desc < __stop_ut_test_suites; ++test_suite_desc)
+    {
+#ifdef UT_ENABLE_FAIL_FAST
+        // После #UT_MAX_FAILURES провалов оставшиеся наборы тестов не запускаются
+        __ut_fail_fast_load();
+        if (__ut_fail_fast_stopped())
+        {
+            __ut_skip_test_suite(*test_suite_desc, __UT_FAIL_FAST_SKIP_REASON);
+            successed = false;
+            continue;
+        }
+#endif
+
+        if (!run_test_suite(*test_suite_desc, n_threads))
+        {
+            successed = false;
+        }
+    }
 
-/*!
-    \brief     Определить функцию, которая будет вызвана перед запуском набора тестов
-    \param[in] test_suite набор тестов
-*/
-#define UT_STARTUP(test_suite) void test_suite##_startup(struct __ut_test_suite_desc *desc)
+    return successed;
+}
 
 /*!
-    \brief     Определить функцию, которая будет вызвана перед запуском набора тестов
-    \param[in] test_suite набор тестов
+    \brief     Запустить набор тестов (в формате функции для #__ut_run_all)
+    \param[in] test_suite_desc указатель на структуру набора тестов
+    \param[in] n_threads       не используется
+    \return    Флаг успешного выполнения набора тестов
+    \protected
 */
-#define UT_TEARDOWN(test_suite) void test_suite##_teardown(struct __ut_test_suite_desc *desc)
+static inline bool __ut_run_test_suite_sequential(struct __ut_test_suite_desc *test_suite_desc, unsigned int n_threads)
+{
+    (void)n_threads;
 
-/*!
-    \brief     Макрос для добавления теста в список тестов набора тестов
-    \param[in] test_suite  набор тестов
-    \param[in] test        тест
-    \param[in] description указатель на строку-описание теста
-*/
-#define UT_ADD_TEST(test_suite, test, description) { #test, description, __FILE__, __LINE__, test_suite##_##test, false, 0, 0 }
+    return __ut_run_test_suite(test_suite_desc);
+}
 
 /*!
-    \brief Макрос для завершения списка тестов
+    \brief     Запустить все зарегистрированные наборы тестов
 */
-#define UT_TEST_SUITE_END { NULL, NULL, __FILE__, __LINE__, NULL, false, 0, 0 }
+#define UT_RUN_ALL() __ut_run_all(__ut_run_test_suite_sequential, 0)
 
+#ifdef UT_ENABLE_PARALLEL
 /*!
-    \brief     Макрос для определения набора тестов
-    \param[in] test_suite  набор тестов
-    \param[in] description указатель на строку-описание набора тестов
-    \param[in] ...         список тестов.
-        Формулируется путем вызова, через запятую, макросов #UT_ADD_TEST,
-        для каждого из тестов, и завершающим макросом #UT_TEST_SUITE_END.
-    \warning  Необходимо вызывать макрос без заверщающего разделителя \p ;
+    \brief     Запустить все зарегистрированные наборы тестов, параллельно выполняя тесты каждого набора
+    \param[in] n_threads количество рабочих потоков; \p 0 - по количеству доступных процессоров
 */
-#define UT_DECLARE_TEST_SUITE(test_suite, description, ...)       \
-    /* Объявляем массив структур тесов                         */ \
-    static struct __ut_test_desc test_suite##_test_descs[] = {    \
-        __VA_ARGS__                                               \
-    };                                                            \
-                                                                  \
-    /* Объявляем структуру набора тестов                       */ \
-    static struct __ut_test_suite_desc test_suite##_desc = {      \
-        #test_suite, description,                                 \
-        test_suite##_startup, test_suite##_teardown,              \
-        test_suite##_before_each, test_suite##_after_each,        \
-        test_suite##_test_descs,                                  \
-        false, 0, 0                                               \
-    };
+#define UT_RUN_ALL_PARALLEL(n_threads) __ut_run_all(__ut_run_test_suite_parallel, (n_threads))
+#endif
 
+#ifdef UT_ENABLE_FORK
 /*!
-    \brief     Получить структуру набора тестов
-    \param[in] test_suite  набор тестов
+    \brief     Запустить все зарегистрированные наборы тестов, изолируя тесты в дочерних процессах
+    \param[in] batch_size количество тестов, выполняемых одним дочерним процессом
 */
-#define UT_TEST_SUITE_DESC(test_suite)    ( test_suite##_desc )
+#define UT_RUN_ALL_FORKED(batch_size) __ut_run_all(__ut_run_test_suite_forked, (batch_size))
+#endif
 
-/*!
-    \brief     Проверить, был ли тест запущен
-    \param[in] test_desc структура теста
-    \return    \p true, если тест был запущен; \p false иначе
-*/
-#define UT_IS_TEST_STARTED(test_desc)   ( (test_desc)->started )
+#endif  // UT_ENABLE_AUTO_REGISTRATION
 
-/*!
-    \brief     Проверить, был ли тест пропущен
-    \param[in] test_desc структура теста
-    \return    \p true, если тест не был запущен; \p false иначе
-*/
-#define UT_IS_TEST_SKIPPED(test_desc)   ( !UT_IS_TEST_STARTED(test_desc) )
 
 /*!
-    \brief     Проверить, был ли тест успешен
-    \param[in] test_desc структура теста
-    \return    \p true, если тест был запущен и успешно завершился; \p false иначе
+    \brief     Тип переменной, выводимый из инициализатора
+    \details   В C++ нет \p __auto_type
+    \protected
 */
-#define UT_IS_TEST_SUCCESSED(test_desc) ( UT_IS_TEST_STARTED(test_desc) && (test_desc)->performed_count == (test_desc)->successed_count )
+#ifdef __cplusplus
+#define __UT_AUTO auto
+#else
+#define __UT_AUTO __auto_type
+#endif
 
 /*!
-    \brief     Проверить, был ли тест провален
-    \param[in] test_desc структура теста
-    \return    \p true, если тест был запущен и не завершился успешно; \p false иначе
+    \brief     Проверить равенство двух значений
+    \details   Каждое из выражений вычисляется ровно один раз. Сообщение
+        формируется только в случае неуспешной проверки, по сохраненным значениям
+    \param[in] actual   реальное значение
+    \param[in] expected ожидаемое значение
+    \param[in] message  указатель на строку-сообщение
+    \param[in] format   спецификатор формата \p printf для значений
+    \protected
 */
-#define UT_IS_TEST_FAILED(test_desc)    ( !UT_IS_TEST_SUCCESSED(test_desc) )
+#define __UT_EQUALS(actual, expected, message, format) do {                            \
+        const __UT_AUTO actual_ = (actual);                                            \
+        const __UT_AUTO expected_ = (expected);                                        \
+                                                                                       \
+        if (expected_ == actual_) {                                                    \
+            UT_ASSERT(true, message);                                                  \
+        }                                                                              \
+        else                                                                           \
+        {                                                                              \
+            char __ut_buf[UT_BUFFER_SIZE];                                             \
+                                                                                       \
+            snprintf(__ut_buf, sizeof(__ut_buf),                                       \
+                "%s (status equality check failed: expected "                          \
+                format ", got " format ")", message, expected_, actual_);              \
+            UT_ASSERT(false, __ut_buf);                                                \
+        }                                                                              \
+    } while(0)
 
 /*!
-    \brief     Проверить, был ли набор тестов запущен
-    \param[in] test_suite_desc структура набора тестов
-    \return    \p true, если набор тестов был запущен; \p false иначе
+    \brief     Проверить равенство двух знаковых десятичных чисел
+    \details   Проводит проверку, формируя (только в случае неудачи) сообщение,
+        специфичное для сравнения двух знаковых десятичных чисел
+    \param[in] actual   реальное значение
+    \param[in] expected ожидаемое значение
+    \param[in] message  указатель на строку-сообщение
 */
-#define UT_IS_TEST_SUITE_STARTED(test_suite_desc)   ( (test_suite_desc)->started )
+#define UT_DECIMAL_EQUALS(actual, expected, message) \
+    __UT_EQUALS(actual, expected, message, "%d")
 
 /*!
-    \brief     Проверить, был ли набор тестов пропущен
-    \param[in] test_suite_desc структура набора тестов
-    \return    \p true, если набор тестов не был запущен; \p false иначе
+    \brief     Проверить равенство двух беззнаковых десятичных чисел
+    \details   Проводит проверку, формируя (только в случае неудачи) сообщение,
+        специфичное для сравнения двух беззнаковых десятичных чисел
+    \param[in] actual   реальное значение
+    \param[in] expected ожидаемое значение
+    \param[in] message  указатель на строку-сообщение
 */
-#define UT_IS_TEST_SUITE_SKIPPED(test_suite_desc)   ( !UT_IS_TEST_SUITE_STARTED(test_suite_desc) )
+#define UT_UNSIGNED_DECIMAL_EQUALS(actual, expected, message) \
+    __UT_EQUALS(actual, expected, message, "%u")
 
 /*!
-    \brief     Проверить, был ли набор тестов успешен
-    \param[in] test_suite_desc структура набора тестов
-    \return    \p true, если набор тестов был запущен и завершился успешно; \p false иначе
+    \brief     Проверить равенство двух беззнаковых шестнадцатиричных чисел
+    \details   Проводит проверку, формируя (только в случае неудачи) сообщение,
+        специфичное для сравнения двух беззнаковых шестнадцатиричных чисел
+    \param[in] actual   реальное значение
+    \param[in] expected ожидаемое значение
+    \param[in] message  указатель на строку-сообщение
 */
-#define UT_IS_TEST_SUITE_SUCCESSED(test_suite_desc) ( UT_IS_TEST_SUITE_STARTED(test_suite_desc) && (test_suite_desc)->performed_count == (test_suite_desc)->successed_count )
+#define UT_UNSIGNED_HEXADECIMAL_EQUALS(actual, expected, message) \
+    __UT_EQUALS(actual, expected, message, "%X")
 
 /*!
-    \brief     Проверить, был ли набор тестов провален
-    \param[in] test_suite_desc структура набора тестов
-    \return    \p true, если набор тестов был запущен и не завершился успешно; \p false иначе
+    \brief     Проверить равенство двух символов
+    \details   Проводит проверку, формируя (только в случае неудачи) сообщение,
+        специфичное для сравнения двух символов
+    \param[in] actual   реальное значение
+    \param[in] expected ожидаемое значение
+    \param[in] message  указатель на строку-сообщение
 */
-#define UT_IS_TEST_SUITE_FAILED(test_suite_desc)    ( !UT_IS_TEST_SUITE_SUCCESSED(test_suite_desc) )
+#define UT_CHAR_EQUALS(actual, expected, message) \
+    __UT_EQUALS(actual, expected, message, "%c")
+
+
+#ifndef UT_MEMORY_DIFF_WINDOW
+//! Количество элементов, выводимых в сообщении о несовпадении памяти по обе стороны от первого отличия
+#define UT_MEMORY_DIFF_WINDOW 4
+#endif
 
 /*!
-    \brief     Запустить набор тестов
-    \param[in] test_suite_desc указатель на структуру набора тестов
-    \return    Флаг успешного выполнения набора тестов
+    \brief     Найти первое отличие двух областей памяти
+    \details   Сравнивает по 64 байта за итерацию с помощью AVX2 или SSE2
+        (если доступны при компиляции), иначе - машинными словами
+    \param[in] a    указатель на первую область памяти
+    \param[in] b    указатель на вторую область памяти
+    \param[in] size размер областей памяти, байт
+    \return    Смещение первого отличающегося байта; \p size, если области совпадают
     \protected
 */
-static bool __ut_run_test_suite(struct __ut_test_suite_desc *test_suite_desc)
+static inline size_t __ut_mismatch(const void *a, const void *b, size_t size)
 {
-    // \name Объявляем набор тестов запущенным
-    // @{
-    test_suite_desc->started = true;
-    test_suite_desc->successed_count = test_suite_desc->performed_count = 0;
-    // @}
+    const unsigned char *x = (const unsigned char *)a, *y = (const unsigned char *)b;
+    size_t offset = 0;
 
-    // Вызываем startu-функцию
-    test_suite_desc->startup(test_suite_desc);
-    // Если в ходе ее выполнения были неуспешные проверки, то прерываем выполнение набора тестов
-    if (!UT_IS_TEST_SUITE_SUCCESSED(test_suite_desc))
+#if defined(__AVX2__)
+    for (; offset + 64 <= size; offset += 64)
     {
-        return false;
+        const __m256i eq0 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(x + offset)),
+            _mm256_loadu_si256((const __m256i *)(y + offset)));
+        const __m256i eq1 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(x + offset + 32)),
+            _mm256_loadu_si256((const __m256i *)(y + offset + 32)));
+        if ((unsigned int)_mm256_movemask_epi8(_mm256_and_si256(eq0, eq1)) != 0xFFFFFFFFu)
+        {
+            const unsigned int mask0 = ~(unsigned int)_mm256_movemask_epi8(eq0);
+            return mask0 != 0
+                ? offset + (size_t)__builtin_ctz(mask0)
+                : offset + 32 + (size_t)__builtin_ctz(~(unsigned int)_mm256_movemask_epi8(eq1));
+        }
+    }
+#elif defined(__SSE2__)
+    for (; offset + 64 <= size; offset += 64)
+    {
+        __m128i eq[4];
+        for (unsigned int i = 0; i < 4; ++i)
+        {
+            eq[i] = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(x + offset + 16 * i)),
+                _mm_loadu_si128((const __m128i *)(y + offset + 16 * i)));
+        }
+        if (_mm_movemask_epi8(_mm_and_si128(_mm_and_si128(eq[0], eq[1]), _mm_and_si128(eq[2], eq[3]))) != 0xFFFF)
+        {
+            for (unsigned int i = 0; i < 4; ++i)
+            {
+                const unsigned int mask = ~(unsigned int)_mm_movemask_epi8(eq[i]) & 0xFFFFu;
+                if (mask != 0)
+                {
+                    return offset + 16 * i + (size_t)__builtin_ctz(mask);
+                }
+            }
+        }
     }
+#endif
 
-    // Запускаем тесты
-    for (unsigned int i = 0; test_suite_desc->test_descs[i].func != NULL; ++i)
+    // Остаток (или все данные без SIMD) сравниваем машинными словами...
+    for (; offset + sizeof(uint64_t) <= size; offset += sizeof(uint64_t))
+    {
+        uint64_t u, v;
+        memcpy(&u, x + offset, sizeof(u));
+        memcpy(&v, y + offset, sizeof(v));
+        if (u != v)
+        {
+            break;
+        }
+    }
+    // ...и побайтно
+    for (; offset < size; ++offset)
     {
-        // Получаем указатель на структуру теста
-        struct __ut_test_desc *test_desc = &(test_suite_desc->test_descs[i]);
-        // Объявляем тест запущенным
-        // @{
-        test_desc->started = true;
-        test_desc->successed_count = test_desc->performed_count = 0;
-        // @}
+        if (x[offset] != y[offset])
+        {
+            break;
+        }
+    }
+
+    return offset;
+}
+
+//! \name Виды элементов в сообщении о несовпадении (см. #__UT_ELEMENT_KIND)
+// @{
+#define __UT_ELEMENT_OPAQUE   0        //!< Байты в шестнадцатиричном виде
+#define __UT_ELEMENT_SIGNED   1        //!< Целое со знаком
+#define __UT_ELEMENT_UNSIGNED 2        //!< Целое без знака
+#define __UT_ELEMENT_FLOAT    3        //!< Число с плавающей точкой
+// @}
+
+/*!
+    \brief     Определить вид элементов, на которые указывает указатель
+    \param[in] pointer указатель на элемент
+    \protected
+*/
+#ifdef __cplusplus
+#define __UT_ELEMENT_KIND(pointer)                                                     \
+    (std::is_floating_point<std::remove_reference<decltype(*(pointer))>::type>::value  \
+        ? __UT_ELEMENT_FLOAT                                                           \
+        : !std::is_integral<std::remove_reference<decltype(*(pointer))>::type>::value  \
+        ? __UT_ELEMENT_OPAQUE                                                          \
+        : std::is_signed<std::remove_reference<decltype(*(pointer))>::type>::value     \
+        ? __UT_ELEMENT_SIGNED : __UT_ELEMENT_UNSIGNED)
+#else
+#define __UT_ELEMENT_KIND(pointer) _Generic(*(pointer),                                \
+        char: (char)-1 < 0 ? __UT_ELEMENT_SIGNED : __UT_ELEMENT_UNSIGNED,              \
+        signed char: __UT_ELEMENT_SIGNED, short: __UT_ELEMENT_SIGNED,                  \
+        int: __UT_ELEMENT_SIGNED, long: __UT_ELEMENT_SIGNED,                           \
+        long long: __UT_ELEMENT_SIGNED,                                                \
+        bool: __UT_ELEMENT_UNSIGNED, unsigned char: __UT_ELEMENT_UNSIGNED,             \
+        unsigned short: __UT_ELEMENT_UNSIGNED, unsigned int: __UT_ELEMENT_UNSIGNED,    \
+        unsigned long: __UT_ELEMENT_UNSIGNED, unsigned long long: __UT_ELEMENT_UNSIGNED, \
+        float: __UT_ELEMENT_FLOAT, double: __UT_ELEMENT_FLOAT,                         \
+        long double: __UT_ELEMENT_FLOAT,                                               \
+        default: __UT_ELEMENT_OPAQUE)
+#endif
 
-        // Объявляем (в наборе тестов) тест запущенным
-        ++test_suite_desc->performed_count;
+/*!
+    \brief     Вывести элемент в сообщение о несовпадении
+    \details   Целые выводятся в десятичном виде, числа с плавающей точкой - с точностью,
+        достаточной для различения значений; элементы других видов и размеров - байтами
+        в шестнадцатиричном виде
+    \param[out] buf          указатель на буфер
+    \param[in]  buf_size     размер буфера
+    \param[in]  element      указатель на элемент
+    \param[in]  element_size размер элемента, байт
+    \param[in]  kind         вид элемента, см. #__UT_ELEMENT_OPAQUE
+    \return    Результат \p snprintf
+    \protected
+*/
+static inline int __ut_format_element(char *buf, size_t buf_size, const unsigned char *element, size_t element_size,
+    int kind)
+{
+    if ((kind == __UT_ELEMENT_SIGNED || kind == __UT_ELEMENT_UNSIGNED)
+        && (element_size == 1 || element_size == 2 || element_size == 4 || element_size == 8))
+    {
+        uint64_t value;
+        if (element_size == 1)
+        {
+            uint8_t u8;
+            memcpy(&u8, element, sizeof(u8));
+            value = u8;
+        }
+        else if (element_size == 2)
+        {
+            uint16_t u16;
+            memcpy(&u16, element, sizeof(u16));
+            value = u16;
+        }
+        else if (element_size == 4)
+        {
+            uint32_t u32;
+            memcpy(&u32, element, sizeof(u32));
+            value = u32;
+        }
+        else
+        {
+            memcpy(&value, element, sizeof(value));
+        }
 
-        // Запускаем before each-функцию
-        test_suite_desc->before_each(test_desc);
-        // Если в ходе ее выполнения не было неуспешных проверки, то продолжаем выполнение теста
-        if (UT_IS_TEST_SUCCESSED(test_desc))
+        // Расширяем знак до 64 бит
+        const unsigned int bits = (unsigned int)element_size * 8;
+        if (kind == __UT_ELEMENT_SIGNED && bits < 64 && (value >> (bits - 1)) != 0)
         {
-            // Запускаем функцию теста
-            test_desc->func(test_desc);
+            value |= ~0ull << bits;
         }
 
-        // Запускаем after each-функцию
-        test_suite_desc->after_each(test_desc);
+        return kind == __UT_ELEMENT_SIGNED
+            ? snprintf(buf, buf_size, "%lld", (long long)value)
+            : snprintf(buf, buf_size, "%llu", (unsigned long long)value);
+    }
+    else if (kind == __UT_ELEMENT_FLOAT)
+    {
+        float f;
+        double d;
+        long double ld;
 
-        // Если тест был успешен, то помачаем этот факт в наборе тестов 
-        // Выполняем обработчик успехов
-        if (UT_IS_TEST_SUCCESSED(test_desc))
+        if (element_size == sizeof(f))
         {
-            ++test_suite_desc->successed_count;
-            UT_ON_SUCCESSFUL_TEST(test_desc);
+            memcpy(&f, element, sizeof(f));
+            return snprintf(buf, buf_size, "%.9g", (double)f);
         }
-        // Иначе выполняем обработчик неудач
-        else
+        if (element_size == sizeof(d))
+        {
+            memcpy(&d, element, sizeof(d));
+            return snprintf(buf, buf_size, "%.17g", d);
+        }
+        if (element_size == sizeof(ld))
         {
-            UT_ON_FAILED_TEST(test_desc);
+            memcpy(&ld, element, sizeof(ld));
+            return snprintf(buf, buf_size, "%.21Lg", ld);
         }
     }
 
-    // Запускаем teardown-функцию набора тестов
-    test_suite_desc->teardown(test_suite_desc);
+    int length = 0;
+    for (size_t j = 0; j < element_size && length >= 0 && (size_t)length < buf_size; ++j)
+    {
+        length += snprintf(buf + length, buf_size - (size_t)length, "%02X", element[j]);
+    }
 
-    // Возвращаем флаг успешности набора тестов
-    return UT_IS_TEST_SUITE_SUCCESSED(test_suite_desc);
+    return length;
 }
 
 /*!
-    \brief     Запустить набор тестов
-    \param[in] test_suite набор тестов
+    \brief     Сформировать сообщение о несовпадении областей памяти
+    \details   Выводит окно из не более чем 2 * #UT_MEMORY_DIFF_WINDOW + 1 элементов
+        вокруг первого отличающегося (см. #__ut_format_element);
+        отличающийся элемент заключается в квадратные скобки
+    \param[out] buf          указатель на буфер сообщения
+    \param[in]  buf_size     размер буфера
+    \param[in]  message      указатель на строку-сообщение
+    \param[in]  actual       указатель на реальные данные
+    \param[in]  expected     указатель на ожидаемые данные
+    \param[in]  size         размер данных, байт
+    \param[in]  element_size размер элемента, байт
+    \param[in]  kind         вид элементов, см. #__UT_ELEMENT_OPAQUE
+    \param[in]  offset       смещение первого отличающегося байта
+    \protected
 */
-#define UT_RUN_TEST_SUITE(test_suite) __ut_run_test_suite(&test_suite##_desc)
+static inline void __ut_format_mismatch(char *buf, size_t buf_size, const char *message,
+    const void *actual, const void *expected, size_t size, size_t element_size, int kind, size_t offset)
+{
+    const size_t index = offset / element_size, count = size / element_size;
+    const size_t first = index > UT_MEMORY_DIFF_WINDOW ? index - UT_MEMORY_DIFF_WINDOW : 0;
+    const size_t last = count - index > UT_MEMORY_DIFF_WINDOW ? index + UT_MEMORY_DIFF_WINDOW : count - 1;
+
+    int length = element_size == 1
+        ? snprintf(buf, buf_size, "%s (memory equality check failed at offset %zu of %zu: expected", message, offset, size)
+        : snprintf(buf, buf_size, "%s (array equality check failed at index %zu of %zu: expected", message, index, count);
+
+    for (unsigned int side = 0; side < 2; ++side)
+    {
+        const unsigned char *data = (const unsigned char *)(side == 0 ? expected : actual);
+
+        if (side == 1 && length >= 0 && (size_t)length < buf_size)
+        {
+            length += snprintf(buf + length, buf_size - (size_t)length, ", got");
+        }
+        if (first > 0 && length >= 0 && (size_t)length < buf_size)
+        {
+            length += snprintf(buf + length, buf_size - (size_t)length, " ...");
+        }
+        for (size_t i = first; i <= last && length >= 0 && (size_t)length < buf_size; ++i)
+        {
+            length += snprintf(buf + length, buf_size - (size_t)length, i == index ? " [" : " ");
+            if (length >= 0 && (size_t)length < buf_size)
+            {
+                length += __ut_format_element(buf + length, buf_size - (size_t)length,
+                    data + i * element_size, element_size, kind);
+            }
+            if (i == index && length >= 0 && (size_t)length < buf_size)
+            {
+                length += snprintf(buf + length, buf_size - (size_t)length, "]");
+            }
+        }
+        if (last + 1 < count && length >= 0 && (size_t)length < buf_size)
+        {
+            length += snprintf(buf + length, buf_size - (size_t)length, " ...");
+        }
+    }
 
+    if (length >= 0 && (size_t)length < buf_size)
+    {
+        snprintf(buf + length, buf_size - (size_t)length, ")");
+    }
+}
 
 /*!
-    \brief     Проверить равенство двух знаковых десятичных чисел
-    \details   Проводит проверку, формируя сообщение, специфичное для сравнения
-        двух знаковых десятичных чисел
-    \param[in] actual   реальное значение
-    \param[in] expected ожидаемое значение
+    \brief     Проверить равенство двух областей памяти
+    \details   Является одной проверкой, независимо от размера областей.
+        Сообщение (с шестнадцатиричным окном вокруг первого отличающегося байта)
+        формируется только в случае неудачи
+    \param[in] actual   указатель на реальные данные
+    \param[in] expected указатель на ожидаемые данные
+    \param[in] size     размер данных, байт
     \param[in] message  указатель на строку-сообщение
 */
-#define UT_DECIMAL_EQUALS(actual, expected, message) do {                              \
-        const __auto_type actual_ = (actual);                                          \
-        const __auto_type expected_ = (expected);                                      \
-        char __ut_buf[UT_BUFFER_SIZE];                                                 \
+#define UT_MEMORY_EQUALS(actual, expected, size, message) do {                         \
+        const void * const actual_ = (actual);                                         \
+        const void * const expected_ = (expected);                                     \
+        const size_t size_ = (size);                                                   \
+        const size_t offset_ = __ut_mismatch(actual_, expected_, size_);               \
+                                                                                       \
+        if (offset_ == size_) {                                                        \
+            UT_ASSERT(true, message);                                                  \
+        }                                                                              \
+        else                                                                           \
+        {                                                                              \
+            char __ut_buf[UT_BUFFER_SIZE];                                             \
                                                                                        \
-        sprintf(__ut_buf, "%s (status equality check failed: expected %d, got %d)",    \
-            message, expected_, actual_);                                              \
-        UT_ASSERT(expected == actual, __ut_buf);                                       \
+            __ut_format_mismatch(__ut_buf, sizeof(__ut_buf), message,                  \
+                actual_, expected_, size_, 1, __UT_ELEMENT_OPAQUE, offset_);           \
+            UT_ASSERT(false, __ut_buf);                                                \
+        }                                                                              \
     } while(0)
 
 /*!
-    \brief     Проверить равенство двух беззнаковых десятичных чисел
-    \details   Проводит проверку, формируя сообщение, специфичное для сравнения
-        двух беззнаковых десятичных чисел
-    \param[in] actual   реальное значение
-    \param[in] expected ожидаемое значение
+    \brief     Проверить равенство двух массивов
+    \details   Элементы сравниваются побайтно (поэтому, например, \p 0.0 и \p -0.0
+        различаются). Является одной проверкой, независимо от размера массивов.
+        Сообщение (с индексом и окном элементов вокруг первого отличающегося)
+        формируется только в случае неудачи: целые и числа с плавающей точкой
+        выводятся значениями, элементы других типов - шестнадцатиричными байтами
+    \param[in] actual   указатель на первый элемент реального массива
+    \param[in] expected указатель на первый элемент ожидаемого массива
+    \param[in] count    количество элементов
     \param[in] message  указатель на строку-сообщение
 */
-#define UT_UNSIGNED_DECIMAL_EQUALS(actual, expected, message) do                       \
-        const __auto_type actual_ = (actual);                                          \
-        const __auto_type expected_ = (expected);                                      \
-        char __ut_buf[UT_BUFFER_SIZE];                                                 \
+#define UT_ARRAY_EQUALS(actual, expected, count, message) do {                         \
+        const __UT_AUTO actual_ = (actual);                                            \
+        const __UT_AUTO expected_ = (expected);                                        \
+        const size_t element_size_ = sizeof(*actual_);                                 \
+        const size_t count_ = (size_t)(count);                                         \
+        size_t size_;                                                                  \
+                                                                                       \
+        if (__builtin_mul_overflow(count_, element_size_, &size_)) {                   \
+            char __ut_buf[UT_BUFFER_SIZE];                                             \
+                                                                                       \
+            snprintf(__ut_buf, sizeof(__ut_buf),                                       \
+                "%s (array equality check failed: size of %zu elements overflows size_t)", \
+                (message), count_);                                                    \
+            UT_ASSERT(false, __ut_buf);                                                \
+        }                                                                              \
+        const size_t offset_ = __ut_mismatch(actual_, expected_, size_);               \
+                                                                                       \
+        if (offset_ == size_) {                                                        \
+            UT_ASSERT(true, message);                                                  \
+        }                                                                              \
+        else                                                                           \
+        {                                                                              \
+            char __ut_buf[UT_BUFFER_SIZE];                                             \
                                                                                        \
-        sprintf(__ut_buf, "%s (status equality check failed: expected %u, got %u)",    \
-            message, expected_, actual_);                                              \
-        UT_ASSERT(expected == actual, __ut_buf);                                       \
+            __ut_format_mismatch(__ut_buf, sizeof(__ut_buf), message,                  \
+                actual_, expected_, size_, element_size_,                              \
+                __UT_ELEMENT_KIND(actual_), offset_);                                  \
+            UT_ASSERT(false, __ut_buf);                                                \
+        }                                                                              \
     } while(0)
 
+#ifdef UT_ENABLE_ALLOC_TRACKING
+
 /*!
-    \brief     Проверить равенство двух беззнаковых шестнадцатиричных чисел
-    \details   Проводит проверку, формируя сообщение, специфичное для сравнения
-        двух беззнаковых шестнадцатиричных чисел
-    \param[in] actual   реальное значение
-    \param[in] expected ожидаемое значение
-    \param[in] message  указатель на строку-сообщение
+    \brief     Проверить, что фрагмент кода выделяет не более заданного объема динамической памяти
+    \details   Учитываются выделения, сделанные текущим потоком (в том числе
+        обработчиками проверок внутри фрагмента). Является одной проверкой;
+        без работающих перехватчиков распределителя (#UT_ALLOC_IMPLEMENTATION) неуспешна
+    \param[in] max_bytes максимальное количество запрошенных байт
+    \param[in] ...       проверяемый фрагмент кода
 */
-#define UT_UNSIGNED_HEXADECIMAL_EQUALS(actual, expected, message) do {                 \
-        const __auto_type actual_ = (actual);                                          \
-        const __auto_type expected_ = (expected);                                      \
-        char __ut_buf[UT_BUFFER_SIZE];                                                 \
+#define UT_ASSERT_MAX_ALLOC_BYTES(max_bytes, ...) do {                                 \
+        const struct __ut_alloc_stats __ut_alloc_mark = __ut_alloc_thread_stats;       \
+                                                                                       \
+        { __VA_ARGS__ }                                                                \
+                                                                                       \
+        const struct __ut_alloc_stats __ut_alloc = __ut_alloc_since(__ut_alloc_mark);  \
+        const unsigned long long __ut_max_bytes = (max_bytes);                         \
+                                                                                       \
+        if (!__ut_alloc_active()) {                                                    \
+            UT_ASSERT(false, "allocation limit check" __UT_ALLOC_INACTIVE_MESSAGE);    \
+        }                                                                              \
+        else if (__ut_alloc.bytes <= __ut_max_bytes) {                                 \
+            UT_ASSERT(true, "allocation limit check");                                 \
+        }                                                                              \
+        else                                                                           \
+        {                                                                              \
+            char __ut_buf[UT_BUFFER_SIZE];                                             \
                                                                                        \
-        sprintf(__ut_buf, "%s (status equality check failed: expected %X, got %X)",    \
-            message, expected_, actual_);                                              \
-        UT_ASSERT(expected == actual, __ut_buf);                                       \
+            snprintf(__ut_buf, sizeof(__ut_buf),                                       \
+                "allocation limit check failed: %llu bytes in %llu allocations, expected at most %llu bytes", \
+                __ut_alloc.bytes, __ut_alloc.count, __ut_max_bytes);                   \
+            UT_ASSERT(false, __ut_buf);                                                \
+        }                                                                              \
     } while(0)
 
 /*!
-    \brief     Проверить равенство двух символов
-    \details   Проводит проверку, формируя сообщение, специфичное для сравнения
-        двух символов
-    \param[in] actual   реальное значение
-    \param[in] expected ожидаемое значение
-    \param[in] message  указатель на строку-сообщение
+    \brief     Проверить, что фрагмент кода не выделяет динамическую память
+    \details   Учитываются выделения, сделанные текущим потоком (в том числе
+        обработчиками проверок внутри фрагмента). Является одной проверкой;
+        без работающих перехватчиков распределителя (#UT_ALLOC_IMPLEMENTATION) неуспешна
+    \param[in] ... проверяемый фрагмент кода
 */
-#define UT_CHAR_EQUALS(actual, expected, message) do {                                 \
-        const __auto_type actual_ = (actual);                                          \
-        const __auto_type expected_ = (expected);                                      \
-        char __ut_buf[UT_BUFFER_SIZE];                                                 \
+#define UT_ASSERT_NO_ALLOC(...) do {                                                   \
+        const struct __ut_alloc_stats __ut_alloc_mark = __ut_alloc_thread_stats;       \
                                                                                        \
-        sprintf(__ut_buf, "%s (status equality check failed: expected %c, got %c)",    \
-            message, expected_, actual_);                                              \
-        UT_ASSERT(expected == actual, __ut_buf);                                       \
+        { __VA_ARGS__ }                                                                \
+                                                                                       \
+        const struct __ut_alloc_stats __ut_alloc = __ut_alloc_since(__ut_alloc_mark);  \
+                                                                                       \
+        if (!__ut_alloc_active()) {                                                    \
+            UT_ASSERT(false, "no allocation check" __UT_ALLOC_INACTIVE_MESSAGE);       \
+        }                                                                              \
+        else if (__ut_alloc.count == 0) {                                              \
+            UT_ASSERT(true, "no allocation check");                                    \
+        }                                                                              \
+        else                                                                           \
+        {                                                                              \
+            char __ut_buf[UT_BUFFER_SIZE];                                             \
+                                                                                       \
+            snprintf(__ut_buf, sizeof(__ut_buf),                                       \
+                "no allocation check failed: %llu allocations, %llu bytes",            \
+                __ut_alloc.count, __ut_alloc.bytes);                                   \
+            UT_ASSERT(false, __ut_buf);                                                \
+        }                                                                              \
     } while(0)
 
+#ifdef UT_ENABLE_LEAK_CHECK
+
+/*!
+    \brief     Исключить блок памяти из поиска утечек
+    \details   Используется для памяти, намеренно сохраняемой тестом
+        (например, в кэше, живущем до конца программы)
+    \param[in] ptr указатель на блок памяти
+*/
+#define UT_LEAK_CHECK_IGNORE(ptr) __ut_leak_remove(ptr)
+
+#endif  // UT_ENABLE_LEAK_CHECK
+
+#endif  // UT_ENABLE_ALLOC_TRACKING
+
+
+#if defined(UT_ENABLE_FILTER) || defined(UT_ENABLE_FAIL_FAST) || defined(UT_ENABLE_FAILED_FIRST) \
+    || defined(UT_ENABLE_REPORTER) || defined(UT_ENABLE_PROPERTY) \
+    || defined(UT_ENABLE_FUZZ)
+
+/*!
+    \brief     Разобрать параметры командной строки
+    \details   Распознает параметры включенных возможностей и удаляет их из \p argv:
+        - \p --filter=FILTER - фильтр наименований тестов (см. #__ut_filter_compile);
+        - \p --max-failures=N - количество провалов, после которого тесты не запускаются (см. #UT_MAX_FAILURES);
+        - \p --fail-fast - то же, что \p --max-failures=1;
+        - \p --failed-first - запускать первыми ранее проваленные тесты и тесты из измененных файлов;
+        - \p --failed-only - запускать только ранее проваленные тесты;
+        - \p --report=FORMAT - формат отчета (см. #UT_REPORT_FORMAT);
+        - \p --report-file=PATH - путь к файлу отчета (см. #UT_REPORT_FILE);
+        - \p --seed=N - начальное значение генератора свойств (см. #UT_SEED);
+        - \p --fuzz=N - количество мутированных входов каждой цели фаззинга (см. #UT_FUZZ_RUNS).
+        Остальные параметры сохраняются в исходном порядке
+    \param[in,out] argc указатель на количество параметров
+    \param[in,out] argv массив параметров
+    \protected
+*/
+static inline void __ut_parse_arguments(int *argc, char **argv)
+{
+    int kept = 1;
+
+    for (int i = 1; i < *argc; ++i)
+    {
+        const char *argument = argv[i];
+
+#ifdef UT_ENABLE_FILTER
+        if (strncmp(argument, "--filter=", 9) == 0)
+        {
+            __ut_filter_compile(argument + 9);
+            continue;
+        }
+#endif
+#ifdef UT_ENABLE_FAIL_FAST
+        if (strncmp(argument, "--max-failures=", 15) == 0)
+        {
+            __ut_fail_fast_set(strtoul(argument + 15, NULL, 10));
+            continue;
+        }
+        if (strcmp(argument, "--fail-fast") == 0)
+        {
+            __ut_fail_fast_set(1);
+            continue;
+        }
+#endif
+#ifdef UT_ENABLE_FAILED_FIRST
+        if (strcmp(argument, "--failed-first") == 0)
+        {
+            __ut_failed_set_mode(false);
+            continue;
+        }
+        if (strcmp(argument, "--failed-only") == 0)
+        {
+            __ut_failed_set_mode(true);
+            continue;
+        }
+#endif
+#ifdef UT_ENABLE_REPORTER
+        if (strncmp(argument, "--report=", 9) == 0)
+        {
+            __ut_report_set(argument + 9, NULL);
+            continue;
+        }
+        if (strncmp(argument, "--report-file=", 14) == 0)
+        {
+            __ut_report_set(NULL, argument + 14);
+            continue;
+        }
+#endif
+#ifdef UT_ENABLE_PROPERTY
+        if (strncmp(argument, "--seed=", 7) == 0)
+        {
+            __ut_prop_set_seed(strtoull(argument + 7, NULL, 0));
+            continue;
+        }
+#endif
+#ifdef UT_ENABLE_FUZZ
+        if (strncmp(argument, "--fuzz=", 7) == 0)
+        {
+            __ut_fuzz_set_runs(strtoul(argument + 7, NULL, 10));
+            continue;
+        }
+#endif
+
+        argv[kept++] = argv[i];
+        (void)argument;
+    }
+
+    if (*argc > 0)
+    {
+        *argc = kept;
+        argv[kept] = NULL;
+    }
+}
+
+/*!
+    \brief     Разобрать параметры командной строки
+    \param[in,out] argc количество параметров (переменная)
+    \param[in,out] argv массив параметров
+    \see       __ut_parse_arguments
+*/
+#define UT_PARSE_ARGUMENTS(argc, argv) __ut_parse_arguments(&(argc), (argv))
+
+#else
+
+#define UT_PARSE_ARGUMENTS(argc, argv) ((void)(argc), (void)(argv))
+
+#endif
+
 
 #ifdef __cplusplus
 }
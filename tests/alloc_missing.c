@@ -0,0 +1,37 @@
+/*!
+    \file      alloc_missing.c
+    \brief     Программа с проверкой выделений памяти, но без перехватчиков распределителя
+    \details   Не должна компоноваться: ни одна единица трансляции не определяет
+        UT_ALLOC_IMPLEMENTATION (см. тест alloc_missing)
+*/
+
+
+#include "microut.h"
+
+
+void tests_on_failed_assert(const char *name, const char *message)
+{
+    printf("  %s: %s\n", name, message);
+}
+
+void tests_on_test(const char *name, bool successed, unsigned int performed_count)
+{
+    printf("%s %s (%u asserts)\n", successed ? "ok  " : "FAIL", name, performed_count);
+}
+
+
+UT_STARTUP(missing) { (void)desc; }
+UT_TEARDOWN(missing) { (void)desc; }
+UT_BEFORE_EACH(missing) { (void)desc; }
+UT_AFTER_EACH(missing) { (void)desc; }
+
+UT_TEST(missing, none) { UT_ASSERT_NO_ALLOC({ volatile int x = 1; (void)x; }); }
+
+UT_DECLARE_TEST_SUITE(missing, "missing",
+    UT_ADD_TEST(missing, none, "no allocations"),
+    UT_TEST_SUITE_END)
+
+int main(void)
+{
+    return UT_RUN_TEST_SUITE(missing) ? 0 : 1;
+}
@@ -0,0 +1,48 @@
+/*!
+    \file      config.h
+    \brief     Настройки microut для тестов самого microut
+*/
+
+
+#ifndef __MICROUT_TESTS_CONFIG_H
+#define __MICROUT_TESTS_CONFIG_H
+
+
+#include <stdbool.h>
+#include <stdio.h>
+
+
+#define UT_BUFFER_SIZE 256
+
+// Программа тестов может переопределить обработчик успешной проверки
+#ifndef UT_ON_SUCCESSFUL_ASSERT
+#define UT_ON_SUCCESSFUL_ASSERT(desc, message) ((void)(desc), (void)(message))
+#endif
+#define UT_ON_FAILED_ASSERT(desc, message) tests_on_failed_assert(UT_TEST_NAME(desc), (message))
+#define UT_ON_SUCCESSFUL_TEST(test_state) \
+    tests_on_test(UT_TEST_NAME(test_state), UT_IS_TEST_SUCCESSED(test_state), (test_state)->performed_count)
+#define UT_ON_FAILED_TEST(test_state) \
+    tests_on_test(UT_TEST_NAME(test_state), UT_IS_TEST_SUCCESSED(test_state), (test_state)->performed_count)
+#define UT_ON_SKIPPED_TEST(test_state, reason) \
+    printf("skip %s (%s)%s\n", UT_TEST_NAME(test_state), (reason), UT_IS_TEST_SKIPPED(test_state) ? "" : " [started]")
+
+/*!
+    \brief     Обработать неуспешную проверку
+    \details   Определяется каждой программой тестов; может вызываться
+        одновременно из разных потоков
+    \param[in] name    указатель на строку, наименование теста или набора тестов
+    \param[in] message указатель на строку-сообщение
+*/
+void tests_on_failed_assert(const char *name, const char *message);
+
+/*!
+    \brief     Обработать результат теста
+    \details   Определяется каждой программой тестов; вызывается из потока, запустившего набор тестов
+    \param[in] name            указатель на строку, наименование теста
+    \param[in] successed       флаг успешности теста (#UT_IS_TEST_SUCCESSED)
+    \param[in] performed_count количество запущенных проверок теста
+*/
+void tests_on_test(const char *name, bool successed, unsigned int performed_count);
+
+
+#endif  // __MICROUT_TESTS_CONFIG_H
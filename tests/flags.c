@@ -0,0 +1,1422 @@
+/*!
+    \file      flags.c
+    \brief     Набор тестов, собираемый с каждой возможностью UT_ENABLE_* по отдельности
+    \details   Кроме общего набора тестов, проверяет поведение включенной возможности
+*/
+
+
+#define UT_ALLOC_IMPLEMENTATION
+#ifdef UT_ENABLE_ASSERT_EVENTS
+#include <stdbool.h>
+
+void tests_on_successful_assert(const char *message);
+#define UT_ON_SUCCESSFUL_ASSERT(desc, message) ((void)(desc), tests_on_successful_assert(message))
+#endif
+#include "microut.h"
+
+#include <string.h>
+
+#ifdef UT_ENABLE_LEAK_CHECK
+#include <pthread.h>
+#endif
+#ifdef UT_ENABLE_FORK
+#include <signal.h>
+#endif
+#ifdef UT_ENABLE_FUZZ
+#include <dirent.h>
+#endif
+#if defined(UT_ENABLE_BASELINE) || defined(UT_ENABLE_FAILED_FIRST) || defined(UT_ENABLE_TIMING_CACHE) \
+    || defined(UT_ENABLE_PARALLEL) || defined(UT_ENABLE_FORK) || defined(UT_ENABLE_FUZZ) \
+    || defined(UT_ENABLE_REPORTER) || defined(UT_ENABLE_PERF_COUNTERS)
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+
+static bool successed = true;
+
+#define CHECK(condition) do {                           \
+        if (!(condition))                               \
+        {                                               \
+            printf("check failed: %s\n", #condition);   \
+            successed = false;                          \
+        }                                               \
+    } while (0)
+
+
+//! Сообщение последней неуспешной проверки
+static char last_failure[UT_BUFFER_SIZE];
+//! Наименования тестов и сообщения всех неуспешных проверок, по строке на проверку
+static char failures[4096];
+
+void tests_on_failed_assert(const char *name, const char *message)
+{
+    printf("  %s: %s\n", name, message);
+    snprintf(last_failure, sizeof(last_failure), "%s", message);
+    const size_t length = strlen(failures);
+    snprintf(failures + length, sizeof(failures) - length, "%s: %s\n", name, message);
+}
+
+//! Количество успешных тестов, о которых сообщил обработчик, с проверками, учтенными к его вызову
+static unsigned int hook_successed_count, hook_performed_count;
+
+//! Наименования тестов в порядке вызова обработчика результата
+static char hook_order[UT_BUFFER_SIZE];
+
+void tests_on_test(const char *name, bool test_successed, unsigned int performed_count)
+{
+    printf("%s %s\n", test_successed ? "ok  " : "FAIL", name);
+    strncat(hook_order, name, sizeof(hook_order) - strlen(hook_order) - 2);
+    strcat(hook_order, " ");
+    if (test_successed)
+    {
+        ++hook_successed_count;
+        hook_performed_count += performed_count;
+    }
+}
+
+
+UT_STARTUP(flags) { UT_ASSERT(UT_IS_TEST_SUITE_STARTED(desc), "startup"); }
+UT_TEARDOWN(flags) { (void)desc; }
+UT_BEFORE_EACH(flags) { UT_ASSERT(UT_IS_TEST_STARTED(desc) && !UT_IS_TEST_SKIPPED(desc), "before each"); }
+UT_AFTER_EACH(flags) { (void)desc; }
+
+UT_TEST(flags, assert) { UT_ASSERT(1 == 1, "assert"); }
+UT_TEST(flags, equals) { UT_DECIMAL_EQUALS(2 + 2, 4, "equals"); }
+// Функция теста получает состояние теста со сведениями о тесте
+UT_TEST(flags, state)
+{
+    UT_ASSERT(strcmp(UT_TEST_NAME(desc), "state") == 0 && UT_TEST_DESC(desc)->file != NULL && UT_TEST_DESC(desc)->line > 0, "test name");
+    UT_ASSERT(UT_TEST_DESC(desc)->func != NULL && UT_TEST_DESC(desc)->name == UT_TEST_NAME(desc), "test structure");
+}
+
+#ifndef UT_ENABLE_AUTO_REGISTRATION
+UT_DECLARE_TEST_SUITE(flags, "flags",
+    UT_ADD_TEST(flags, assert, "assert"),
+    UT_ADD_TEST(flags, equals, "equals"),
+    UT_ADD_TEST(flags, state, "state"),
+    UT_TEST_SUITE_END)
+#else
+UT_REGISTER_TEST_SUITE(flags, "flags")
+#endif
+
+/*!
+    \brief     Найти состояние теста по наименованию
+    \param[in] test_suite_desc указатель на структуру выполненного набора тестов
+    \param[in] name            указатель на строку, наименование теста
+    \return    Указатель на состояние теста; \p NULL, если тест не найден
+*/
+static inline const struct __ut_test_state *find_test(const struct __ut_test_suite_desc *test_suite_desc, const char *name)
+{
+    for (const struct __ut_test_desc *test_desc = test_suite_desc->test_descs; test_desc->func != NULL; ++test_desc)
+    {
+        const struct __ut_test_state *test_state = &(test_suite_desc->test_states[test_desc - test_suite_desc->test_descs]);
+        if (strcmp(UT_TEST_NAME(test_state), name) == 0)
+        {
+            return test_state;
+        }
+    }
+
+    return NULL;
+}
+
+//! Проверить, что тест выполнен и успешен
+#define CHECK_SUCCESSED(test_suite, test) CHECK(find_test(&UT_TEST_SUITE_DESC(test_suite), #test) != NULL \
+    && UT_IS_TEST_SUCCESSED(find_test(&UT_TEST_SUITE_DESC(test_suite), #test)))
+//! Проверить, что тест выполнен и провален
+#define CHECK_FAILED(test_suite, test) CHECK(find_test(&UT_TEST_SUITE_DESC(test_suite), #test) != NULL \
+    && UT_IS_TEST_STARTED(find_test(&UT_TEST_SUITE_DESC(test_suite), #test)) \
+    && UT_IS_TEST_FAILED(find_test(&UT_TEST_SUITE_DESC(test_suite), #test)))
+
+UT_STARTUP(mismatch) { (void)desc; }
+UT_TEARDOWN(mismatch) { (void)desc; }
+UT_BEFORE_EACH(mismatch) { (void)desc; }
+UT_AFTER_EACH(mismatch) { (void)desc; }
+
+//! Элемент массива без числового представления
+struct pair
+{
+    unsigned char first, second;
+};
+
+UT_TEST(mismatch, ints)
+{
+    const int actual[] = { 1, -5, 3 }, expected[] = { 1, 2, 3 };
+    UT_ARRAY_EQUALS(actual, expected, 3, "ints");
+}
+UT_TEST(mismatch, unsigneds)
+{
+    const uint16_t actual[] = { 65535 }, expected[] = { 7 };
+    UT_ARRAY_EQUALS(actual, expected, 1, "unsigneds");
+}
+UT_TEST(mismatch, doubles)
+{
+    const double actual[] = { 0.5, 1.25 }, expected[] = { 0.5, 2.5 };
+    UT_ARRAY_EQUALS(actual, expected, 2, "doubles");
+}
+UT_TEST(mismatch, structs)
+{
+    const struct pair actual[] = { { 0xAB, 0xCD } }, expected[] = { { 0xAB, 0x01 } };
+    UT_ARRAY_EQUALS(actual, expected, 1, "structs");
+}
+// Размер массива не помещается в size_t: память не сравнивается
+UT_TEST(mismatch, overflow)
+{
+    const int actual[] = { 1 }, expected[] = { 1 };
+    UT_ARRAY_EQUALS(actual, expected, SIZE_MAX / 2, "overflow");
+}
+UT_TEST(mismatch, memory)
+{
+    const int actual = 1, expected = 2;
+    UT_MEMORY_EQUALS(&actual, &expected, 1, "memory");
+}
+
+#ifndef UT_ENABLE_AUTO_REGISTRATION
+UT_DECLARE_TEST_SUITE(mismatch, "mismatch",
+    UT_ADD_TEST(mismatch, ints, "ints"),
+    UT_ADD_TEST(mismatch, unsigneds, "unsigneds"),
+    UT_ADD_TEST(mismatch, doubles, "doubles"),
+    UT_ADD_TEST(mismatch, structs, "structs"),
+    UT_ADD_TEST(mismatch, overflow, "overflow"),
+    UT_ADD_TEST(mismatch, memory, "memory"),
+    UT_TEST_SUITE_END)
+#else
+UT_REGISTER_TEST_SUITE(mismatch, "mismatch")
+#endif
+
+/*!
+    \brief     Проверить вывод элементов в сообщениях о несовпадении массивов и памяти
+*/
+static void check_mismatch(void)
+{
+    failures[0] = '\0';
+    CHECK(!UT_RUN_TEST_SUITE(mismatch));
+    CHECK(strstr(failures, "ints (array equality check failed at index 1 of 3: expected 1 [2] 3, got 1 [-5] 3)") != NULL);
+    CHECK(strstr(failures, "expected [7], got [65535]") != NULL);
+    CHECK(strstr(failures, "expected 0.5 [2.5], got 0.5 [1.25]") != NULL);
+    // Элементы без числового представления и области памяти выводятся байтами
+    CHECK(strstr(failures, "expected [AB01], got [ABCD]") != NULL);
+    CHECK(strstr(failures, "overflow (array equality check failed: size of ") != NULL);
+    CHECK(strstr(failures, "elements overflows size_t)") != NULL);
+    CHECK(strstr(failures, "memory (memory equality check failed at offset 0 of 1: expected [02], got [01])") != NULL);
+}
+
+#ifdef UT_ENABLE_PARALLEL
+
+//! Количество одновременно выполняемых тестов и наибольшее из них
+static unsigned int parallel_running, parallel_max_running;
+
+UT_STARTUP(parallel) { (void)desc; }
+UT_TEARDOWN(parallel) { (void)desc; }
+UT_BEFORE_EACH(parallel) { (void)desc; }
+UT_AFTER_EACH(parallel) { (void)desc; }
+
+/*!
+    \brief     Выполняться заданное время, учитывая одновременно выполняемые тесты
+    \param[in] ms время, мс
+*/
+static void parallel_work(long ms)
+{
+    const unsigned int running = __atomic_add_fetch(&parallel_running, 1, __ATOMIC_RELAXED);
+    unsigned int max_running = __atomic_load_n(&parallel_max_running, __ATOMIC_RELAXED);
+    while (running > max_running
+        && !__atomic_compare_exchange_n(&parallel_max_running, &max_running, running, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+
+    const struct timespec delay = { 0, ms * 1000000l };
+    nanosleep(&delay, NULL);
+    __atomic_sub_fetch(&parallel_running, 1, __ATOMIC_RELAXED);
+}
+
+// Первые тесты завершаются последними
+UT_TEST(parallel, p0) { parallel_work(40); UT_ASSERT(true, "p0"); }
+UT_TEST(parallel, p1) { parallel_work(30); UT_ASSERT(true, "p1"); }
+UT_TEST(parallel, p2) { parallel_work(20); UT_ASSERT(true, "p2"); }
+UT_TEST(parallel, p3) { parallel_work(10); UT_ASSERT(false, "expected failure"); }
+
+UT_DECLARE_TEST_SUITE(parallel, "parallel",
+    UT_ADD_TEST(parallel, p0, "p0"),
+    UT_ADD_TEST(parallel, p1, "p1"),
+    UT_ADD_TEST(parallel, p2, "p2"),
+    UT_ADD_TEST(parallel, p3, "p3"),
+    UT_TEST_SUITE_END)
+
+/*!
+    \brief     Проверить параллельный запуск
+    \details   Тесты выполняются одновременно, а результаты учитываются в порядке объявления
+*/
+static void check_parallel(void)
+{
+    hook_order[0] = '\0';
+    CHECK(!UT_RUN_TEST_SUITE_PARALLEL(parallel, 4));
+    CHECK(strcmp(hook_order, "p0 p1 p2 p3 ") == 0);
+    CHECK(parallel_max_running > 1);
+    CHECK_SUCCESSED(parallel, p2);
+    CHECK_FAILED(parallel, p3);
+    CHECK(UT_TEST_SUITE_DESC(parallel).successed_count == 3 && UT_TEST_SUITE_DESC(parallel).performed_count == 4);
+}
+
+#endif  // UT_ENABLE_PARALLEL
+
+#ifdef UT_ENABLE_FORK
+
+//! Переменная, изменяемая тестом в дочернем процессе
+static int fork_global;
+
+UT_STARTUP(fork) { (void)desc; }
+UT_TEARDOWN(fork) { (void)desc; }
+UT_BEFORE_EACH(fork) { (void)desc; }
+UT_AFTER_EACH(fork) { (void)desc; }
+
+UT_TEST(fork, mutate) { fork_global = 1; UT_ASSERT(true, "mutate"); }
+UT_TEST(fork, observe) { UT_ASSERT(fork_global == 0, "state of another test is visible"); }
+UT_TEST(fork, killed) { (void)desc; raise(SIGTERM); }
+UT_TEST(fork, exited) { (void)desc; _exit(3); }
+UT_TEST(fork, after) { UT_ASSERT(true, "after"); }
+
+UT_DECLARE_TEST_SUITE(fork, "fork",
+    UT_ADD_TEST(fork, mutate, "changes a global variable"),
+    UT_ADD_TEST(fork, observe, "does not see the change"),
+    UT_ADD_TEST(fork, killed, "killed by a signal"),
+    UT_ADD_TEST(fork, exited, "exits the process"),
+    UT_ADD_TEST(fork, after, "runs after the crashes"),
+    UT_TEST_SUITE_END)
+
+/*!
+    \brief     Проверить изоляцию тестов в дочерних процессах
+*/
+static void check_fork(void)
+{
+    CHECK(!UT_RUN_TEST_SUITE_FORKED(fork, 1));
+    CHECK_SUCCESSED(fork, mutate);
+    CHECK_SUCCESSED(fork, observe);
+    CHECK_FAILED(fork, killed);
+    CHECK(strstr(failures, "killed: test terminated by signal 15") != NULL);
+    CHECK_FAILED(fork, exited);
+    CHECK(strstr(failures, "exited: test process exited with code 3") != NULL);
+    CHECK_SUCCESSED(fork, after);
+    CHECK(fork_global == 0);
+}
+
+#endif  // UT_ENABLE_FORK
+
+#ifdef UT_ENABLE_PROPERTY
+
+UT_STARTUP(prop) { (void)desc; }
+UT_TEARDOWN(prop) { (void)desc; }
+UT_BEFORE_EACH(prop) { (void)desc; }
+UT_AFTER_EACH(prop) { (void)desc; }
+
+UT_PROPERTY(prop, commutative, UT_GEN_INT(a, -1000, 1000), UT_GEN_INT(b, -1000, 1000))
+{
+    UT_ASSERT(a + b == b + a, "a + b == b + a");
+}
+UT_PROPERTY(prop, small, UT_GEN_INT(x, 0, 1000000), UT_GEN_BOOL(flag))
+{
+    (void)flag;
+    UT_ASSERT(x < 100, "x < 100");
+}
+
+UT_DECLARE_TEST_SUITE(prop, "prop",
+    UT_ADD_TEST(prop, commutative, "holding property"),
+    UT_ADD_TEST(prop, small, "falsified property"),
+    UT_TEST_SUITE_END)
+
+/*!
+    \brief     Проверить поиск и упрощение контрпримера свойства
+*/
+static void check_prop(void)
+{
+    __ut_prop_set_seed(42);
+    failures[0] = '\0';
+    CHECK(!UT_RUN_TEST_SUITE(prop));
+    CHECK_SUCCESSED(prop, commutative);
+    CHECK_FAILED(prop, small);
+    // Контрпример упрощается до наименьшего значения, нарушающего свойство
+    CHECK(strstr(failures, "(UT_SEED=42); x = 100; flag = false") != NULL);
+
+    // То же начальное значение генератора воспроизводит тот же контрпример
+    char first[sizeof(failures)];
+    memcpy(first, failures, sizeof(first));
+    failures[0] = '\0';
+    CHECK(!UT_RUN_TEST_SUITE(prop));
+    CHECK(strcmp(first, failures) == 0);
+}
+
+#endif  // UT_ENABLE_PROPERTY
+
+#ifdef UT_ENABLE_ASSERT_EVENTS
+
+//! Количество проверок events, учтенных сборщиком, и количество из них с чужим сообщением
+static unsigned int events_count, events_mismatched;
+
+void tests_on_successful_assert(const char *message)
+{
+    char expected[32];
+    if (message != NULL && strncmp(message, "item ", 5) == 0)
+    {
+        snprintf(expected, sizeof(expected), "item %u", events_count++);
+        events_mismatched += strcmp(message, expected) != 0;
+    }
+}
+
+UT_STARTUP(events) { (void)desc; }
+UT_TEARDOWN(events) { (void)desc; }
+UT_BEFORE_EACH(events) { (void)desc; }
+UT_AFTER_EACH(events) { (void)desc; }
+
+UT_TEST(events, reused_buffer)
+{
+    char buf[32];
+    for (int i = 0; i < 2000; ++i)
+    {
+        snprintf(buf, sizeof(buf), "item %d", i);
+        UT_ASSERT(true, buf);
+    }
+}
+
+UT_DECLARE_TEST_SUITE(events, "events",
+    UT_ADD_TEST(events, reused_buffer, "message in a reused buffer"),
+    UT_TEST_SUITE_END)
+
+/*!
+    \brief     Проверить, что сборщик получает сообщения успешных проверок из переиспользуемого буфера
+*/
+static void check_events(void)
+{
+    CHECK(UT_RUN_TEST_SUITE(events));
+    CHECK_SUCCESSED(events, reused_buffer);
+    CHECK(events_count == 2000 && events_mismatched == 0);
+}
+
+#endif  // UT_ENABLE_ASSERT_EVENTS
+
+#ifdef UT_ENABLE_ARENA
+
+UT_STARTUP(arena) { (void)desc; }
+UT_TEARDOWN(arena) { (void)desc; }
+UT_BEFORE_EACH(arena) { (void)desc; }
+UT_AFTER_EACH(arena) { (void)desc; }
+
+//! Первые блоки, выделенные тестами в арене
+static void *first_block, *second_block;
+
+UT_TEST(arena, first)
+{
+    first_block = ut_alloc(desc, 1);
+    char *next = (char *)ut_alloc(desc, 100);
+    UT_ASSERT(first_block != NULL && next != NULL, "memory allocated");
+    UT_ASSERT(((uintptr_t)next & 15) == 0 && next != first_block, "aligned distinct blocks");
+    memset(next, 0xAB, 100);
+
+    // Блок больше участка выделяется в отдельном участке
+    char *large = (char *)ut_alloc(desc, UT_ARENA_CHUNK_SIZE + 1);
+    UT_ASSERT(large != NULL, "large memory allocated");
+    if (large != NULL)
+    {
+        large[UT_ARENA_CHUNK_SIZE] = 1;
+    }
+}
+UT_TEST(arena, second)
+{
+    second_block = ut_alloc(desc, 1);
+    UT_ASSERT(second_block != NULL, "memory allocated");
+}
+
+UT_DECLARE_TEST_SUITE(arena, "arena",
+    UT_ADD_TEST(arena, first, "first"),
+    UT_ADD_TEST(arena, second, "second"),
+    UT_TEST_SUITE_END)
+
+/*!
+    \brief     Проверить выделение памяти в арене и ее освобождение после теста
+*/
+static void check_arena(void)
+{
+    CHECK(UT_RUN_TEST_SUITE(arena));
+    CHECK_SUCCESSED(arena, first);
+    CHECK_SUCCESSED(arena, second);
+#if !UT_ARENA_POISON
+    // Память арены освобождается после теста и переиспользуется следующим
+    CHECK(first_block != NULL && first_block == second_block);
+#endif
+    // Вне выполнения теста арена недоступна
+    CHECK(find_test(&UT_TEST_SUITE_DESC(arena), "first")->arena == NULL);
+}
+
+#endif  // UT_ENABLE_ARENA
+
+#ifdef UT_ENABLE_FUZZ
+
+UT_STARTUP(fuzz) { (void)desc; }
+UT_TEARDOWN(fuzz) { (void)desc; }
+UT_BEFORE_EACH(fuzz) { (void)desc; }
+UT_AFTER_EACH(fuzz) { (void)desc; }
+
+UT_FUZZ(fuzz, robust)
+{
+    (void)data;
+    UT_ASSERT(size <= UT_FUZZ_MAX_LEN, "size <= UT_FUZZ_MAX_LEN");
+}
+UT_FUZZ(fuzz, fragile)
+{
+    UT_ASSERT(size == 0 || data[0] < 0xF0, "data[0] < 0xF0");
+}
+
+UT_DECLARE_TEST_SUITE(fuzz, "fuzz",
+    UT_ADD_TEST(fuzz, robust, "robust target"),
+    UT_ADD_TEST(fuzz, fragile, "fragile target"),
+    UT_TEST_SUITE_END)
+
+/*!
+    \brief     Удалить каталог корпуса цели с входами
+    \param[in] path путь к каталогу
+*/
+static void remove_corpus(const char *path)
+{
+    DIR *dir = opendir(path);
+    if (dir == NULL)
+    {
+        return;
+    }
+    for (const struct dirent *entry; (entry = readdir(dir)) != NULL; )
+    {
+        char file[512];
+        if (entry->d_name[0] != '.' && snprintf(file, sizeof(file), "%s/%s", path, entry->d_name) < (int)sizeof(file))
+        {
+            remove(file);
+        }
+    }
+    closedir(dir);
+    remove(path);
+}
+
+/*!
+    \brief     Проверить повтор корпуса и сохранение найденного входа цели фаззинга
+*/
+static void check_fuzz(void)
+{
+    char corpus[64], robust[128], fragile[128];
+    snprintf(corpus, sizeof(corpus), "/tmp/microut-corpus-%d", (int)getpid());
+    snprintf(robust, sizeof(robust), "%s/fuzz.robust", corpus);
+    snprintf(fragile, sizeof(fragile), "%s/fuzz.fragile", corpus);
+    setenv("UT_FUZZ_CORPUS", corpus, 1);
+
+    // Повтор пустого корпуса успешен и не создает каталогов
+    __ut_fuzz_set_runs(0);
+    CHECK(UT_RUN_TEST_SUITE(fuzz));
+    CHECK(access(corpus, F_OK) != 0);
+
+    // Мутированный вход, на котором проверка неуспешна, сохраняется в корпусе цели
+    __ut_fuzz_set_runs(100000);
+    failures[0] = '\0';
+    CHECK(!UT_RUN_TEST_SUITE(fuzz));
+    CHECK_SUCCESSED(fuzz, robust);
+    CHECK_FAILED(fuzz, fragile);
+    char reproducer[256];
+    snprintf(reproducer, sizeof(reproducer), "reproducer: %s/failure-", fragile);
+    CHECK(strstr(failures, reproducer) != NULL);
+
+    // Следующий запуск повторяет найденный вход
+    __ut_fuzz_set_runs(0);
+    failures[0] = '\0';
+    CHECK(!UT_RUN_TEST_SUITE(fuzz));
+    CHECK_FAILED(fuzz, fragile);
+    CHECK(strstr(failures, "fuzz target failed on corpus input") != NULL);
+
+    remove_corpus(robust);
+    remove_corpus(fragile);
+    remove(corpus);
+    unsetenv("UT_FUZZ_CORPUS");
+}
+
+#endif  // UT_ENABLE_FUZZ
+
+#ifdef UT_ENABLE_ALLOC_TRACKING
+
+UT_STARTUP(alloc) { (void)desc; }
+UT_TEARDOWN(alloc) { (void)desc; }
+UT_BEFORE_EACH(alloc) { (void)desc; }
+UT_AFTER_EACH(alloc) { (void)desc; }
+
+UT_TEST(alloc, none) { UT_ASSERT_NO_ALLOC({ volatile int x = 1; (void)x; }); }
+UT_TEST(alloc, within_limit) { UT_ASSERT_MAX_ALLOC_BYTES(64, { free(malloc(32)); }); }
+UT_TEST(alloc, allocates) { UT_ASSERT_NO_ALLOC({ free(malloc(32)); }); }
+UT_TEST(alloc, over_limit) { UT_ASSERT_MAX_ALLOC_BYTES(16, { free(malloc(32)); }); }
+
+UT_DECLARE_TEST_SUITE(alloc, "alloc",
+    UT_ADD_TEST(alloc, none, "no allocations"),
+    UT_ADD_TEST(alloc, within_limit, "allocations within the limit"),
+    UT_ADD_TEST(alloc, allocates, "unexpected allocation"),
+    UT_ADD_TEST(alloc, over_limit, "allocations over the limit"),
+    UT_TEST_SUITE_END)
+
+UT_STARTUP(alloc_inactive) { (void)desc; }
+UT_TEARDOWN(alloc_inactive) { (void)desc; }
+UT_BEFORE_EACH(alloc_inactive) { (void)desc; }
+UT_AFTER_EACH(alloc_inactive) { (void)desc; }
+
+UT_TEST(alloc_inactive, none) { UT_ASSERT_NO_ALLOC({ volatile int x = 1; (void)x; }); }
+
+UT_DECLARE_TEST_SUITE(alloc_inactive, "alloc_inactive",
+    UT_ADD_TEST(alloc_inactive, none, "no allocations without the interposer"),
+    UT_TEST_SUITE_END)
+
+/*!
+    \brief     Проверить учет выделений памяти
+*/
+static void check_alloc(void)
+{
+    CHECK(!UT_RUN_TEST_SUITE(alloc));
+    CHECK_SUCCESSED(alloc, none);
+    CHECK_SUCCESSED(alloc, within_limit);
+    CHECK_FAILED(alloc, allocates);
+    CHECK_FAILED(alloc, over_limit);
+    CHECK(find_test(&UT_TEST_SUITE_DESC(alloc), "over_limit")->alloc_stats.bytes >= 32);
+
+    // Без перехватчиков распределителя проверки не проходят ложно
+    const int probed = __ut_alloc_probed;
+    __ut_alloc_probed = -1;
+    CHECK(!UT_RUN_TEST_SUITE(alloc_inactive));
+    __ut_alloc_probed = probed;
+    CHECK(strstr(last_failure, "allocator is not interposed") != NULL);
+}
+
+#endif  // UT_ENABLE_ALLOC_TRACKING
+
+#ifdef UT_ENABLE_LEAK_CHECK
+
+//! Блок, намеренно не освобожденный тестом
+static void *leaked;
+
+static void *leak_thread_func(void *arg)
+{
+    return arg;
+}
+
+UT_STARTUP(leak) { (void)desc; }
+UT_TEARDOWN(leak) { (void)desc; }
+UT_BEFORE_EACH(leak) { (void)desc; }
+UT_AFTER_EACH(leak) { (void)desc; }
+
+UT_TEST(leak, freed) { void *block = malloc(24); UT_ASSERT(block != NULL, "malloc"); free(block); }
+UT_TEST(leak, leaked) { leaked = malloc(24); UT_ASSERT(leaked != NULL, "malloc"); }
+UT_TEST(leak, ignored)
+{
+    void *block = malloc(24);
+    UT_ASSERT(block != NULL, "malloc");
+    UT_LEAK_CHECK_IGNORE(block);
+    free(block);
+}
+// Память потока, сохраняемая загрузчиком для следующих потоков, утечкой не является
+UT_TEST(leak, thread)
+{
+    pthread_t thread;
+    UT_ASSERT(pthread_create(&thread, NULL, leak_thread_func, NULL) == 0, "pthread_create");
+    pthread_join(thread, NULL);
+}
+
+UT_DECLARE_TEST_SUITE(leak, "leak",
+    UT_ADD_TEST(leak, freed, "freed block"),
+    UT_ADD_TEST(leak, leaked, "leaked block"),
+    UT_ADD_TEST(leak, ignored, "ignored block"),
+    UT_ADD_TEST(leak, thread, "thread creation"),
+    UT_TEST_SUITE_END)
+
+/*!
+    \brief     Проверить поиск утечек
+*/
+static void check_leak(void)
+{
+    failures[0] = '\0';
+    CHECK(!UT_RUN_TEST_SUITE(leak));
+    CHECK_SUCCESSED(leak, freed);
+    CHECK_FAILED(leak, leaked);
+    // Место выделения выводится несколькими кадрами стека вызовов
+    CHECK(strstr(failures, "memory leak: 1 blocks, 24 bytes; 24 bytes at ") != NULL);
+    CHECK(strstr(failures, " <- ") != NULL);
+    CHECK_SUCCESSED(leak, ignored);
+    CHECK_SUCCESSED(leak, thread);
+    free(leaked);
+}
+
+#endif  // UT_ENABLE_LEAK_CHECK
+
+#ifdef UT_ENABLE_BENCH
+
+UT_STARTUP(bench) { (void)desc; }
+UT_TEARDOWN(bench) { (void)desc; }
+UT_BEFORE_EACH(bench) { (void)desc; }
+UT_AFTER_EACH(bench) { (void)desc; }
+
+UT_BENCH(bench, sum)
+{
+    unsigned long sum = 0;
+    UT_BENCH_LOOP
+    {
+        sum += __ut_i;
+        UT_BENCH_KEEP(sum);
+    }
+    UT_ASSERT(true, "sum");
+}
+UT_TEST(bench, test) { UT_ASSERT(UT_TEST_DESC(desc)->bench == NULL, "test is not a benchmark"); }
+
+UT_DECLARE_TEST_SUITE(bench, "bench",
+    UT_ADD_BENCH(bench, sum, "summation loop"),
+    UT_ADD_TEST(bench, test, "plain test"),
+    UT_TEST_SUITE_END)
+
+/*!
+    \brief     Проверить замеры бенчмарка
+*/
+static void check_bench(void)
+{
+    CHECK(UT_RUN_TEST_SUITE(bench));
+    CHECK_SUCCESSED(bench, sum);
+    CHECK_SUCCESSED(bench, test);
+
+    const struct __ut_bench_stats *stats = UT_TEST_SUITE_DESC(bench).test_descs[0].bench;
+    CHECK(stats != NULL && stats->iterations > 0 && stats->samples_count == UT_BENCH_SAMPLES);
+    CHECK(stats != NULL && stats->min <= stats->median && stats->median <= stats->p90
+        && stats->p90 <= stats->p99 && stats->p99 <= stats->max);
+}
+
+#endif  // UT_ENABLE_BENCH
+
+#ifdef UT_ENABLE_PERF_COUNTERS
+
+UT_STARTUP(perf) { (void)desc; }
+UT_TEARDOWN(perf) { (void)desc; }
+UT_BEFORE_EACH(perf) { (void)desc; }
+UT_AFTER_EACH(perf) { (void)desc; }
+
+UT_TEST(perf, loop)
+{
+    volatile unsigned long sum = 0;
+    for (unsigned long i = 0; i < 100000; ++i)
+    {
+        sum += i;
+    }
+    UT_ASSERT(sum > 0, "sum > 0");
+}
+
+UT_DECLARE_TEST_SUITE(perf, "perf",
+    UT_ADD_TEST(perf, loop, "loop"),
+    UT_TEST_SUITE_END)
+
+/*!
+    \brief     Проверить согласованность показаний счетчиков с маской доступных
+    \param[in] perf_counters указатель на показания счетчиков
+*/
+static void check_perf_counters(const struct __ut_perf_counters *perf_counters)
+{
+    const unsigned int available = perf_counters->available;
+
+    CHECK((available & UT_PERF_CYCLES) != 0 || perf_counters->cycles == 0);
+    CHECK((available & UT_PERF_INSTRUCTIONS) != 0 || perf_counters->instructions == 0);
+    CHECK((available & UT_PERF_BRANCH_MISSES) != 0 || perf_counters->branch_misses == 0);
+    CHECK((available & UT_PERF_L1D_MISSES) != 0 || perf_counters->l1d_misses == 0);
+    CHECK((available & UT_PERF_LLC_MISSES) != 0 || perf_counters->llc_misses == 0);
+    // Цикл теста выполняет не меньше инструкций, чем итераций
+    CHECK((available & UT_PERF_INSTRUCTIONS) == 0 || perf_counters->instructions >= 100000);
+}
+
+/*!
+    \brief     Проверить показания аппаратных счетчиков, в том числе при недоступном perf
+*/
+static void check_perf(void)
+{
+    // Счетчики могут быть недоступны (виртуальная машина, perf_event_paranoid), тест выполняется
+    CHECK(UT_RUN_TEST_SUITE(perf));
+    CHECK_SUCCESSED(perf, loop);
+    check_perf_counters(&find_test(&UT_TEST_SUITE_DESC(perf), "loop")->perf_counters);
+
+    // Группа, в которой не открылся ни один счетчик: тест выполняется без показаний
+    const struct __ut_perf_group group = __ut_perf_group;
+    __ut_perf_group.pid = getpid();
+    __ut_perf_group.count = 0;
+    CHECK(UT_RUN_TEST_SUITE(perf));
+    CHECK_SUCCESSED(perf, loop);
+    const struct __ut_perf_counters *perf_counters = &find_test(&UT_TEST_SUITE_DESC(perf), "loop")->perf_counters;
+    CHECK(perf_counters->available == 0);
+    check_perf_counters(perf_counters);
+    __ut_perf_group = group;
+}
+
+#endif  // UT_ENABLE_PERF_COUNTERS
+
+#ifdef UT_ENABLE_BASELINE
+
+//! Задержка теста \p slowed, мс
+static unsigned int baseline_delay_ms;
+
+UT_STARTUP(baseline) { (void)desc; }
+UT_TEARDOWN(baseline) { (void)desc; }
+UT_BEFORE_EACH(baseline) { (void)desc; }
+UT_AFTER_EACH(baseline) { (void)desc; }
+
+UT_TEST(baseline, steady) { UT_ASSERT(true, "steady"); }
+UT_TEST(baseline, slowed)
+{
+    const struct timespec delay = { 0, (long)baseline_delay_ms * 1000000l };
+    nanosleep(&delay, NULL);
+    UT_ASSERT(true, "slowed");
+}
+
+UT_DECLARE_TEST_SUITE(baseline, "baseline",
+    UT_ADD_TEST(baseline, steady, "steady test"),
+    UT_ADD_TEST(baseline, slowed, "test slowed down after the baseline was saved"),
+    UT_TEST_SUITE_END)
+
+UT_STARTUP(baseline_many) { (void)desc; }
+UT_TEARDOWN(baseline_many) { (void)desc; }
+UT_BEFORE_EACH(baseline_many) { (void)desc; }
+UT_AFTER_EACH(baseline_many) { (void)desc; }
+
+UT_TEST(baseline_many, a) { UT_ASSERT(true, "a"); }
+UT_TEST(baseline_many, b) { UT_ASSERT(true, "b"); }
+UT_TEST(baseline_many, c) { UT_ASSERT(true, "c"); }
+UT_TEST(baseline_many, d) { UT_ASSERT(true, "d"); }
+UT_TEST(baseline_many, e) { UT_ASSERT(true, "e"); }
+UT_TEST(baseline_many, f) { UT_ASSERT(true, "f"); }
+
+UT_DECLARE_TEST_SUITE(baseline_many, "baseline_many",
+    UT_ADD_TEST(baseline_many, a, "a"),
+    UT_ADD_TEST(baseline_many, b, "b"),
+    UT_ADD_TEST(baseline_many, c, "c"),
+    UT_ADD_TEST(baseline_many, d, "d"),
+    UT_ADD_TEST(baseline_many, e, "e"),
+    UT_ADD_TEST(baseline_many, f, "f"),
+    UT_TEST_SUITE_END)
+
+/*!
+    \brief     Проверить сравнение тестов с сохраненной базовой линией
+*/
+static void check_baseline(void)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/microut-baseline-%d", (int)getpid());
+    setenv("UT_BASELINE", path, 1);
+
+    // Первый запуск сохраняет базовую линию
+    CHECK(UT_RUN_TEST_SUITE(baseline));
+    const struct __ut_test_suite_desc *test_suite_desc = &UT_TEST_SUITE_DESC(baseline);
+    CHECK(__ut_baseline_find(__ut_test_name_key(test_suite_desc, &test_suite_desc->test_descs[1]),
+        __ut_baseline.count) != NULL);
+
+    // Базовая линия читается из файла заново
+    free(__ut_baseline.records);
+    memset(&__ut_baseline, 0, sizeof(__ut_baseline));
+
+    baseline_delay_ms = 20;
+    CHECK(!UT_RUN_TEST_SUITE(baseline));
+    CHECK_SUCCESSED(baseline, steady);
+    CHECK_FAILED(baseline, slowed);
+    CHECK(strstr(last_failure, "test slower than baseline") != NULL);
+    CHECK(find_test(test_suite_desc, "slowed")->baseline_delta > UT_BASELINE_TEST_THRESHOLD);
+
+    // Запись теста, уже бывшего в базовой линии, не дублируется и не перезаписывается
+    const struct __ut_test_suite_desc *many_desc = &UT_TEST_SUITE_DESC(baseline_many);
+    CHECK(UT_RUN_TEST_SUITE(baseline_many));
+    for (unsigned int saved = 0; saved < 6; ++saved)
+    {
+        struct __ut_baseline_record *records =
+            (struct __ut_baseline_record *)realloc(__ut_baseline.records, sizeof(struct __ut_baseline_record));
+        if (records == NULL)
+        {
+            break;
+        }
+        const uint64_t key = __ut_test_name_key(many_desc, &many_desc->test_descs[saved]);
+        memset(records, 0, sizeof(*records));
+        records->key = key;
+        records->samples_count = 1;
+        records->samples[0] = 1e12;
+        __ut_baseline.records = records;
+        __ut_baseline.count = __ut_baseline.capacity = 1;
+
+        __ut_baseline_update(many_desc, 6);
+        CHECK(__ut_baseline.count == 6);
+        for (size_t i = 0; i < __ut_baseline.count; ++i)
+        {
+            CHECK(i == 0 || __ut_baseline.records[i - 1].key < __ut_baseline.records[i].key);
+            CHECK((__ut_baseline.records[i].key == key) == (__ut_baseline.records[i].samples[0] == 1e12));
+        }
+    }
+
+    // Файл с количеством замеров записи больше ее вместимости считается поврежденным
+    FILE *file = fopen(path, "wb");
+    CHECK(file != NULL);
+    if (file != NULL)
+    {
+        const uint64_t samples_capacity = __UT_BASELINE_SAMPLES, count = 1;
+        struct __ut_baseline_record record;
+        memset(&record, 0, sizeof(record));
+        record.samples_count = __UT_BASELINE_SAMPLES + 1000000;
+        fwrite(__ut_baseline_magic, sizeof(__ut_baseline_magic), 1, file);
+        fwrite(&samples_capacity, sizeof(samples_capacity), 1, file);
+        fwrite(&count, sizeof(count), 1, file);
+        fwrite(&record, sizeof(record), 1, file);
+        fclose(file);
+    }
+    free(__ut_baseline.records);
+    memset(&__ut_baseline, 0, sizeof(__ut_baseline));
+    __ut_baseline_load();
+    CHECK(__ut_baseline.count == 0);
+
+    remove(path);
+    unsetenv("UT_BASELINE");
+}
+
+#endif  // UT_ENABLE_BASELINE
+
+#ifdef UT_ENABLE_SHARDING
+
+UT_STARTUP(shard) { (void)desc; }
+UT_TEARDOWN(shard) { (void)desc; }
+UT_BEFORE_EACH(shard) { (void)desc; }
+UT_AFTER_EACH(shard) { (void)desc; }
+
+UT_TEST(shard, t0) { UT_ASSERT(true, "t0"); }
+UT_TEST(shard, t1) { UT_ASSERT(true, "t1"); }
+UT_TEST(shard, t2) { UT_ASSERT(true, "t2"); }
+UT_TEST(shard, t3) { UT_ASSERT(true, "t3"); }
+UT_TEST(shard, t4) { UT_ASSERT(true, "t4"); }
+UT_TEST(shard, t5) { UT_ASSERT(true, "t5"); }
+UT_TEST(shard, t6) { UT_ASSERT(true, "t6"); }
+UT_TEST(shard, t7) { UT_ASSERT(true, "t7"); }
+
+UT_DECLARE_TEST_SUITE(shard, "shard",
+    UT_ADD_TEST(shard, t0, "t0"),
+    UT_ADD_TEST(shard, t1, "t1"),
+    UT_ADD_TEST(shard, t2, "t2"),
+    UT_ADD_TEST(shard, t3, "t3"),
+    UT_ADD_TEST(shard, t4, "t4"),
+    UT_ADD_TEST(shard, t5, "t5"),
+    UT_ADD_TEST(shard, t6, "t6"),
+    UT_ADD_TEST(shard, t7, "t7"),
+    UT_TEST_SUITE_END)
+
+//! Количество тестов набора \p shard
+#define SHARD_TEST_COUNT 8
+
+/*!
+    \brief     Проверить разбиение тестов на части
+    \details   Каждый тест выполняется ровно в одной части, и разбиение не меняется между запусками
+*/
+static void check_shard(void)
+{
+    unsigned int runs[SHARD_TEST_COUNT] = { 0 };
+    unsigned int first_part[SHARD_TEST_COUNT] = { 0 };
+
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        for (unsigned long index = 0; index < 3; ++index)
+        {
+            __ut_shard.total = 3;
+            __ut_shard.index = index;
+            CHECK(UT_RUN_TEST_SUITE(shard));
+
+            for (unsigned int i = 0; i < SHARD_TEST_COUNT; ++i)
+            {
+                if (!UT_IS_TEST_STARTED(&UT_TEST_SUITE_DESC(shard).test_states[i]))
+                {
+                    continue;
+                }
+                CHECK(UT_IS_TEST_SUCCESSED(&UT_TEST_SUITE_DESC(shard).test_states[i]));
+                ++runs[i];
+                if (pass == 0)
+                {
+                    first_part[i] = (unsigned int)index;
+                }
+                else
+                {
+                    CHECK(first_part[i] == index);
+                }
+            }
+        }
+    }
+    __ut_shard.total = __ut_shard.index = 0;
+
+    for (unsigned int i = 0; i < SHARD_TEST_COUNT; ++i)
+    {
+        CHECK(runs[i] == 2);
+    }
+}
+
+#endif  // UT_ENABLE_SHARDING
+
+#ifdef UT_ENABLE_FILTER
+
+UT_STARTUP(filter) { (void)desc; }
+UT_TEARDOWN(filter) { (void)desc; }
+UT_BEFORE_EACH(filter) { (void)desc; }
+UT_AFTER_EACH(filter) { (void)desc; }
+
+UT_TEST(filter, kept) { UT_ASSERT(true, "kept"); }
+UT_TEST(filter, kept_slow) { UT_ASSERT(false, "excluded test was run"); }
+UT_TEST(filter, dropped) { UT_ASSERT(false, "excluded test was run"); }
+
+UT_DECLARE_TEST_SUITE(filter, "filter",
+    UT_ADD_TEST(filter, kept, "matches the positive pattern"),
+    UT_ADD_TEST(filter, kept_slow, "matches the negative pattern"),
+    UT_ADD_TEST(filter, dropped, "matches no pattern"),
+    UT_TEST_SUITE_END)
+
+/*!
+    \brief     Проверить выбор тестов фильтром из командной строки
+*/
+static void check_filter(void)
+{
+    char program[] = "flags", filter[] = "--filter=filter.kept*-*_slow", other[] = "--other";
+    char *argv[] = { program, filter, other, NULL };
+    int argc = 3;
+    UT_PARSE_ARGUMENTS(argc, argv);
+    CHECK(argc == 2 && strcmp(argv[1], "--other") == 0);
+
+    CHECK(UT_RUN_TEST_SUITE(filter));
+    CHECK_SUCCESSED(filter, kept);
+    CHECK(!UT_IS_TEST_STARTED(find_test(&UT_TEST_SUITE_DESC(filter), "kept_slow")));
+    CHECK(!UT_IS_TEST_STARTED(find_test(&UT_TEST_SUITE_DESC(filter), "dropped")));
+
+    __ut_filter_compile(NULL);
+}
+
+#endif  // UT_ENABLE_FILTER
+
+#ifdef UT_ENABLE_TIMING_CACHE
+
+UT_STARTUP(timing) { (void)desc; }
+UT_TEARDOWN(timing) { (void)desc; }
+UT_BEFORE_EACH(timing) { (void)desc; }
+UT_AFTER_EACH(timing) { (void)desc; }
+
+/*!
+    \brief     Выполняться не менее заданного времени
+    \param[in] ms время, мс
+*/
+static void timing_sleep(long ms)
+{
+    const struct timespec delay = { 0, ms * 1000000l };
+    nanosleep(&delay, NULL);
+}
+
+UT_TEST(timing, fast) { UT_ASSERT(true, "fast"); }
+UT_TEST(timing, slow) { timing_sleep(20); UT_ASSERT(true, "slow"); }
+UT_TEST(timing, medium) { timing_sleep(5); UT_ASSERT(true, "medium"); }
+
+UT_DECLARE_TEST_SUITE(timing, "timing",
+    UT_ADD_TEST(timing, fast, "fast"),
+    UT_ADD_TEST(timing, slow, "slow"),
+    UT_ADD_TEST(timing, medium, "medium"),
+    UT_TEST_SUITE_END)
+
+UT_STARTUP(timing_many) { (void)desc; }
+UT_TEARDOWN(timing_many) { (void)desc; }
+UT_BEFORE_EACH(timing_many) { (void)desc; }
+UT_AFTER_EACH(timing_many) { (void)desc; }
+
+UT_TEST(timing_many, a) { UT_ASSERT(true, "a"); }
+UT_TEST(timing_many, b) { UT_ASSERT(true, "b"); }
+UT_TEST(timing_many, c) { UT_ASSERT(true, "c"); }
+UT_TEST(timing_many, d) { UT_ASSERT(true, "d"); }
+UT_TEST(timing_many, e) { UT_ASSERT(true, "e"); }
+UT_TEST(timing_many, f) { UT_ASSERT(true, "f"); }
+
+UT_DECLARE_TEST_SUITE(timing_many, "timing_many",
+    UT_ADD_TEST(timing_many, a, "a"),
+    UT_ADD_TEST(timing_many, b, "b"),
+    UT_ADD_TEST(timing_many, c, "c"),
+    UT_ADD_TEST(timing_many, d, "d"),
+    UT_ADD_TEST(timing_many, e, "e"),
+    UT_ADD_TEST(timing_many, f, "f"),
+    UT_TEST_SUITE_END)
+
+/*!
+    \brief     Сбросить кэш длительностей, чтобы он загрузился из файла заново
+*/
+static void timing_reset(void)
+{
+    free(__ut_timing_cache.timings);
+    const bool save_registered = __ut_timing_cache.save_registered;
+    memset(&__ut_timing_cache, 0, sizeof(__ut_timing_cache));
+    __ut_timing_cache.save_registered = save_registered;
+}
+
+/*!
+    \brief     Проверить упорядочивание тестов по кэшу длительностей
+    \details   Кэш обновляет и сохраняет (при завершении программы) параллельный
+        исполнитель; здесь это делается явно
+*/
+static void check_timing_cache(void)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/microut-timing-%d", (int)getpid());
+    setenv("UT_TIMING_CACHE", path, 1);
+    timing_reset();
+
+    const struct __ut_test_suite_desc *test_suite_desc = &UT_TEST_SUITE_DESC(timing);
+    unsigned int order[3];
+
+    // Тесты, отсутствующие в кэше, выдаются в порядке объявления
+    __ut_timing_order(test_suite_desc, 3, order);
+    CHECK(order[0] == 0 && order[1] == 1 && order[2] == 2);
+
+    CHECK(UT_RUN_TEST_SUITE(timing));
+    __ut_timing_cache_update(test_suite_desc, 3);
+    __ut_timing_cache_save();
+
+    // Кэш, прочитанный из файла, упорядочивает тесты по убыванию длительности
+    timing_reset();
+    __ut_timing_order(test_suite_desc, 3, order);
+    CHECK(order[0] == 1 && order[1] == 2 && order[2] == 0);
+    CHECK(__ut_timing_cache.count == 3);
+
+    // Записи тестов, исчезнувших из набора, удаляются
+    __ut_timing_cache_update(test_suite_desc, 1);
+    CHECK(__ut_timing_cache.count == 1);
+
+    // Тест, уже бывший в кэше, не дублируется при добавлении новых записей
+    const struct __ut_test_suite_desc *many_desc = &UT_TEST_SUITE_DESC(timing_many);
+    timing_reset();
+    __ut_timing_cache_load();
+    CHECK(UT_RUN_TEST_SUITE(timing_many));
+    for (unsigned int cached = 0; cached < 6; ++cached)
+    {
+        const uint64_t key = __ut_test_name_key(many_desc, &many_desc->test_descs[cached]);
+        __ut_timing_cache.timings = (struct __ut_timing *)realloc(__ut_timing_cache.timings, sizeof(struct __ut_timing));
+        __ut_timing_cache.timings[0].key = key;
+        __ut_timing_cache.timings[0].suite_key = 0;
+        __ut_timing_cache.timings[0].wall_ns = 0;
+        __ut_timing_cache.count = __ut_timing_cache.capacity = 1;
+
+        __ut_timing_cache_update(many_desc, 6);
+        CHECK(__ut_timing_cache.count == 6);
+        for (size_t i = 1; i < __ut_timing_cache.count; ++i)
+        {
+            CHECK(__ut_timing_cache.timings[i - 1].key < __ut_timing_cache.timings[i].key);
+        }
+    }
+
+    timing_reset();
+    remove(path);
+    unsetenv("UT_TIMING_CACHE");
+}
+
+#endif  // UT_ENABLE_TIMING_CACHE
+
+#ifdef UT_ENABLE_FAILED_FIRST
+
+//! Флаг провала теста \p flaky
+static bool failed_first_fail;
+//! Наименования тестов в порядке запуска
+static char failed_first_order[64];
+
+UT_STARTUP(failed_first) { (void)desc; }
+UT_TEARDOWN(failed_first) { (void)desc; }
+UT_BEFORE_EACH(failed_first)
+{
+    strncat(failed_first_order, UT_TEST_NAME(desc), sizeof(failed_first_order) - strlen(failed_first_order) - 2);
+    strcat(failed_first_order, " ");
+}
+UT_AFTER_EACH(failed_first) { (void)desc; }
+
+UT_TEST(failed_first, first) { UT_ASSERT(true, "first"); }
+UT_TEST(failed_first, flaky) { UT_ASSERT(!failed_first_fail, "expected failure"); }
+UT_TEST(failed_first, last) { UT_ASSERT(true, "last"); }
+
+UT_DECLARE_TEST_SUITE(failed_first, "failed_first",
+    UT_ADD_TEST(failed_first, first, "first"),
+    UT_ADD_TEST(failed_first, flaky, "failed in the previous run"),
+    UT_ADD_TEST(failed_first, last, "last"),
+    UT_TEST_SUITE_END)
+
+/*!
+    \brief     Сбросить множество проваленных тестов, чтобы оно загрузилось из файла заново
+*/
+static void failed_first_reset(void)
+{
+    free(__ut_failed.keys);
+    const bool save_registered = __ut_failed.save_registered;
+    memset(&__ut_failed, 0, sizeof(__ut_failed));
+    __ut_failed.save_registered = save_registered;
+}
+
+/*!
+    \brief     Проверить повторный запуск проваленных тестов
+    \details   Множество проваленных тестов сохраняется явно: при завершении
+        программы оно сохраняется само
+*/
+static void check_failed_first(void)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/microut-failed-%d", (int)getpid());
+    setenv("UT_FAILED_FILE", path, 1);
+    failed_first_reset();
+
+    failed_first_fail = true;
+    CHECK(!UT_RUN_TEST_SUITE(failed_first));
+    CHECK(strcmp(failed_first_order, "first flaky last ") == 0);
+    __ut_failed_save();
+
+    // Запуск только проваленных тестов
+    failed_first_reset();
+    UT_SET_FAILED_ONLY();
+    failed_first_order[0] = '\0';
+    CHECK(!UT_RUN_TEST_SUITE(failed_first));
+    CHECK(strcmp(failed_first_order, "flaky ") == 0);
+    CHECK(!UT_IS_TEST_STARTED(find_test(&UT_TEST_SUITE_DESC(failed_first), "first")));
+    __ut_failed_save();
+
+    // Запуск проваленных тестов первыми; успешный тест удаляется из множества
+    failed_first_reset();
+    UT_SET_FAILED_FIRST();
+    failed_first_fail = false;
+    failed_first_order[0] = '\0';
+    CHECK(UT_RUN_TEST_SUITE(failed_first));
+    CHECK(strcmp(failed_first_order, "flaky first last ") == 0);
+    CHECK(__ut_failed.count == 0);
+
+    failed_first_reset();
+    remove(path);
+    unsetenv("UT_FAILED_FILE");
+}
+
+#endif  // UT_ENABLE_FAILED_FIRST
+
+#ifdef UT_ENABLE_FAIL_FAST
+
+UT_STARTUP(fail_fast) { (void)desc; }
+UT_TEARDOWN(fail_fast) { (void)desc; }
+UT_BEFORE_EACH(fail_fast) { (void)desc; }
+UT_AFTER_EACH(fail_fast) { (void)desc; }
+
+UT_TEST(fail_fast, passed) { UT_ASSERT(true, "passed"); }
+UT_TEST(fail_fast, failed) { UT_ASSERT(false, "expected failure"); }
+UT_TEST(fail_fast, after) { UT_ASSERT(true, "after"); }
+
+UT_DECLARE_TEST_SUITE(fail_fast, "fail_fast",
+    UT_ADD_TEST(fail_fast, passed, "test before the failure"),
+    UT_ADD_TEST(fail_fast, failed, "failed test"),
+    UT_ADD_TEST(fail_fast, after, "test after the failure"),
+    UT_TEST_SUITE_END)
+
+/*!
+    \brief     Проверить отмену тестов после наибольшего количества провалов
+*/
+static void check_fail_fast(void)
+{
+    // Провалы наборов тестов, выполненных ранее, не учитываем
+    __ut_fail_fast.failed_count = 0;
+    UT_SET_MAX_FAILURES(1);
+
+    CHECK(!UT_RUN_TEST_SUITE(fail_fast));
+    CHECK_SUCCESSED(fail_fast, passed);
+    CHECK_FAILED(fail_fast, failed);
+    CHECK(UT_IS_TEST_SKIPPED(find_test(&UT_TEST_SUITE_DESC(fail_fast), "after")));
+
+    // Счетчик провалов общий для наборов тестов: повторный запуск ничего не выполняет
+    UT_RUN_TEST_SUITE(fail_fast);
+    CHECK(UT_IS_TEST_SKIPPED(find_test(&UT_TEST_SUITE_DESC(fail_fast), "passed")));
+
+    UT_SET_MAX_FAILURES(0);
+    __ut_fail_fast.failed_count = 0;
+}
+
+#endif  // UT_ENABLE_FAIL_FAST
+
+#ifdef UT_ENABLE_TIMEOUT
+
+//! Флаг остановки зависшего теста (никогда не устанавливается)
+static volatile bool timeout_stop;
+//! Количество вызовов after each-функции
+static unsigned int timeout_after_each_count;
+
+UT_STARTUP(timeout) { (void)desc; }
+UT_TEARDOWN(timeout) { (void)desc; }
+UT_BEFORE_EACH(timeout) { (void)desc; }
+UT_AFTER_EACH(timeout) { (void)desc; ++timeout_after_each_count; }
+
+UT_TEST(timeout, hang) { while (!timeout_stop) { } UT_ASSERT(false, "not interrupted"); }
+UT_TEST(timeout, quick) { UT_ASSERT(true, "quick"); }
+
+UT_DECLARE_TEST_SUITE(timeout, "timeout",
+    UT_ADD_TEST(timeout, hang, "hanging test"),
+    UT_ADD_TEST(timeout, quick, "test after the hanging one"),
+    UT_TEST_SUITE_END)
+
+/*!
+    \brief     Проверить прерывание зависшего теста
+*/
+static void check_timeout(void)
+{
+    const unsigned long long test_ns = __ut_timeout.test_ns;
+    __ut_timeout.test_ns = 50 * 1000000ull;
+    CHECK(!UT_RUN_TEST_SUITE(timeout));
+    __ut_timeout.test_ns = test_ns;
+
+    CHECK_FAILED(timeout, hang);
+    CHECK(strstr(last_failure, "test timed out after 50 ms") != NULL);
+    CHECK_SUCCESSED(timeout, quick);
+    // after each-функция прерванного теста тоже вызывается
+    CHECK(timeout_after_each_count == 2);
+}
+
+#endif  // UT_ENABLE_TIMEOUT
+
+#ifdef UT_ENABLE_REPORTER
+
+UT_STARTUP(log) { (void)desc; }
+UT_TEARDOWN(log) { (void)desc; }
+UT_BEFORE_EACH(log) { (void)desc; }
+UT_AFTER_EACH(log) { (void)desc; }
+
+UT_TEST(log, passing) { UT_ASSERT(true, "passing check"); }
+UT_TEST(log, failing)
+{
+    UT_ASSERT(true, "passing check");
+    UT_ASSERT(false, "failing check");
+}
+
+UT_DECLARE_TEST_SUITE(log, "log",
+    UT_ADD_TEST(log, passing, "passing"),
+    UT_ADD_TEST(log, failing, "failing"),
+    UT_TEST_SUITE_END)
+
+/*!
+    \brief     Проверить запись двоичного журнала результатов, его чтение и преобразование
+*/
+static void check_log(void)
+{
+    char path[64], tap[64];
+    snprintf(path, sizeof(path), "/tmp/microut-log-%d", (int)getpid());
+    snprintf(tap, sizeof(tap), "/tmp/microut-log-%d.tap", (int)getpid());
+
+    // Отчет формируется с повторным чтением параметров, как при преобразовании журнала
+    UT_SET_REPORT("binary", path);
+    __ut_report.loaded = false;
+    CHECK(!UT_RUN_TEST_SUITE(log));
+    __ut_report_close();
+
+    // Сигнатура журнала отличается от сигнатуры базовой линии
+    char magic[8] = "";
+    FILE *file = fopen(path, "rb");
+    CHECK(file != NULL && fread(magic, 1, sizeof(magic), file) == sizeof(magic));
+    CHECK(memcmp(magic, "UTLOG1\0\0", sizeof(magic)) == 0);
+    if (file != NULL)
+    {
+        fclose(file);
+    }
+
+    struct __ut_log log;
+    CHECK(UT_LOG_OPEN(log, path));
+    CHECK(log.record_count == 2);
+    for (size_t i = 0; i < log.record_count && i < 2; ++i)
+    {
+        const struct __ut_log_record *record = &log.records[i];
+        const char *name = UT_LOG_STRING(log, record->name);
+        const char *message = UT_LOG_STRING(log, record->message);
+        const bool failing = name != NULL && strcmp(name, "failing") == 0;
+
+        CHECK(strcmp(UT_LOG_STRING(log, record->suite), "log") == 0);
+        CHECK(record->status == (failing ? __UT_LOG_FAILED : __UT_LOG_PASSED));
+        CHECK(failing ? message != NULL && strstr(message, "failing check") != NULL : message == NULL);
+        CHECK(record->performed_count == (failing ? 2u : 1u) && record->successed_count == 1);
+    }
+
+    struct __ut_log_summary summary;
+    UT_LOG_SUMMARIZE(log, summary);
+    CHECK(summary.test_counts[__UT_LOG_PASSED] == 1 && summary.test_counts[__UT_LOG_FAILED] == 1);
+    CHECK(summary.performed_count == 3 && summary.successed_count == 2);
+
+    // Журнал преобразуется в отчет другого формата
+    CHECK(UT_LOG_CONVERT(log, "tap", tap));
+    char report[1024] = "";
+    file = fopen(tap, "r");
+    CHECK(file != NULL);
+    if (file != NULL)
+    {
+        report[fread(report, 1, sizeof(report) - 1, file)] = '\0';
+        fclose(file);
+    }
+    CHECK(strstr(report, "ok 1") != NULL && strstr(report, "not ok 2") != NULL && strstr(report, "1..2") != NULL);
+    UT_LOG_CLOSE(log);
+
+    // Незавершенный журнал не открывается
+    CHECK(truncate(path, (off_t)(sizeof(struct __ut_log_header) + sizeof(struct __ut_log_record))) == 0);
+    CHECK(!UT_LOG_OPEN(log, path));
+
+    remove(path);
+    remove(tap);
+}
+
+#endif  // UT_ENABLE_REPORTER
+
+int main(void)
+{
+    CHECK(UT_RUN_TEST_SUITE(flags));
+
+    // Обработчик результата теста получает состояние теста
+    CHECK(hook_successed_count == 3);
+    // before each-функция и тесты делают по одной проверке (state - две)
+    CHECK(hook_performed_count == 3 * 2 + 1);
+    check_mismatch();
+
+#ifdef UT_ENABLE_PARALLEL
+    check_parallel();
+#endif
+#ifdef UT_ENABLE_FORK
+    check_fork();
+#endif
+#ifdef UT_ENABLE_PROPERTY
+    check_prop();
+#endif
+#ifdef UT_ENABLE_ASSERT_EVENTS
+    check_events();
+#endif
+#ifdef UT_ENABLE_ARENA
+    check_arena();
+#endif
+#ifdef UT_ENABLE_FUZZ
+    check_fuzz();
+#endif
+#ifdef UT_ENABLE_ALLOC_TRACKING
+    check_alloc();
+#endif
+#ifdef UT_ENABLE_LEAK_CHECK
+    check_leak();
+#endif
+#ifdef UT_ENABLE_BENCH
+    check_bench();
+#endif
+#ifdef UT_ENABLE_PERF_COUNTERS
+    check_perf();
+#endif
+#ifdef UT_ENABLE_BASELINE
+    check_baseline();
+#endif
+#ifdef UT_ENABLE_SHARDING
+    check_shard();
+#endif
+#ifdef UT_ENABLE_FILTER
+    check_filter();
+#endif
+#ifdef UT_ENABLE_TIMING_CACHE
+    check_timing_cache();
+#endif
+#ifdef UT_ENABLE_FAILED_FIRST
+    check_failed_first();
+#endif
+#ifdef UT_ENABLE_FAIL_FAST
+    check_fail_fast();
+#endif
+#ifdef UT_ENABLE_TIMEOUT
+    check_timeout();
+#endif
+#ifdef UT_ENABLE_REPORTER
+    check_log();
+#endif
+
+    return successed ? 0 : 1;
+}
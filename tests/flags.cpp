@@ -0,0 +1,2 @@
+// Тот же набор тестов, собранный компилятором C++
+#include "flags.c"
@@ -0,0 +1,33 @@
+/*!
+    \file      multifile.h
+    \brief     Наборы тестов, объявленные в разных единицах трансляции
+*/
+
+
+#ifndef __MICROUT_TESTS_MULTIFILE_H
+#define __MICROUT_TESTS_MULTIFILE_H
+
+
+#include <stdbool.h>
+
+
+//! Количество потоков теста проверок из разных потоков
+#define EVENTS_THREADS 4
+//! Количество проверок в каждом потоке
+#define EVENTS_ASSERTS 10000
+//! Длина сообщения, не помещающегося в событие проверки
+#define EVENTS_LONG_MESSAGE_LENGTH 299
+
+bool run_timeout_a(void);
+bool run_timeout_b(void);
+bool run_events(void);
+
+/*!
+    \brief     Получить счетчики проверок теста проверок из разных потоков
+    \param[out] performed_count количество запущенных проверок
+    \param[out] successed_count количество успешных проверок
+*/
+void events_counts(unsigned int *performed_count, unsigned int *successed_count);
+
+
+#endif  // __MICROUT_TESTS_MULTIFILE_H
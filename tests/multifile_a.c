@@ -0,0 +1,45 @@
+/*!
+    \file      multifile_a.c
+    \brief     Набор тестов с зависающим тестом и проваленной проверкой
+*/
+
+
+#include "microut.h"
+#include "multifile.h"
+
+#include <stdlib.h>
+
+
+static volatile unsigned long spin;
+
+
+UT_STARTUP(timeout_a) { (void)desc; }
+UT_TEARDOWN(timeout_a) { (void)desc; }
+UT_BEFORE_EACH(timeout_a) { (void)desc; }
+UT_AFTER_EACH(timeout_a) { (void)desc; }
+
+UT_TEST(timeout_a, ok) { UT_ASSERT(1, "ok"); }
+
+// Зависает, в основном внутри распределителя памяти
+UT_TEST(timeout_a, hang)
+{
+    (void)desc;
+    for (;;)
+    {
+        free(malloc(64));
+        ++spin;
+    }
+}
+
+UT_TEST(timeout_a, failed) { UT_ASSERT(0, "expected failure in timeout_a"); }
+
+UT_DECLARE_TEST_SUITE(timeout_a, "timeout_a",
+    UT_ADD_TEST(timeout_a, ok, "ok"),
+    UT_ADD_TEST(timeout_a, hang, "hang"),
+    UT_ADD_TEST(timeout_a, failed, "failed"),
+    UT_TEST_SUITE_END)
+
+bool run_timeout_a(void)
+{
+    return UT_RUN_TEST_SUITE(timeout_a);
+}
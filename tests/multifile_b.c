@@ -0,0 +1,38 @@
+/*!
+    \file      multifile_b.c
+    \brief     Второй набор тестов с зависающим тестом
+*/
+
+
+#include "microut.h"
+#include "multifile.h"
+
+
+static volatile unsigned long spin;
+
+
+UT_STARTUP(timeout_b) { (void)desc; }
+UT_TEARDOWN(timeout_b) { (void)desc; }
+UT_BEFORE_EACH(timeout_b) { (void)desc; }
+UT_AFTER_EACH(timeout_b) { (void)desc; }
+
+UT_TEST(timeout_b, ok) { UT_ASSERT(1, "ok"); }
+
+UT_TEST(timeout_b, hang)
+{
+    (void)desc;
+    for (;;)
+    {
+        ++spin;
+    }
+}
+
+UT_DECLARE_TEST_SUITE(timeout_b, "timeout_b",
+    UT_ADD_TEST(timeout_b, ok, "ok"),
+    UT_ADD_TEST(timeout_b, hang, "hang"),
+    UT_TEST_SUITE_END)
+
+bool run_timeout_b(void)
+{
+    return UT_RUN_TEST_SUITE(timeout_b);
+}
@@ -0,0 +1,74 @@
+/*!
+    \file      multifile_events.c
+    \brief     Набор тестов с проверками из разных потоков и длинным сообщением
+*/
+
+
+#include "microut.h"
+#include "multifile.h"
+
+#include <pthread.h>
+#include <string.h>
+
+
+static void events_work(struct __ut_test_state *desc)
+{
+    for (int i = 0; i < EVENTS_ASSERTS; ++i)
+    {
+        UT_ASSERT(i >= 0, "worker");
+    }
+}
+
+static void *events_worker(void *arg)
+{
+    events_work((struct __ut_test_state *)arg);
+    return NULL;
+}
+
+
+UT_STARTUP(events) { (void)desc; }
+UT_TEARDOWN(events) { (void)desc; }
+UT_BEFORE_EACH(events) { (void)desc; }
+UT_AFTER_EACH(events) { (void)desc; }
+
+UT_TEST(events, threads)
+{
+    pthread_t threads[EVENTS_THREADS];
+
+    for (int i = 0; i < EVENTS_THREADS; ++i)
+    {
+        pthread_create(&threads[i], NULL, events_worker, desc);
+    }
+    for (int i = 0; i < EVENTS_THREADS; ++i)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    UT_ASSERT(1, "joined");
+}
+
+UT_TEST(events, long)
+{
+    char message[EVENTS_LONG_MESSAGE_LENGTH + 1];
+
+    memset(message, 'x', EVENTS_LONG_MESSAGE_LENGTH);
+    message[EVENTS_LONG_MESSAGE_LENGTH] = '\0';
+
+    UT_ASSERT(0, message);
+}
+
+UT_DECLARE_TEST_SUITE(events, "events",
+    UT_ADD_TEST(events, threads, "threads"),
+    UT_ADD_TEST(events, long, "long"),
+    UT_TEST_SUITE_END)
+
+bool run_events(void)
+{
+    return UT_RUN_TEST_SUITE(events);
+}
+
+void events_counts(unsigned int *performed_count, unsigned int *successed_count)
+{
+    *performed_count = events_desc.test_states[0].performed_count;
+    *successed_count = events_desc.test_states[0].successed_count;
+}
@@ -0,0 +1,107 @@
+/*!
+    \file      multifile_main.c
+    \brief     Запуск наборов тестов из разных единиц трансляции
+    \details   Проверяет, что прерывание по времени, события проверок и отчет
+        работают для наборов тестов, объявленных в других файлах. Ожидаются
+        переменные окружения \p UT_TEST_TIMEOUT, \p UT_REPORT=tap и \p UT_REPORT_FILE
+*/
+
+
+#define UT_ALLOC_IMPLEMENTATION
+#include "microut.h"
+#include "multifile.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+static pthread_mutex_t failures_mutex = PTHREAD_MUTEX_INITIALIZER;
+static unsigned int timed_out_count;
+static size_t long_message_length;
+
+void tests_on_failed_assert(const char *name, const char *message)
+{
+    printf("  %s: %.80s\n", name, message);
+
+    pthread_mutex_lock(&failures_mutex);
+    if (strncmp(message, "test timed out", strlen("test timed out")) == 0)
+    {
+        ++timed_out_count;
+    }
+    if (strcmp(name, "long") == 0)
+    {
+        long_message_length = strlen(message);
+    }
+    pthread_mutex_unlock(&failures_mutex);
+}
+
+void tests_on_test(const char *name, bool successed, unsigned int performed_count)
+{
+    printf("%s %s (%u asserts)\n", successed ? "ok  " : "FAIL", name, performed_count);
+}
+
+
+static bool successed = true;
+
+#define CHECK(condition) do {                           \
+        if (!(condition))                               \
+        {                                               \
+            printf("check failed: %s\n", #condition);   \
+            successed = false;                          \
+        }                                               \
+    } while (0)
+
+/*!
+    \brief     Проверить, содержит ли отчет строку
+    \param[in] path   указатель на строку, путь к отчету
+    \param[in] string указатель на искомую строку
+    \return    \p true, если строка найдена; \p false иначе
+*/
+static bool report_contains(const char *path, const char *string)
+{
+    static char report[1 << 16];
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        return false;
+    }
+    const size_t size = fread(report, 1, sizeof(report) - 1, file);
+    fclose(file);
+    report[size] = '\0';
+
+    return strstr(report, string) != NULL;
+}
+
+int main(void)
+{
+    // Тест, прерванный в одном файле, не мешает прерыванию тестов другого файла
+    CHECK(!run_timeout_a());
+    CHECK(!run_timeout_b());
+    CHECK(!run_timeout_a());
+    CHECK(!run_events());
+
+    pthread_mutex_lock(&failures_mutex);
+    CHECK(timed_out_count == 3);
+    CHECK(long_message_length == EVENTS_LONG_MESSAGE_LENGTH);
+    pthread_mutex_unlock(&failures_mutex);
+
+    unsigned int performed_count, successed_count;
+    events_counts(&performed_count, &successed_count);
+    CHECK(performed_count == EVENTS_THREADS * EVENTS_ASSERTS + 1);
+    CHECK(successed_count == performed_count);
+
+    // Отчет дописывается при завершении программы; завершаем его сейчас
+    const char *report_path = getenv("UT_REPORT_FILE");
+    __ut_report_close();
+    CHECK(report_path != NULL);
+    if (report_path != NULL)
+    {
+        CHECK(report_contains(report_path, "# timeout_b"));
+        CHECK(report_contains(report_path, "expected failure in timeout_a"));
+        CHECK(report_contains(report_path, "test timed out"));
+        CHECK(report_contains(report_path, "1..10"));
+    }
+
+    return successed ? 0 : 1;
+}
@@ -0,0 +1,23 @@
+/*!
+    \file      selection.h
+    \brief     Наборы тестов для проверки выбора тестов из разных единиц трансляции
+*/
+
+
+#ifndef __MICROUT_TESTS_SELECTION_H
+#define __MICROUT_TESTS_SELECTION_H
+
+
+#include <stdbool.h>
+
+
+//! Сообщение проверки теста, исключенного фильтром
+#define SELECTION_DROPPED_MESSAGE "excluded test was run"
+//! Сообщение проверки проваленного теста
+#define SELECTION_FAILED_MESSAGE "expected failure"
+
+bool run_selection_a(void);
+bool run_selection_b(void);
+
+
+#endif  // __MICROUT_TESTS_SELECTION_H
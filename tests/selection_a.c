@@ -0,0 +1,29 @@
+/*!
+    \file      selection_a.c
+    \brief     Набор тестов, выбор которых задается параметрами командной строки
+*/
+
+
+#include "microut.h"
+#include "selection.h"
+
+
+UT_STARTUP(selection_a) { (void)desc; }
+UT_TEARDOWN(selection_a) { (void)desc; }
+UT_BEFORE_EACH(selection_a) { (void)desc; }
+UT_AFTER_EACH(selection_a) { (void)desc; }
+
+UT_TEST(selection_a, kept) { UT_ASSERT(1, "kept"); }
+UT_TEST(selection_a, dropped) { UT_ASSERT(0, SELECTION_DROPPED_MESSAGE); }
+UT_TEST(selection_a, failed) { UT_ASSERT(0, SELECTION_FAILED_MESSAGE); }
+
+UT_DECLARE_TEST_SUITE(selection_a, "selection_a",
+    UT_ADD_TEST(selection_a, kept, "kept"),
+    UT_ADD_TEST(selection_a, dropped, "excluded by the filter"),
+    UT_ADD_TEST(selection_a, failed, "failed"),
+    UT_TEST_SUITE_END)
+
+bool run_selection_a(void)
+{
+    return UT_RUN_TEST_SUITE(selection_a);
+}
@@ -0,0 +1,29 @@
+/*!
+    \file      selection_b.c
+    \brief     Второй набор тестов, выбор которых задается параметрами командной строки
+*/
+
+
+#include "microut.h"
+#include "selection.h"
+
+
+UT_STARTUP(selection_b) { (void)desc; }
+UT_TEARDOWN(selection_b) { (void)desc; }
+UT_BEFORE_EACH(selection_b) { (void)desc; }
+UT_AFTER_EACH(selection_b) { (void)desc; }
+
+UT_TEST(selection_b, kept) { UT_ASSERT(1, "kept"); }
+UT_TEST(selection_b, dropped) { UT_ASSERT(0, SELECTION_DROPPED_MESSAGE); }
+UT_TEST(selection_b, failed) { UT_ASSERT(0, SELECTION_FAILED_MESSAGE); }
+
+UT_DECLARE_TEST_SUITE(selection_b, "selection_b",
+    UT_ADD_TEST(selection_b, kept, "kept"),
+    UT_ADD_TEST(selection_b, dropped, "excluded by the filter"),
+    UT_ADD_TEST(selection_b, failed, "failed"),
+    UT_TEST_SUITE_END)
+
+bool run_selection_b(void)
+{
+    return UT_RUN_TEST_SUITE(selection_b);
+}
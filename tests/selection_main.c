@@ -0,0 +1,60 @@
+/*!
+    \file      selection_main.c
+    \brief     Выбор тестов параметрами командной строки для наборов из других единиц трансляции
+    \details   Ожидаются параметры \p --filter=-*.dropped и \p --max-failures=1
+*/
+
+
+#define UT_ALLOC_IMPLEMENTATION
+#include "microut.h"
+#include "selection.h"
+
+#include <string.h>
+
+
+//! Количество выполненных исключенных и проваленных тестов
+static unsigned int dropped_count, failed_count;
+
+void tests_on_failed_assert(const char *name, const char *message)
+{
+    printf("  %s: %s\n", name, message);
+    dropped_count += strcmp(message, SELECTION_DROPPED_MESSAGE) == 0;
+    failed_count += strcmp(message, SELECTION_FAILED_MESSAGE) == 0;
+}
+
+//! Количество выполненных тестов
+static unsigned int run_count;
+
+void tests_on_test(const char *name, bool successed, unsigned int performed_count)
+{
+    printf("%s %s (%u asserts)\n", successed ? "ok  " : "FAIL", name, performed_count);
+    ++run_count;
+}
+
+
+static bool successed = true;
+
+#define CHECK(condition) do {                           \
+        if (!(condition))                               \
+        {                                               \
+            printf("check failed: %s\n", #condition);   \
+            successed = false;                          \
+        }                                               \
+    } while (0)
+
+int main(int argc, char **argv)
+{
+    UT_PARSE_ARGUMENTS(argc, argv);
+    CHECK(argc == 1);
+
+    // Фильтр и наибольшее количество провалов, заданные в этом файле,
+    // действуют на наборы тестов из других: после провала в первом наборе
+    // тесты второго не запускаются
+    CHECK(!run_selection_a());
+    run_selection_b();
+    CHECK(dropped_count == 0);
+    CHECK(failed_count == 1);
+    CHECK(run_count == 2);
+
+    return successed ? 0 : 1;
+}